@@ -0,0 +1,45 @@
+/* Archive.cpp
+description:
+program moving the done and cancelled change items out of Change.dat into the archive, ChangeArchive.dat,
+so the scans of the change items only read the change items that can still change. archived change items
+can still be read by their ID. a log left behind by a crash is replayed first, as the files are replaced whole.
+run in the directory holding the database files, while the issue tracking system is not running.
+usage: Archive
+version history:
+ver1 -26/10/17
+*/
+
+#include "ChangeItem.h"
+#include "Dictionary.h"
+#include "WriteAheadLog.h"
+#include <iostream>
+using std::cout;
+using std::endl;
+
+//==================
+
+int main()
+{
+    // replay a log left behind by a crash into the database files
+    if (WriteAheadLog::init() || WriteAheadLog::uninit())
+    {
+        cout << "Journal.log: could not be replayed" << endl;
+        return 1;
+    }
+
+    // change items encode their products and releases by the shared dictionaries
+    if (Dictionary::initShared())
+    {
+        cout << "ProductName.dict, ReleaseId.dict: could not be opened" << endl;
+        return 1;
+    }
+    bool failed = ChangeItemDatabase::archive();
+    failed = Dictionary::uninitShared() || failed;
+    if (failed)
+    {
+        cout << "Change.dat: could not be archived" << endl;
+        return 1;
+    }
+    cout << "Change.dat: done and cancelled change items archived to ChangeArchive.dat" << endl;
+    return 0;
+}
@@ -5,9 +5,100 @@ Module implementing change items
 orders elements by ID number, there are no deletions and new elements are always appended to the end
 in this module the maintaining sort order does not cause any performance burden
 
-elements are searched linearly for simplicity and assurance of functionality
+elements are searched linearly for simplicity and assurance of functionality, except when a filter defines
+a status, a priority or a product. then the bitmap indexes list the positions of the elements holding the
+filtered values, and only those elements are read and checked against the whole filter.
+
+the indexed fields of each element are kept in Change.idx, one entry per element at the element's position,
+and the bitmaps are loaded from it at init. the entry is written together with the element, in the same
+group of the write ahead log, so a crash never leaves an element and its entry out of step. an index file
+whose entry count differs from the element count is rebuilt with one scan of the database file.
+
+descriptions are kept apart from the other fields, in ChangeDescription.dat at the position of their element,
+so the scans and filtered reads only read the fields they check. the descriptions of the elements delivered
+are then read by position, and the description is written in the same log group as its element. a database
+file of an earlier version, holding the descriptions, is split in two by migrate before it is opened.
+
+descriptions are searched through a trigram index, listing the elements whose description holds each
+trigram. search counts the trigrams of its text held by each element from those lists, and only reads the
+best ranked elements. the trigram index is only needed by search, so it is built by the first search
+rather than at init, and updated by writeElement once built.
+
+the unresolved elements of each product, those not done or cancelled, are listed in their own bitmap, so the
+report of unresolved elements pages through that list alone. an element joins and leaves the list as
+writeElement moves its status, and the lists are loaded from Change.idx with the other indexes.
+
+the database file is divided in zones of CHANGE_ITEM_ZONE_SIZE positions, each summarised in ChangeZone.idx by
+the range of its IDs, the status values and priorities it holds, and Bloom filters of its products and releases.
+the reads scanning the file pass over the zones whose summary rules out their filter. writeElement widens the
+summary of the element's zone in the same log group as the element. an update only widens the summary, so a
+summary may admit values its zone no longer holds, until the zone file is rebuilt at an init finding it out of
+step with the database file.
+
+the done and cancelled elements, which can never change again, can be moved by archive to ChangeArchive.dat,
+a read only file of compressed blocks, so the scans and filtered reads no longer pass over them. each block packs
+up to CHANGE_ARCHIVE_BLOCK_SIZE elements in order of ID, as differences of IDs and dictionary ids stored in as
+few bytes as they need, and descriptions without padding. the archive file ends with the offset of each block
+and a redirect from each archived ID to its block. the database file keeps the other elements in order of ID,
+so the position of an element is its ID less one, less the number of archived elements before it.
+
+the number of elements of each product, status and priority is tallied in ChangeTally.idx, one entry per
+combination, archived elements included, so counts never read the database file. writeElement moves an element between tallies in the
+same log group as the element. a tally file whose tallies do not add up to the element count is rebuilt
+while the index file is loaded, counting the archived elements from the archive.
 
 version history:
+ver25 -26/10/17
+        -writeElement fails when the index, zone or tally entry of the element cannot be written, before counting the element in memory
+ver24 -26/10/17
+        -archive syncs the new archive, database and description files before the commit, and replaces files through StorageFile::replaceFile
+ver23 -26/10/17
+        -mayMatchBlock runs a kernel given by the caller, and hasKernel tells the kernels the processor can run
+ver22 -26/10/17
+        -writeElement fails when a new product or release cannot be added to its dictionary
+ver21 -26/10/17
+        -done and cancelled elements moved by archive to ChangeArchive.dat, leaving a redirect from each ID
+        -added readElement, reading an element by ID from the database file or the archive
+        -positions found from IDs through the redirects, tallies count archived elements
+ver20 -26/10/17
+        -getChangeItemCount returns a 64 bit count
+        -writeElement refuses new ids past the range of 32 bits
+ver19 -26/10/17
+        -zone map of the database file kept in ChangeZone.idx, used by the scanning reads to pass over zones
+ver18 -26/10/17
+        -descriptions stored in ChangeDescription.dat, read only for the elements delivered, format version 3
+        -added migrate, moving the descriptions of a database file of an earlier version to the description file
+        -trigram index built from the description file alone
+ver17 -26/10/17
+        -mayMatchBlock checks blocks of records with AVX2 or SSE2 kernels chosen at runtime, or one record at a time
+ver16 -26/10/17
+        -trigram index built from views of the packed elements, reading only their descriptions
+ver15 -26/10/17
+        -products and releases packed as dictionary ids, version 1 files converted when opened
+        -init and uninit open and close the shared dictionaries
+ver14 -26/10/17
+        -added ChangeItemTraits pack and unpack, the database file is in the packed record format
+ver13 -26/10/17
+        -list of the unresolved elements of each product, maintained with the other indexes
+        -added getNextUnresolved
+ver12 -26/10/17
+        -elements tallied by product, status and priority in ChangeTally.idx, maintained on writeElement
+        -added countItems
+ver11 -26/10/17
+        -added search, ranking elements by the trigrams their description shares with a text
+ver10 -26/10/17
+        -product index, used by the filtered reads together with the status and priority indexes
+        -indexed fields kept in Change.idx, written in the same log group as the element
+ver9 -26/10/17
+        -bitmap indexes on status and priority, maintained on writeElement and used by the filtered reads
+ver8 -26/10/17
+        -elements stored in a RecordStore, which holds the read position and select cache
+        -init and uninit check whether the store is open, so the database can be initialised again after uninit
+ver7 -26/10/17
+        -file access through StorageFile, so the file may be memory mapped
+        -elements are tracked by element index instead of stream position
+        -updating an element no longer moves the read position or the select cache
+        -added getNextBatch, reading BATCH_READ_SIZE elements per file access
 ver6 -fix for update not allowing a change item to be changed from done or cancelled
 ver5 -24/07/25 update by Nicolao
         -separated change item and request modules
@@ -34,150 +125,720 @@ ver1 -24/07/12, original by Nicolao
 
 #include "ChangeItem.h"
 #include "Constants.h"
-#include <fstream>
+#include "Dictionary.h"
+#include "StorageFile.h"
+#include "WriteAheadLog.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <utility>
+#include <vector>
 
-//==================
+// the vector kernels of ChangeItemTraits::mayMatchBlock are built for x86 processors with compilers
+// able to build functions for a target the rest of the program is not built for
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHANGE_ITEM_VECTOR_KERNELS
+#include <immintrin.h>
+#endif
 
-// utilities for select
-int64_t ChangeItemDatabase::previouslyAccessed[20]; // records the indexes of the previous elements accessed, circular array
-int64_t ChangeItemDatabase::previouslyAccessedPosition = 0; // position in previously accessed
+//==================
 
 // utilities for file interaction
 const char* ChangeItemDatabase::filename = "Change.dat";
-std::fstream ChangeItemDatabase::itemData; // database elements
-int64_t ChangeItemDatabase::changeItemCount = 0; // this value is determined at initialisation
+RecordStore<change_item, ChangeItemTraits> ChangeItemDatabase::items; // database elements without descriptions, read position and select cache
+const char* ChangeItemDatabase::descriptionFilename = "ChangeDescription.dat";
+RecordStore<change_item, ChangeDescriptionTraits> ChangeItemDatabase::descriptions; // description of each element, at the element's position
+
+// utilities for the indexes
+const char* ChangeItemDatabase::indexFilename = "Change.idx";
+StorageFile ChangeItemDatabase::indexFile; // indexed fields of each element, one entry per element
+std::map<int8_t, CompressedBitmap> ChangeItemDatabase::statusIndex; // positions of the elements holding each status value
+std::map<int8_t, CompressedBitmap> ChangeItemDatabase::priorityIndex; // positions of the elements holding each priority value
+std::map<std::string, CompressedBitmap> ChangeItemDatabase::productIndex; // positions of the elements of each product
+std::map<std::string, CompressedBitmap> ChangeItemDatabase::unresolvedIndex; // positions of the elements of each product not done or cancelled
+std::unordered_map<uint32_t, CompressedBitmap> ChangeItemDatabase::trigramIndex; // positions of the elements whose description holds each trigram
+bool ChangeItemDatabase::trigramIndexBuilt = 0; // true once the trigram index holds every element
+
+// utilities for the zone map
+const char* ChangeItemDatabase::zoneFilename = "ChangeZone.idx";
+StorageFile ChangeItemDatabase::zoneFile; // summary of each zone, one entry per zone
+std::vector<change_item_zone> ChangeItemDatabase::zones; // summary of each zone, in order of position
+
+// utilities for the archive
+const char* ChangeItemDatabase::archiveFilename = "ChangeArchive.dat";
+StorageFile ChangeItemDatabase::archiveFile; // blocks of archived elements, then the offset of each block and the redirects
+std::vector<int64_t> ChangeItemDatabase::archiveBlocks; // offset of each block in the archive file, then the end of the last block
+std::vector<change_item_redirect> ChangeItemDatabase::redirects; // redirect of each archived element, in order of ID
+
+// utilities for the tallies
+const char* ChangeItemDatabase::tallyFilename = "ChangeTally.idx";
+StorageFile ChangeItemDatabase::tallyFile; // element count of each product, status and priority, one entry per combination
+std::map<std::tuple<std::string, int8_t, int8_t>, int64_t> ChangeItemDatabase::tallySlots; // entry of each product, status and priority in the tally file
+std::vector<int64_t> ChangeItemDatabase::tallies; // element count of each entry of the tally file
+
+// entry of the index file, the entry of an element is at the element's position
+typedef struct
+{
+    char product[MAX_PRODUCT_NAME_SIZE];
+    int8_t status;
+    int8_t priority;
+}change_item_index_entry;
+
+// entry of the tally file, the number of elements holding a product, status and priority
+typedef struct
+{
+    char product[MAX_PRODUCT_NAME_SIZE];
+    int8_t status;
+    int8_t priority;
+    int64_t count;
+}change_item_tally_entry;
+
+const int ZONE_BLOOM_HASHES = 2; // bits set in a Bloom filter of a zone per product or release id
+
+const char CHANGE_ARCHIVE_MAGIC[RECORD_MAGIC_SIZE + 1] = "\211ITSARCH"; // names the archive file in its header
+const uint32_t CHANGE_ARCHIVE_VERSION = 1; // format version of the archive file
+const int CHANGE_ARCHIVE_HEADER_SIZE = RECORD_MAGIC_SIZE + 4 + 8 + 8 + 8; // magic, version, block count, redirect count and offset of the block offsets
+const char ARCHIVE_SUFFIX[] = ".arc"; // ends the names of the files written by archive beside the files they replace
+
+//==================
+
+// copies the indexed fields of an element into its index file entry
+change_item_index_entry indexEntry(const change_item& element)
+{
+    change_item_index_entry entry;
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.product, element.product, strnlen(element.product, MAX_PRODUCT_NAME_SIZE - 1));
+    entry.status = element.status;
+    entry.priority = element.priority;
+    return entry;
+}
+
+//========
+
+// true if the element's status is unreviewed, reviewed or inProgress, matched as ChangeItemTraits::matches matches status
+bool isUnresolved(const change_item& element)
+{
+    return element.status == (element.status & (unreviewed | reviewed | inProgress));
+}
+
+//========
+
+// bits of a product or release id in the Bloom filters of a zone, found by double hashing one 64 bit hash of the id
+uint64_t zoneBloomBits(int32_t id)
+{
+    uint64_t idHash = static_cast<uint64_t>(static_cast<uint32_t>(id)) * 0x9E3779B97F4A7C15ull;
+    uint64_t step = (idHash >> 32) | 1;
+    uint64_t bits = 0;
+    for (int i = 0; i < ZONE_BLOOM_HASHES; i++)
+    {
+        bits |= uint64_t(1) << ((idHash + i * step) >> 58);
+    }
+    return bits;
+}
+
+//========
+
+// true if the summary of a zone admits the codes of a filter, each code checked as ChangeItemTraits::mayMatch checks it
+bool zoneMayMatch(const change_item_zone& zone, const int32_t* codes)
+{
+    // a product or release in no record is in no zone
+    if ((codes[3] == -2) || (codes[4] == -2))
+    {
+        return 0;
+    }
+
+    // a nonzero status within the filtered status shares a bit with it
+    uint16_t statusBits = (codes[1] == 0) ? 0 : static_cast<uint8_t>(codes[1]);
+    uint8_t priorityBit = ((codes[2] >= 0) && (codes[2] < 7)) ? (1 << codes[2]) : (1 << 7);
+    uint64_t productBits = zoneBloomBits(codes[3]);
+    uint64_t releaseBits = zoneBloomBits(codes[4]);
+    return ((codes[0] == -1) || ((zone.minId <= codes[0]) && (codes[0] <= zone.maxId)))
+        && ((codes[1] == -1) || (zone.statuses & (statusBits | (1 << 8))))
+        && ((codes[2] == -1) || (zone.priorities & priorityBit))
+        && ((codes[3] == -1) || ((zone.products & productBits) == productBits))
+        && ((codes[4] == -1) || ((zone.releases & releaseBits) == releaseBits));
+}
+
+//========
+
+// true if a redirect is of an ID less than id, ordering redirects for std::lower_bound
+bool redirectBefore(const change_item_redirect& redirect, int32_t id)
+{
+    return redirect.id < id;
+}
+
+//========
+
+// appends an unsigned integer 7 bits per byte, least significant first, the high bit set on every byte but the last
+void packVarint(std::string& bytes, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    bytes += static_cast<char>(value);
+}
+
+//========
+
+// reads an integer packed by packVarint, moving the cursor past it, return 1 if the bytes end before it does
+bool unpackVarint(const char*& bytes, const char* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; (bytes < end) && (shift < 64); shift += 7)
+    {
+        unsigned char byte = static_cast<unsigned char>(*bytes++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//========
+
+// packs a block of elements in order of ID: the element count, then for each element the difference of its ID from
+// the ID before it, its status and priority, the dictionary ids of its product and release, and its description
+void packArchiveBlock(const change_item* elements, int count, std::string& bytes)
+{
+    bytes.clear();
+    packVarint(bytes, count);
+    int32_t previousId = 0;
+    for (int i = 0; i < count; i++)
+    {
+        packVarint(bytes, elements[i].id - previousId);
+        previousId = elements[i].id;
+        bytes += static_cast<char>(elements[i].status);
+        bytes += static_cast<char>(elements[i].priority);
+        packVarint(bytes, static_cast<uint32_t>(Dictionary::productNames.encode(elements[i].product)));
+        packVarint(bytes, static_cast<uint32_t>(Dictionary::releaseIds.encode(elements[i].release)));
+        size_t length = strnlen(elements[i].description, MAX_DESCRIPTION_SIZE - 1);
+        packVarint(bytes, length);
+        bytes.append(elements[i].description, length);
+    }
+}
+
+//========
+
+// unpacks a block packed by packArchiveBlock, return 0 on success, return 1 if the block is cut short
+bool unpackArchiveBlock(const char* bytes, int64_t length, std::vector<change_item>& elements)
+{
+    const char* end = bytes + length;
+    uint64_t value;
+    elements.clear();
+    if (unpackVarint(bytes, end, value) || (value > CHANGE_ARCHIVE_BLOCK_SIZE))
+    {
+        return 1;
+    }
+    elements.resize(value);
+
+    int64_t id = 0;
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+        change_item& element = elements[i];
+        if (unpackVarint(bytes, end, value) || (end - bytes < 2))
+        {
+            return 1;
+        }
+        id += value;
+        element.id = static_cast<int32_t>(id);
+        element.status = static_cast<int8_t>(*bytes++);
+        element.priority = static_cast<int8_t>(*bytes++);
+        if (unpackVarint(bytes, end, value))
+        {
+            return 1;
+        }
+        Dictionary::productNames.decode(static_cast<int32_t>(value), element.product);
+        if (unpackVarint(bytes, end, value))
+        {
+            return 1;
+        }
+        Dictionary::releaseIds.decode(static_cast<int32_t>(value), element.release);
+        if (unpackVarint(bytes, end, value) || (value >= static_cast<uint64_t>(MAX_DESCRIPTION_SIZE)) || (static_cast<uint64_t>(end - bytes) < value))
+        {
+            return 1;
+        }
+        memcpy(element.description, bytes, value);
+        element.description[value] = '\0';
+        bytes += value;
+    }
+    return 0;
+}
+
+//========
+
+// true if a file exists
+bool fileExists(const char* path)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    return file.is_open();
+}
+
+//========
+
+// finds the trigrams of the words of a text, sorted and without repeats
+// each word is lower cased and padded with two spaces in front and one behind, so short words still give trigrams
+void textTrigrams(const char* text, size_t length, std::vector<uint32_t>& trigrams)
+{
+    trigrams.clear();
+    std::string word;
+    size_t i = 0;
+    while ((i < length) && (text[i] != '\0'))
+    {
+        if (!isalnum(static_cast<unsigned char>(text[i])))
+        {
+            i++;
+            continue;
+        }
+
+        word = "  ";
+        while ((i < length) && isalnum(static_cast<unsigned char>(text[i])))
+        {
+            word += static_cast<char>(tolower(static_cast<unsigned char>(text[i])));
+            i++;
+        }
+        word += ' ';
+
+        for (size_t j = 0; j + 2 < word.size(); j++)
+        {
+            trigrams.push_back((uint32_t(static_cast<unsigned char>(word[j])) << 16) | (uint32_t(static_cast<unsigned char>(word[j + 1])) << 8) | static_cast<unsigned char>(word[j + 2]));
+        }
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
 
 //==================
 
 // long term storage is implemented through locally stored files
-// gets item count by reading special first element in file
-bool ChangeItemDatabase::init()
+// item count is found from the size of the file
+bool ChangeItemDatabase::init(StorageBackend backend)
 {
     // assert that the module is only initialised once
-    static bool isInitialised = 0;
-    if (isInitialised)
+    if (items.isOpen())
+    {
+        return 1;
+    }
+
+    // open the dictionaries products and releases are encoded by, before the file is migrated or read
+    if (Dictionary::initShared(backend))
+    {
+        return 1;
+    }
+
+    // finish an archive interrupted by a crash and split a database file of an earlier version,
+    // then open database and description files, files are created if not found
+    if (finishArchive() || migrate() || items.open(filename, backend))
     {
+        Dictionary::uninitShared();
         return 1;
     }
-    
-    // open database file 
-    itemData.open(filename, std::ios::in | std::ios::out | std::ios::binary);
-    if (!itemData.is_open()) // if file not found create the file
+    if (descriptions.open(descriptionFilename, backend) || (descriptions.getCount() < items.getCount()))
     {
-        itemData.clear();
-        std::ofstream createFile(filename, std::ios::out | std::ios::binary);
-        createFile.close();
-        itemData.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        descriptions.close();
+        items.close();
+        Dictionary::uninitShared();
+        return 1;
+    }
+
+    // load the redirects of the archived elements, which the positions of the other elements depend on
+    if (loadArchive(backend))
+    {
+        archiveBlocks.clear();
+        redirects.clear();
+        archiveFile.close();
+        descriptions.close();
+        items.close();
+        Dictionary::uninitShared();
+        return 1;
     }
 
-    if (!itemData.is_open()) // cannot create file
+    // load indexes and tallies of the elements already in the file
+    if (loadIndexes(backend))
     {
+        tallySlots.clear();
+        tallies.clear();
+        tallyFile.close();
+        indexFile.close();
+        archiveBlocks.clear();
+        redirects.clear();
+        archiveFile.close();
+        descriptions.close();
+        items.close();
+        Dictionary::uninitShared();
         return 1;
     }
 
-    itemData.seekg(0, std::ios::end);
-    changeItemCount = ((itemData.tellg()) / (sizeof(change_item)));
-    itemData.seekg(std::ios::beg);
-    
-    // successful run
-    isInitialised = 1;
+    // load the zone map of the elements already in the file
+    if (loadZones(backend))
+    {
+        zones.clear();
+        zoneFile.close();
+        statusIndex.clear();
+        priorityIndex.clear();
+        productIndex.clear();
+        unresolvedIndex.clear();
+        tallySlots.clear();
+        tallies.clear();
+        tallyFile.close();
+        indexFile.close();
+        archiveBlocks.clear();
+        redirects.clear();
+        archiveFile.close();
+        descriptions.close();
+        items.close();
+        Dictionary::uninitShared();
+        return 1;
+    }
     return 0;
 }
 
 //========
 
+// the descriptions are written to the description file as the elements are converted, and are logged
+// and committed before the converted file replaces the old one when the write ahead log is in use
+bool ChangeItemDatabase::migrate()
+{
+    RecordStore<change_item, ChangeDescriptionTraits> movedDescriptions;
+    if (movedDescriptions.open(descriptionFilename))
+    {
+        return 1;
+    }
+    bool failed = RecordStore<change_item, ChangeItemTraits>::migrate(filename, [&movedDescriptions](int64_t position, const change_item& element) -> bool
+    {
+        return movedDescriptions.write(position, element);
+    });
+    return movedDescriptions.close() || failed;
+}
+
+//========
+
+// the database, description and archive files are written beside the files they replace, under names ending in
+// ARCHIVE_SUFFIX, the archive file first. the new archive file replacing the old one commits the archive, then the
+// database and description files replace theirs, so finishArchive completes an archive interrupted after the
+// commit and abandons one interrupted before it. the three new files are synced before the commit, and each file
+// replaced is renamed by StorageFile::replaceFile, which syncs the directory, so the renames reach the disk in order
+bool ChangeItemDatabase::archive()
+{
+    // the files are replaced whole, so none may be open or logged
+    if (items.isOpen() || WriteAheadLog::isInitialized())
+    {
+        return 1;
+    }
+
+    // finish an earlier archive and split a database file of an earlier version
+    if (finishArchive() || migrate())
+    {
+        return 1;
+    }
+
+    std::string archivePath = std::string(archiveFilename) + ARCHIVE_SUFFIX;
+    std::string itemPath = std::string(filename) + ARCHIVE_SUFFIX;
+    std::string descriptionPath = std::string(descriptionFilename) + ARCHIVE_SUFFIX;
+
+    bool failed = items.open(filename) || descriptions.open(descriptionFilename) || (descriptions.getCount() < items.getCount())
+        || loadArchive(streamBackend);
+
+    // the new archive file is created first, so finishArchive finds the archive unfinished until it is committed
+    std::ofstream newArchive(archivePath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    RecordStore<change_item, ChangeItemTraits> liveItems;
+    RecordStore<change_item, ChangeDescriptionTraits> liveDescriptions;
+    failed = failed || !newArchive.is_open() || liveItems.open(itemPath.c_str()) || liveDescriptions.open(descriptionPath.c_str());
+
+    // copy the blocks of the old archive, after room for the header
+    char header[CHANGE_ARCHIVE_HEADER_SIZE] = {};
+    newArchive.write(header, CHANGE_ARCHIVE_HEADER_SIZE);
+    int64_t blocksEnd = failed ? CHANGE_ARCHIVE_HEADER_SIZE : archiveBlocks.back(); // end of the blocks written
+    std::vector<char> copied(DEFAULT_READ_AHEAD_SIZE);
+    for (int64_t offset = CHANGE_ARCHIVE_HEADER_SIZE; !failed && (offset < blocksEnd); offset += copied.size())
+    {
+        int64_t length = std::min<int64_t>(copied.size(), blocksEnd - offset);
+        failed = archiveFile.read(offset, copied.data(), length);
+        newArchive.write(copied.data(), length);
+    }
+    std::vector<int64_t> offsets(archiveBlocks.begin(), archiveBlocks.end() - (archiveBlocks.empty() ? 0 : 1));
+    std::vector<change_item_redirect> newRedirects(redirects);
+
+    // packs the done and cancelled elements read so far into a new block, and redirects their IDs to it
+    std::vector<change_item> archived;
+    std::string packed;
+    auto writeBlock = [&]()
+    {
+        int32_t blockNumber = static_cast<int32_t>(offsets.size());
+        packArchiveBlock(archived.data(), static_cast<int>(archived.size()), packed);
+        newArchive.write(packed.data(), packed.size());
+        offsets.push_back(blocksEnd);
+        blocksEnd += packed.size();
+        for (size_t i = 0; i < archived.size(); i++)
+        {
+            change_item_redirect redirect = {archived[i].id, blockNumber};
+            newRedirects.push_back(redirect);
+        }
+        archived.clear();
+    };
+
+    // read the elements with their descriptions BATCH_READ_SIZE at a time, keeping the others in the new database file
+    change_item block[BATCH_READ_SIZE];
+    change_item everything; // filter matching every element
+    int64_t position = 0;
+    int entries;
+    items.seekToBeginning();
+    descriptions.seekToBeginning();
+    while (!failed && ((entries = items.getNextBatch(block, BATCH_READ_SIZE, everything)) > 0))
+    {
+        // the descriptions are at the positions of their elements, and read into them
+        failed = descriptions.getNextBatch(block, entries, everything) != entries;
+        for (int i = 0; (i < entries) && !failed; i++)
+        {
+            if ((block[i].status == done) || (block[i].status == cancelled))
+            {
+                archived.push_back(block[i]);
+                if (archived.size() == CHANGE_ARCHIVE_BLOCK_SIZE)
+                {
+                    writeBlock();
+                }
+            }
+            else
+            {
+                failed = liveItems.write(liveItems.getCount(), block[i]) || liveDescriptions.write(liveDescriptions.getCount(), block[i]);
+            }
+        }
+        position += entries;
+    }
+    failed = failed || (position != items.getCount());
+    if (!failed && !archived.empty())
+    {
+        writeBlock();
+    }
+    bool moved = newRedirects.size() > redirects.size(); // true if an element was archived
+
+    // the block offsets and redirects, in order of ID, follow the blocks, then the header is written with their counts
+    std::sort(newRedirects.begin(), newRedirects.end(), [](const change_item_redirect& first, const change_item_redirect& second) { return first.id < second.id; });
+    std::vector<char> directory(8 * (offsets.size() + newRedirects.size()));
+    char* field = directory.data();
+    for (size_t i = 0; i < offsets.size(); i++)
+    {
+        packInt(field, offsets[i], 8);
+    }
+    for (size_t i = 0; i < newRedirects.size(); i++)
+    {
+        packInt(field, newRedirects[i].id, 4);
+        packInt(field, newRedirects[i].block, 4);
+    }
+    newArchive.write(directory.data(), directory.size());
+    field = header;
+    memcpy(field, CHANGE_ARCHIVE_MAGIC, RECORD_MAGIC_SIZE);
+    field += RECORD_MAGIC_SIZE;
+    packInt(field, CHANGE_ARCHIVE_VERSION, 4);
+    packInt(field, offsets.size(), 8);
+    packInt(field, newRedirects.size(), 8);
+    packInt(field, blocksEnd, 8);
+    newArchive.seekp(0);
+    newArchive.write(header, CHANGE_ARCHIVE_HEADER_SIZE);
+    newArchive.close();
+
+    failed = newArchive.fail() || failed;
+    failed = liveDescriptions.close() || failed;
+    failed = liveItems.close() || failed;
+    archiveBlocks.clear();
+    redirects.clear();
+    archiveFile.close();
+    descriptions.close();
+    items.close();
+
+    // nothing to archive, or a failure, leaves the old files as they are
+    if (failed || !moved)
+    {
+        std::remove(archivePath.c_str());
+        std::remove(itemPath.c_str());
+        std::remove(descriptionPath.c_str());
+        return failed;
+    }
+
+    // the new database and description files must be on disk before the commit, as finishArchive moves them in after it
+    if (StorageFile::syncFile(itemPath.c_str()) || StorageFile::syncFile(descriptionPath.c_str()))
+    {
+        std::remove(archivePath.c_str());
+        std::remove(itemPath.c_str());
+        std::remove(descriptionPath.c_str());
+        return 1;
+    }
+
+    // commit, syncing the new archive file and replacing the old one with it
+    if (StorageFile::replaceFile(archivePath.c_str(), archiveFilename))
+    {
+        return 1;
+    }
+    return finishArchive();
+}
+
+//========
+
 // closes file
 bool ChangeItemDatabase::uninit()
 {
     // assert that module is only unintialised once
-    static bool isUninitialised = 0;
-    if (isUninitialised)
+    if (!items.isOpen())
     {
         return 1;
     }
 
     // clean up
-    // close file
-    itemData.close();
-
-    // successful run
-    isUninitialised = 1;
-    return 0;
+    statusIndex.clear();
+    priorityIndex.clear();
+    productIndex.clear();
+    unresolvedIndex.clear();
+    trigramIndex.clear();
+    trigramIndexBuilt = 0;
+    tallySlots.clear();
+    tallies.clear();
+    zones.clear();
+    archiveBlocks.clear();
+    redirects.clear();
+    // close files
+    archiveFile.close();
+    zoneFile.close();
+    tallyFile.close();
+    indexFile.close();
+    bool failed = descriptions.close();
+    failed = items.close() || failed;
+    return Dictionary::uninitShared() || failed;
 }
 
 //========
 
-// save an element to database by copying it into a buffer of bytes and then writing those bytes to file
+// save an element to database by writing its bytes to file
 bool ChangeItemDatabase::writeElement(change_item& readIn)
 {
     // fail if uninitialised
-    if (!itemData.is_open())
+    if (!items.isOpen())
+    {
+        return 1;
+    }
+
+    // fail if a new product or release cannot be added to its dictionary, as the element would be packed without it
+    if ((Dictionary::productNames.encode(readIn.product) == -1) || (Dictionary::releaseIds.encode(readIn.release) == -1))
     {
         return 1;
     }
 
-    // case for create new
-    if ((readIn.id == -1) || (readIn.id == changeItemCount + 1))
+    int64_t changeItemCount = items.getCount();
+    int64_t nextId = changeItemCount + static_cast<int64_t>(redirects.size()) + 1; // IDs of archived elements are not given again
+    int64_t elementPosition;
+    change_item temp; // previous version of an updated element
+
+    // case for create new, while the next ID fits the 32 bit ID field
+    if (((readIn.id == -1) || (readIn.id == nextId)) && (nextId <= INT32_MAX))
     {
-        readIn.id = changeItemCount + 1;
-        itemData.seekp(sizeof(change_item) * changeItemCount);
-        changeItemCount++;
+        readIn.id = static_cast<int32_t>(nextId);
+        elementPosition = changeItemCount;
     }
-    // case for update existing
-    else if ((readIn.id > 0) && (readIn.id <= changeItemCount))
+    // case for update existing, an archived element is done or cancelled so it cannot be changed
+    else if ((readIn.id > 0) && (readIn.id < nextId))
     {
-        itemData.seekp(sizeof(change_item) * (readIn.id - 1));
-        change_item temp;
-        getNext(temp);
+        elementPosition = positionOf(readIn.id);
+        if ((elementPosition == -1) || items.read(elementPosition, temp) || descriptions.read(elementPosition, temp))
+        {
+            return 1;
+        }
         if ((temp.status == done) || (temp.status == cancelled)) // cannot change an item of of done or cancelled state
         {
             return 1;
         }
-        itemData.seekp(sizeof(change_item) * (readIn.id - 1));
     }
     else
     {
         return 1;
     }
 
-    // write to file
-    char buffer[sizeof(change_item)];
-    memcpy(buffer, &readIn, sizeof(change_item));
-    itemData.write(buffer, sizeof(change_item));
-    return 0;
-}
+    // tallies the element leaves and joins, the same tally if its product, status and priority are unchanged
+    int64_t oldSlot = (elementPosition < changeItemCount) ? tallySlot(temp) : -1;
+    int64_t newSlot = tallySlot(readIn);
 
-//========
+    // summary of the element's zone widened by the element, a new zone when the element starts one
+    int64_t zoneNumber = elementPosition / CHANGE_ITEM_ZONE_SIZE;
+    change_item_zone zone = {};
+    zone.minId = readIn.id;
+    zone.maxId = readIn.id;
+    if (zoneNumber < static_cast<int64_t>(zones.size()))
+    {
+        zone = zones[zoneNumber];
+    }
+    widenZone(zone, readIn);
 
-// loads a read from the file into passed item
-bool ChangeItemDatabase::getNext(change_item& readInto)
-{
-    // fail if uninitialised
-    if (!itemData.is_open())
+    // tally entries of the tallies the element leaves and joins, counted as they will be once the element is written
+    change_item_tally_entry oldTally = {};
+    change_item_tally_entry newTally = {};
+    if (oldSlot != -1)
+    {
+        memcpy(oldTally.product, temp.product, strnlen(temp.product, MAX_PRODUCT_NAME_SIZE - 1));
+        oldTally.status = temp.status;
+        oldTally.priority = temp.priority;
+        oldTally.count = tallies[oldSlot] - 1;
+    }
+    memcpy(newTally.product, readIn.product, strnlen(readIn.product, MAX_PRODUCT_NAME_SIZE - 1));
+    newTally.status = readIn.status;
+    newTally.priority = readIn.priority;
+    newTally.count = tallies[newSlot] + 1;
+
+    // write to file, counting a new element, and write its description, index entry, zone and tallies in the same log group
+    // a failed write fails the element, leaving the in memory indexes, zones and tallies unchanged, and the transaction
+    // writing the element aborts the log group, so no entry of a sidecar file is left out of step with the database file
+    change_item_index_entry entry = indexEntry(readIn);
+    WriteAheadLog::holdCommit();
+    bool failed = descriptions.write(elementPosition, readIn) || items.write(elementPosition, readIn)
+        || indexFile.write(sizeof(change_item_index_entry) * elementPosition, &entry, sizeof(change_item_index_entry))
+        || zoneFile.write(sizeof(change_item_zone) * zoneNumber, &zone, sizeof(change_item_zone));
+    if (!failed && (oldSlot != newSlot))
+    {
+        failed = ((oldSlot != -1) && tallyFile.write(sizeof(change_item_tally_entry) * oldSlot, &oldTally, sizeof(change_item_tally_entry)))
+            || tallyFile.write(sizeof(change_item_tally_entry) * newSlot, &newTally, sizeof(change_item_tally_entry));
+    }
+    bool commitFailed = WriteAheadLog::releaseCommit();
+    if (failed)
     {
         return 1;
     }
 
-    // record index
-    int elementPosition = itemData.tellg();
-    // buffer byte block for contentss
-    char buffer[sizeof(change_item)];
-    // read to buffer
-    itemData.read(buffer, sizeof(change_item));
+    // count the element in the tallies of its new values
+    if (oldSlot != newSlot)
+    {
+        if (oldSlot != -1)
+        {
+            tallies[oldSlot]--;
+        }
+        tallies[newSlot]++;
+    }
 
-    // assert the read succeeded
-    if (!itemData.good())
+    // move the element to the index entries of its new values
+    if (elementPosition < changeItemCount)
     {
-        return 1;
+        unindexElement(elementPosition, temp);
+    }
+    indexElement(elementPosition, readIn);
+    if (zoneNumber < static_cast<int64_t>(zones.size()))
+    {
+        zones[zoneNumber] = zone;
+    }
+    else
+    {
+        zones.push_back(zone);
     }
+    return commitFailed;
+}
 
-    // copy bytes of buffer into change_item
-    memcpy(&readInto, buffer, sizeof(change_item));
-    // cache the file index of this element
-    previouslyAccessed[previouslyAccessedPosition] = elementPosition;
-    previouslyAccessedPosition = (previouslyAccessedPosition + 1) % SIZE_OF_ACCESSED_INDEX_CACHE;
-    return 0;
+//========
+
+// loads a read from the file into passed item
+bool ChangeItemDatabase::getNext(change_item& readInto)
+{
+    return items.getNext(readInto) || (readDescriptions(&readInto, 1) != 1);
 }
 
 //========
@@ -185,120 +846,1183 @@ bool ChangeItemDatabase::getNext(change_item& readInto)
 // loads a read from the file into passed item
 // will only load elements that are similar to filter element
 // searches elements linearly until finding something similar or reaching end of file
+// or only the elements listed by the indexes, when the filter defines a status, a priority or a product
 bool ChangeItemDatabase::getNext(change_item& readInto, change_item& filter)
 {
-    // fail if uninitialised
-    if (!itemData.is_open())
+    if ((filter.status == -1) && (filter.priority == -1) && !strcmp(filter.product, ""))
     {
-        return 1;
+        int32_t codes[ChangeItemTraits::FILTER_CODES];
+        ChangeItemTraits::encodeFilter(filter, codes);
+        return items.getNext(readInto, filter, [&codes](int64_t position) { return nextZone(codes, position); })
+            || (readDescriptions(&readInto, 1) != 1);
     }
 
-    // buffer byte block for contents
-    char buffer[sizeof(change_item)];
-    int elementPosition;
-
-    // read elements until finding one that meets filter requirements or until end of file is reached
-    while (1)
+    for (int64_t position = nextIndexed(filter, items.getPosition()); position != -1; position = nextIndexed(filter, position + 1))
     {
-        // record index
-        elementPosition = itemData.tellg();
-        // read to buffer
-        itemData.read(buffer, sizeof(change_item));
-
-        // if no match is ever found and end of file is reached, exit
-        if (!itemData.good())
+        if (items.read(position, readInto))
         {
             return 1;
         }
-
-        // copy bytes of buffer into change_item
-        memcpy(&readInto, buffer, sizeof(change_item));
-
-        bool idMatch = (filter.id == -1) || (readInto.id == filter.id);
-        bool priorityMatch = (filter.priority == -1) || (readInto.priority == filter.priority);
-        bool statusMatch = (filter.status == -1) || (readInto.status == (readInto.status & filter.status));
-        bool productMatch = !strcmp(filter.product, "") || !strcmp(readInto.product, filter.product);
-        bool releaseMatch = !strcmp(filter.release, "") || !strcmp(readInto.release, filter.release);
-        // no reason to implement filter by description
-
-        // if match is found finish filtering and deliver item satisfying filters
-        if (idMatch && priorityMatch && statusMatch && productMatch && releaseMatch)
+        if (ChangeItemTraits::matches(readInto, filter))
         {
-            // cache the file index of this element
-            previouslyAccessed[previouslyAccessedPosition] = elementPosition;
-            previouslyAccessedPosition = (previouslyAccessedPosition + 1) % SIZE_OF_ACCESSED_INDEX_CACHE;
-            // finish, having found a element matching filter
-            return 0;
+            items.remember(position);
+            items.setPosition(position + 1);
+            return readDescriptions(&readInto, 1) != 1;
         }
-    }  
+    }
+
+    // no more listed elements, the read position is at end of file
+    items.setPosition(items.getCount());
+    return 1;
 }
 
 //========
 
-// retrieve and load a recently accessed item from file
-bool ChangeItemDatabase::select(change_item& readInto, int index, int menuCount)
+// loads up to maxCount items similar to filter element into the passed array
+// reads the file in blocks of BATCH_READ_SIZE elements and filters each block in memory
+// or reads only the elements listed by the indexes, when the filter defines a status, a priority or a product
+int ChangeItemDatabase::getNextBatch(change_item* readInto, int maxCount, const change_item& filter)
 {
-    // fail if uninitialised
-    if (!itemData.is_open())
+    if ((filter.status == -1) && (filter.priority == -1) && !strcmp(filter.product, ""))
     {
-        return 1;
+        int32_t codes[ChangeItemTraits::FILTER_CODES];
+        ChangeItemTraits::encodeFilter(filter, codes);
+        int found = items.getNextBatch(readInto, maxCount, filter, [](const char*) { return true; }, [&codes](int64_t position) { return nextZone(codes, position); });
+        return readDescriptions(readInto, found);
     }
-    
-    // algebraically find the index of the position of the desired element
-    // using a circular array
-    // using the length of the array: SIZE_OF_INDEX_CACHE
-    // using the number of options in a menu printout: menuCount
-    // and using the selected index in that menu printout: index
-    int desiredIndex = (previouslyAccessedPosition -1 + index - menuCount) % SIZE_OF_ACCESSED_INDEX_CACHE;
 
-    // wrap around for negative indexes
-    if (desiredIndex < 0)
+    int found = 0;
+    while (found < maxCount)
     {
-        desiredIndex = SIZE_OF_ACCESSED_INDEX_CACHE + desiredIndex;
+        int64_t position = nextIndexed(filter, items.getPosition());
+        if (position == -1)
+        {
+            // no more listed elements, the read position is at end of file
+            items.setPosition(items.getCount());
+            break;
+        }
+        if (items.read(position, readInto[found]))
+        {
+            break;
+        }
+        items.setPosition(position + 1);
+        if (ChangeItemTraits::matches(readInto[found], filter))
+        {
+            items.remember(position);
+            found++;
+        }
     }
-
-    // seek to index of desired item
-    itemData.seekg(previouslyAccessed[desiredIndex]);
-
-    // retrieve desired element
-    // buffer byte block for contentss
-    char buffer[sizeof(change_item)];
-    // read to buffer
-    itemData.read(buffer, sizeof(change_item));
-    // copy bytes of buffer into change_item
-    memcpy(&readInto, buffer, sizeof(change_item));
-    
-    return 0;
+    return readDescriptions(readInto, found);
 }
 
 //========
 
-// move file pointer to beginning
-// recover from eof flag
-bool ChangeItemDatabase::seekToBeginning()
+// steps through the product's list of unresolved elements from the read position, reading only the listed elements
+int ChangeItemDatabase::getNextUnresolved(change_item* readInto, int maxCount, const char* product)
+{
+    std::map<std::string, CompressedBitmap>::const_iterator listed = unresolvedIndex.find(std::string(product, strnlen(product, MAX_PRODUCT_NAME_SIZE)));
+    if (listed == unresolvedIndex.end())
+    {
+        // no unresolved elements, the read position is at end of file
+        items.setPosition(items.getCount());
+        return 0;
+    }
+
+    int found = 0;
+    while (found < maxCount)
+    {
+        int64_t position = listed->second.next(items.getPosition());
+        if (position == -1)
+        {
+            // no more listed elements, the read position is at end of file
+            items.setPosition(items.getCount());
+            break;
+        }
+        if (items.read(position, readInto[found]))
+        {
+            break;
+        }
+        items.setPosition(position + 1);
+        items.remember(position);
+        found++;
+    }
+    return readDescriptions(readInto, found);
+}
+
+//========
+
+// sums the tallies of the matching products, status values and priorities
+// a filtered product only visits the tallies of that product
+int64_t ChangeItemDatabase::countItems(const change_item& filter)
+{
+    std::map<std::tuple<std::string, int8_t, int8_t>, int64_t>::const_iterator tally = tallySlots.begin();
+    std::string product(filter.product, strnlen(filter.product, MAX_PRODUCT_NAME_SIZE));
+    if (!product.empty())
+    {
+        tally = tallySlots.lower_bound(std::make_tuple(product, INT8_MIN, INT8_MIN));
+    }
+
+    int64_t total = 0;
+    for (; tally != tallySlots.end(); tally++)
+    {
+        if (!product.empty() && (std::get<0>(tally->first) != product))
+        {
+            break;
+        }
+        int8_t status = std::get<1>(tally->first);
+        int8_t priority = std::get<2>(tally->first);
+        bool statusMatch = (filter.status == -1) || (status == (status & filter.status));
+        bool priorityMatch = (filter.priority == -1) || (priority == filter.priority);
+        if (statusMatch && priorityMatch)
+        {
+            total += tallies[tally->second];
+        }
+    }
+    return total;
+}
+
+//========
+
+// packs an item field by field, without padding
+void ChangeItemTraits::pack(const change_item& element, char* bytes)
+{
+    packInt(bytes, element.id, 4);
+    packInt(bytes, element.status, 1);
+    packInt(bytes, element.priority, 1);
+    packInt(bytes, Dictionary::productNames.encode(element.product), 4);
+    packInt(bytes, Dictionary::releaseIds.encode(element.release), 4);
+}
+
+//========
+
+void ChangeItemTraits::unpack(const char* bytes, change_item& element)
+{
+    element.id = static_cast<int32_t>(unpackInt(bytes, 4));
+    element.status = static_cast<int8_t>(unpackInt(bytes, 1));
+    element.priority = static_cast<int8_t>(unpackInt(bytes, 1));
+    Dictionary::productNames.decode(static_cast<int32_t>(unpackInt(bytes, 4)), element.product);
+    Dictionary::releaseIds.decode(static_cast<int32_t>(unpackInt(bytes, 4)), element.release);
+    element.description[0] = '\0';
+}
+
+//========
+
+int ChangeItemTraits::formatSize(uint32_t version)
+{
+    if (version == 1)
+    {
+        return 4 + 1 + 1 + (MAX_PRODUCT_NAME_SIZE - 1) + (MAX_RELEASE_ID_SIZE - 1) + (MAX_DESCRIPTION_SIZE - 1);
+    }
+    if (version == 2)
+    {
+        return 4 + 1 + 1 + 4 + 4 + (MAX_DESCRIPTION_SIZE - 1);
+    }
+    return 0;
+}
+
+//========
+
+void ChangeItemTraits::unpackFormat(uint32_t version, const char* bytes, change_item& element)
+{
+    if (version == 1)
+    {
+        element.id = static_cast<int32_t>(unpackInt(bytes, 4));
+        element.status = static_cast<int8_t>(unpackInt(bytes, 1));
+        element.priority = static_cast<int8_t>(unpackInt(bytes, 1));
+        unpackString(bytes, element.product, MAX_PRODUCT_NAME_SIZE);
+        unpackString(bytes, element.release, MAX_RELEASE_ID_SIZE);
+        unpackString(bytes, element.description, MAX_DESCRIPTION_SIZE);
+    }
+    else if (version == 2)
+    {
+        element.id = static_cast<int32_t>(unpackInt(bytes, 4));
+        element.status = static_cast<int8_t>(unpackInt(bytes, 1));
+        element.priority = static_cast<int8_t>(unpackInt(bytes, 1));
+        Dictionary::productNames.decode(static_cast<int32_t>(unpackInt(bytes, 4)), element.product);
+        Dictionary::releaseIds.decode(static_cast<int32_t>(unpackInt(bytes, 4)), element.release);
+        unpackString(bytes, element.description, MAX_DESCRIPTION_SIZE);
+    }
+}
+
+//========
+
+// a product or release in no record is given -2, which no record holds
+void ChangeItemTraits::encodeFilter(const change_item& filter, int32_t* codes)
+{
+    codes[0] = filter.id;
+    codes[1] = filter.status;
+    codes[2] = filter.priority;
+    codes[3] = -1;
+    codes[4] = -1;
+    if (strcmp(filter.product, ""))
+    {
+        int32_t productId = Dictionary::productNames.find(filter.product);
+        codes[3] = (productId == -1) ? -2 : productId;
+    }
+    if (strcmp(filter.release, ""))
+    {
+        int32_t releaseId = Dictionary::releaseIds.find(filter.release);
+        codes[4] = (releaseId == -1) ? -2 : releaseId;
+    }
+}
+
+//========
+
+// compares the fields in place as matches does, except the description which is never filtered on
+bool ChangeItemTraits::mayMatch(const char* bytes, const int32_t* codes)
+{
+    const char* field = bytes;
+    int32_t id = static_cast<int32_t>(unpackInt(field, 4));
+    int32_t status = static_cast<int8_t>(unpackInt(field, 1));
+    int32_t priority = static_cast<int8_t>(unpackInt(field, 1));
+    int32_t productId = static_cast<int32_t>(unpackInt(field, 4));
+    int32_t releaseId = static_cast<int32_t>(unpackInt(field, 4));
+    return ((codes[0] == -1) || (id == codes[0]))
+        && ((codes[1] == -1) || (status == (status & codes[1])))
+        && ((codes[2] == -1) || (priority == codes[2]))
+        && ((codes[3] == -1) || (productId == codes[3]))
+        && ((codes[4] == -1) || (releaseId == codes[4]));
+}
+
+//========
+
+// checks the elements one at a time, for processors without a vector kernel and for the elements left after the vectors
+uint64_t scalarItemKernel(const char* bytes, int first, int count, const int32_t* codes)
+{
+    uint64_t candidates = 0;
+    for (int i = first; i < count; i++)
+    {
+        candidates |= uint64_t(ChangeItemTraits::mayMatch(bytes + ChangeItemTraits::RECORD_SIZE * i, codes)) << i;
+    }
+    return candidates;
+}
+
+#ifdef CHANGE_ITEM_VECTOR_KERNELS
+
+// reads the 4 bytes at an offset of a packed element, least significant first as x86 stores integers
+inline int32_t loadField(const char* bytes)
+{
+    int32_t field;
+    memcpy(&field, bytes, 4);
+    return field;
+}
+
+// each field is compared lane by lane, a field not filtered on passes every lane through its ignore mask:
+//     id and ids of product and release: equal to the code
+//     status: no bit set outside the code, taken signed from the low byte of the word at offset 4
+//     priority: equal to the code, taken signed from the second byte of the word at offset 4
+__attribute__((target("sse2")))
+uint64_t sse2ItemKernel(const char* bytes, int count, const int32_t* codes)
+{
+    const int size = ChangeItemTraits::RECORD_SIZE;
+    __m128i idCode = _mm_set1_epi32(codes[0]);
+    __m128i statusOutside = _mm_set1_epi32(~codes[1]);
+    __m128i priorityCode = _mm_set1_epi32(codes[2]);
+    __m128i productCode = _mm_set1_epi32(codes[3]);
+    __m128i releaseCode = _mm_set1_epi32(codes[4]);
+    __m128i idIgnore = _mm_set1_epi32((codes[0] == -1) ? -1 : 0);
+    __m128i statusIgnore = _mm_set1_epi32((codes[1] == -1) ? -1 : 0);
+    __m128i priorityIgnore = _mm_set1_epi32((codes[2] == -1) ? -1 : 0);
+    __m128i productIgnore = _mm_set1_epi32((codes[3] == -1) ? -1 : 0);
+    __m128i releaseIgnore = _mm_set1_epi32((codes[4] == -1) ? -1 : 0);
+    __m128i zero = _mm_setzero_si128();
+
+    uint64_t candidates = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const char* element = bytes + size * i;
+        __m128i ids = _mm_setr_epi32(loadField(element), loadField(element + size), loadField(element + 2 * size), loadField(element + 3 * size));
+        __m128i levels = _mm_setr_epi32(loadField(element + 4), loadField(element + size + 4), loadField(element + 2 * size + 4), loadField(element + 3 * size + 4));
+        __m128i products = _mm_setr_epi32(loadField(element + 6), loadField(element + size + 6), loadField(element + 2 * size + 6), loadField(element + 3 * size + 6));
+        __m128i releases = _mm_setr_epi32(loadField(element + 10), loadField(element + size + 10), loadField(element + 2 * size + 10), loadField(element + 3 * size + 10));
+        __m128i statuses = _mm_srai_epi32(_mm_slli_epi32(levels, 24), 24);
+        __m128i priorities = _mm_srai_epi32(_mm_slli_epi32(levels, 16), 24);
+
+        __m128i pass = _mm_or_si128(_mm_cmpeq_epi32(ids, idCode), idIgnore);
+        pass = _mm_and_si128(pass, _mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(statuses, statusOutside), zero), statusIgnore));
+        pass = _mm_and_si128(pass, _mm_or_si128(_mm_cmpeq_epi32(priorities, priorityCode), priorityIgnore));
+        pass = _mm_and_si128(pass, _mm_or_si128(_mm_cmpeq_epi32(products, productCode), productIgnore));
+        pass = _mm_and_si128(pass, _mm_or_si128(_mm_cmpeq_epi32(releases, releaseCode), releaseIgnore));
+        candidates |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(pass))) << i;
+    }
+    return candidates | scalarItemKernel(bytes, i, count, codes);
+}
+
+//========
+
+// checks 8 elements at a time as sse2ItemKernel checks 4, gathering each field of the 8 elements with one load
+__attribute__((target("avx2")))
+uint64_t avx2ItemKernel(const char* bytes, int count, const int32_t* codes)
+{
+    const int size = ChangeItemTraits::RECORD_SIZE;
+    __m256i idCode = _mm256_set1_epi32(codes[0]);
+    __m256i statusOutside = _mm256_set1_epi32(~codes[1]);
+    __m256i priorityCode = _mm256_set1_epi32(codes[2]);
+    __m256i productCode = _mm256_set1_epi32(codes[3]);
+    __m256i releaseCode = _mm256_set1_epi32(codes[4]);
+    __m256i idIgnore = _mm256_set1_epi32((codes[0] == -1) ? -1 : 0);
+    __m256i statusIgnore = _mm256_set1_epi32((codes[1] == -1) ? -1 : 0);
+    __m256i priorityIgnore = _mm256_set1_epi32((codes[2] == -1) ? -1 : 0);
+    __m256i productIgnore = _mm256_set1_epi32((codes[3] == -1) ? -1 : 0);
+    __m256i releaseIgnore = _mm256_set1_epi32((codes[4] == -1) ? -1 : 0);
+    __m256i zero = _mm256_setzero_si256();
+    __m256i offsets = _mm256_setr_epi32(0, size, 2 * size, 3 * size, 4 * size, 5 * size, 6 * size, 7 * size);
+
+    uint64_t candidates = 0;
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const char* element = bytes + size * i;
+        __m256i ids = _mm256_i32gather_epi32(reinterpret_cast<const int*>(element), offsets, 1);
+        __m256i levels = _mm256_i32gather_epi32(reinterpret_cast<const int*>(element + 4), offsets, 1);
+        __m256i products = _mm256_i32gather_epi32(reinterpret_cast<const int*>(element + 6), offsets, 1);
+        __m256i releases = _mm256_i32gather_epi32(reinterpret_cast<const int*>(element + 10), offsets, 1);
+        __m256i statuses = _mm256_srai_epi32(_mm256_slli_epi32(levels, 24), 24);
+        __m256i priorities = _mm256_srai_epi32(_mm256_slli_epi32(levels, 16), 24);
+
+        __m256i pass = _mm256_or_si256(_mm256_cmpeq_epi32(ids, idCode), idIgnore);
+        pass = _mm256_and_si256(pass, _mm256_or_si256(_mm256_cmpeq_epi32(_mm256_and_si256(statuses, statusOutside), zero), statusIgnore));
+        pass = _mm256_and_si256(pass, _mm256_or_si256(_mm256_cmpeq_epi32(priorities, priorityCode), priorityIgnore));
+        pass = _mm256_and_si256(pass, _mm256_or_si256(_mm256_cmpeq_epi32(products, productCode), productIgnore));
+        pass = _mm256_and_si256(pass, _mm256_or_si256(_mm256_cmpeq_epi32(releases, releaseCode), releaseIgnore));
+        candidates |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(pass))) << i;
+    }
+    return candidates | scalarItemKernel(bytes, i, count, codes);
+}
+
+#endif
+
+//========
+
+// the kernel used is chosen once, by the instruction sets of the processor running the program
+uint64_t ChangeItemTraits::mayMatchBlock(const char* bytes, int count, const int32_t* codes)
+{
+    // a filter on no packed field passes every element
+    if ((codes[0] == -1) && (codes[1] == -1) && (codes[2] == -1) && (codes[3] == -1) && (codes[4] == -1))
+    {
+        return (count >= 64) ? ~uint64_t(0) : ((uint64_t(1) << count) - 1);
+    }
+
+    static const ChangeItemKernel kernel = hasKernel(avx2Kernel) ? avx2Kernel : (hasKernel(sse2Kernel) ? sse2Kernel : scalarKernel);
+    return mayMatchBlock(bytes, count, codes, kernel);
+}
+
+//========
+
+uint64_t ChangeItemTraits::mayMatchBlock(const char* bytes, int count, const int32_t* codes, ChangeItemKernel kernel)
+{
+#ifdef CHANGE_ITEM_VECTOR_KERNELS
+    if (kernel == avx2Kernel)
+    {
+        return avx2ItemKernel(bytes, count, codes);
+    }
+    if (kernel == sse2Kernel)
+    {
+        return sse2ItemKernel(bytes, count, codes);
+    }
+#endif
+    return scalarItemKernel(bytes, 0, count, codes);
+}
+
+//========
+
+bool ChangeItemTraits::hasKernel(ChangeItemKernel kernel)
+{
+#ifdef CHANGE_ITEM_VECTOR_KERNELS
+    if (kernel == avx2Kernel)
+    {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (kernel == sse2Kernel)
+    {
+        return __builtin_cpu_supports("sse2");
+    }
+#endif
+    return kernel == scalarKernel;
+}
+
+//========
+
+// checks an item against each defined field of a filter
+bool ChangeItemTraits::matches(const change_item& element, const change_item& filter)
+{
+    bool idMatch = (filter.id == -1) || (element.id == filter.id);
+    bool priorityMatch = (filter.priority == -1) || (element.priority == filter.priority);
+    bool statusMatch = (filter.status == -1) || (element.status == (element.status & filter.status));
+    bool productMatch = !strcmp(filter.product, "") || !strcmp(element.product, filter.product);
+    bool releaseMatch = !strcmp(filter.release, "") || !strcmp(element.release, filter.release);
+    // no reason to implement filter by description
+    return idMatch && priorityMatch && statusMatch && productMatch && releaseMatch;
+}
+
+//========
+
+void ChangeDescriptionTraits::pack(const change_item& element, char* bytes)
+{
+    packString(bytes, element.description, MAX_DESCRIPTION_SIZE);
+}
+
+//========
+
+void ChangeDescriptionTraits::unpack(const char* bytes, change_item& element)
+{
+    unpackString(bytes, element.description, MAX_DESCRIPTION_SIZE);
+}
+
+//========
+
+bool ChangeDescriptionTraits::matches(const change_item& element, const change_item& filter)
+{
+    return 1;
+}
+
+//========
+
+// counts the trigrams of the text held by each element, then reads the elements in order of that count
+// until enough of them match the filter, skipping those the indexes show do not match without reading them
+int ChangeItemDatabase::search(change_item* readInto, int maxCount, const char* text, const change_item& filter)
 {
     // fail if uninitialised
-    if (!itemData.is_open())
+    if (!items.isOpen() || (maxCount <= 0))
+    {
+        return 0;
+    }
+
+    if (!trigramIndexBuilt && buildTrigramIndex())
+    {
+        return 0;
+    }
+
+    std::vector<uint32_t> trigrams;
+    textTrigrams(text, strlen(text), trigrams);
+    if (trigrams.empty())
+    {
+        return 0;
+    }
+
+    // count the trigrams of the text held by each element
+    std::vector<uint16_t> shared(items.getCount(), 0);
+    for (size_t i = 0; i < trigrams.size(); i++)
+    {
+        std::unordered_map<uint32_t, CompressedBitmap>::const_iterator listed = trigramIndex.find(trigrams[i]);
+        if (listed == trigramIndex.end())
+        {
+            continue;
+        }
+        uint16_t* counts = shared.data();
+        listed->second.forEach([counts](int64_t position) { counts[position]++; });
+    }
+
+    // rank the elements holding at least half of the trigrams, most held first and then by ID
+    size_t required = (trigrams.size() + 1) / 2;
+    std::vector<std::pair<int, int64_t>> ranked; // negated count and position of each element, so sorting ranks them
+    for (int64_t position = 0; position < static_cast<int64_t>(shared.size()); position++)
+    {
+        if (shared[position] >= required)
+        {
+            ranked.push_back(std::make_pair(-shared[position], position));
+        }
+    }
+    std::sort(ranked.begin(), ranked.end());
+
+    bool indexedFilter = (filter.status != -1) || (filter.priority != -1) || strcmp(filter.product, "");
+    int found = 0;
+    for (size_t i = 0; (i < ranked.size()) && (found < maxCount); i++)
+    {
+        int64_t position = ranked[i].second;
+        if (indexedFilter && (nextIndexed(filter, position) != position))
+        {
+            continue;
+        }
+        if (items.read(position, readInto[found]))
+        {
+            break;
+        }
+        if (ChangeItemTraits::matches(readInto[found], filter))
+        {
+            items.remember(position);
+            found++;
+        }
+    }
+    return readDescriptions(readInto, found);
+}
+
+//========
+
+// retrieve and load a recently accessed item from file
+bool ChangeItemDatabase::select(change_item& readInto, int index, int menuCount)
+{
+    return items.select(readInto, index, menuCount) || (readDescriptions(&readInto, 1) != 1);
+}
+
+//========
+
+// an element in the database file is read by position, an archived element from the block its redirect names
+bool ChangeItemDatabase::readElement(change_item& readInto, int32_t id)
+{
+    // fail if uninitialised or no element has the ID
+    if (!items.isOpen() || (id < 1) || (id > getChangeItemCount()))
     {
         return 1;
     }
 
-    itemData.clear(); // clear eof error bit
+    int64_t position = positionOf(id);
+    if (position != -1)
+    {
+        return items.read(position, readInto) || descriptions.read(position, readInto);
+    }
 
-    // move file pointer to the beginning of database
-    // first element is info element and should be ignored
-    // so move to the beginning offset by one element
-    itemData.seekg(std::ios::beg);
-    return 0;
+    std::vector<change_item_redirect>::const_iterator redirect = std::lower_bound(redirects.begin(), redirects.end(), id, redirectBefore);
+    std::vector<change_item> block;
+    if (readArchiveBlock(redirect->block, block))
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < block.size(); i++)
+    {
+        if (block[i].id == id)
+        {
+            readInto = block[i];
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//========
+
+// move file pointer to beginning
+bool ChangeItemDatabase::seekToBeginning()
+{
+    return items.seekToBeginning();
 }
 
 //========
 
 // reads and returns element count
-int ChangeItemDatabase::getChangeItemCount(){
-    return changeItemCount;
+int64_t ChangeItemDatabase::getChangeItemCount(){
+    return items.getCount() + static_cast<int64_t>(redirects.size());
+}
+
+//========
+
+// opens the index file and loads the bitmaps from its entries
+// the index holds one entry per element, if it does not it is rebuilt with one scan of the database file
+bool ChangeItemDatabase::loadIndexes(StorageBackend backend)
+{
+    if (indexFile.open(indexFilename, backend))
+    {
+        return 1;
+    }
+
+    statusIndex.clear();
+    priorityIndex.clear();
+    productIndex.clear();
+    unresolvedIndex.clear();
+
+    change_item element;
+    int64_t position = 0;
+    int64_t elementCount = items.getCount();
+
+    // tallies that do not add up to the element count are counted again from the index entries
+    bool countTallies = loadTallies(backend);
+    if (!tallyFile.isOpen())
+    {
+        return 1;
+    }
+
+    // index matches database, load entries BATCH_READ_SIZE at a time
+    if (indexFile.getSize() == static_cast<int64_t>(sizeof(change_item_index_entry)) * elementCount)
+    {
+        change_item_index_entry block[BATCH_READ_SIZE];
+        while (position < elementCount)
+        {
+            int64_t blockCount = elementCount - position;
+            if (blockCount > BATCH_READ_SIZE)
+            {
+                blockCount = BATCH_READ_SIZE;
+            }
+            if (indexFile.read(sizeof(change_item_index_entry) * position, block, sizeof(change_item_index_entry) * blockCount))
+            {
+                return 1;
+            }
+            for (int64_t i = 0; i < blockCount; i++)
+            {
+                size_t productLength = strnlen(block[i].product, MAX_PRODUCT_NAME_SIZE - 1);
+                memcpy(element.product, block[i].product, productLength);
+                element.product[productLength] = '\0';
+                element.status = block[i].status;
+                element.priority = block[i].priority;
+                indexElement(position, element);
+                if (countTallies)
+                {
+                    tallies[tallySlot(element)]++;
+                }
+                position++;
+            }
+        }
+        return countTallies && (tallyArchive() || saveTallies(backend));
+    }
+
+    // index is out of date, rebuild from database file
+    indexFile.close();
+    std::remove(indexFilename);
+    if (indexFile.open(indexFilename, backend))
+    {
+        return 1;
+    }
+
+    change_item block[BATCH_READ_SIZE];
+    change_item everything; // filter matching every element
+    int entries;
+
+    items.seekToBeginning();
+    while ((entries = items.getNextBatch(block, BATCH_READ_SIZE, everything)) > 0)
+    {
+        for (int i = 0; i < entries; i++)
+        {
+            change_item_index_entry entry = indexEntry(block[i]);
+            if (indexFile.write(sizeof(change_item_index_entry) * position, &entry, sizeof(change_item_index_entry)))
+            {
+                return 1;
+            }
+            indexElement(position, block[i]);
+            if (countTallies)
+            {
+                tallies[tallySlot(block[i])]++;
+            }
+            position++;
+        }
+    }
+    items.seekToBeginning();
+
+    // fail if an element could not be read
+    if (position != elementCount)
+    {
+        return 1;
+    }
+    return countTallies && (tallyArchive() || saveTallies(backend));
+}
+
+//========
+
+void ChangeItemDatabase::indexElement(int64_t position, const change_item& element)
+{
+    statusIndex[element.status].set(position);
+    priorityIndex[element.priority].set(position);
+    productIndex[std::string(element.product, strnlen(element.product, MAX_PRODUCT_NAME_SIZE))].set(position);
+    if (isUnresolved(element))
+    {
+        unresolvedIndex[std::string(element.product, strnlen(element.product, MAX_PRODUCT_NAME_SIZE))].set(position);
+    }
+
+    if (trigramIndexBuilt)
+    {
+        std::vector<uint32_t> trigrams;
+        textTrigrams(element.description, MAX_DESCRIPTION_SIZE, trigrams);
+        for (size_t i = 0; i < trigrams.size(); i++)
+        {
+            trigramIndex[trigrams[i]].set(position);
+        }
+    }
+}
+
+//========
+
+void ChangeItemDatabase::unindexElement(int64_t position, const change_item& element)
+{
+    statusIndex[element.status].clear(position);
+    priorityIndex[element.priority].clear(position);
+    productIndex[std::string(element.product, strnlen(element.product, MAX_PRODUCT_NAME_SIZE))].clear(position);
+    if (isUnresolved(element))
+    {
+        unresolvedIndex[std::string(element.product, strnlen(element.product, MAX_PRODUCT_NAME_SIZE))].clear(position);
+    }
+
+    if (trigramIndexBuilt)
+    {
+        std::vector<uint32_t> trigrams;
+        textTrigrams(element.description, MAX_DESCRIPTION_SIZE, trigrams);
+        for (size_t i = 0; i < trigrams.size(); i++)
+        {
+            trigramIndex[trigrams[i]].clear(position);
+        }
+    }
+}
+
+//========
+
+// each field defined by the filter gives the bitmaps of the values it matches, as in ChangeItemTraits::matches:
+// every matched status value, the filtered priority, and the filtered product
+// the fields are visited in turn, each moving the position to its next listed position,
+// until every field lists the same position
+int64_t ChangeItemDatabase::nextIndexed(const change_item& filter, int64_t from)
+{
+    std::vector<std::vector<const CompressedBitmap*>> fields; // bitmaps of the values matched by each defined field
+
+    if (filter.status != -1)
+    {
+        fields.push_back(std::vector<const CompressedBitmap*>());
+        for (std::map<int8_t, CompressedBitmap>::const_iterator value = statusIndex.begin(); value != statusIndex.end(); value++)
+        {
+            if (value->first == (value->first & filter.status))
+            {
+                fields.back().push_back(&value->second);
+            }
+        }
+    }
+    if (filter.priority != -1)
+    {
+        fields.push_back(std::vector<const CompressedBitmap*>());
+        std::map<int8_t, CompressedBitmap>::const_iterator value = priorityIndex.find(filter.priority);
+        if (value != priorityIndex.end())
+        {
+            fields.back().push_back(&value->second);
+        }
+    }
+    if (strcmp(filter.product, ""))
+    {
+        fields.push_back(std::vector<const CompressedBitmap*>());
+        std::map<std::string, CompressedBitmap>::const_iterator value = productIndex.find(std::string(filter.product, strnlen(filter.product, MAX_PRODUCT_NAME_SIZE)));
+        if (value != productIndex.end())
+        {
+            fields.back().push_back(&value->second);
+        }
+    }
+
+    int64_t position = from;
+    size_t agreeing = 0; // number of fields in a row listing position
+    size_t field = 0;
+    while (agreeing < fields.size())
+    {
+        // earliest position from the current one among the bitmaps of the field
+        int64_t next = -1;
+        for (size_t i = 0; i < fields[field].size(); i++)
+        {
+            int64_t listed = fields[field][i]->next(position);
+            if ((listed != -1) && ((next == -1) || (listed < next)))
+            {
+                next = listed;
+            }
+        }
+        if (next == -1)
+        {
+            return -1;
+        }
+
+        if (next == position)
+        {
+            agreeing++;
+        }
+        else
+        {
+            position = next;
+            agreeing = 1;
+        }
+        field = (field + 1) % fields.size();
+    }
+    return position;
+}
+
+//========
+
+// reads the description file BATCH_READ_SIZE descriptions at a time, indexing each description in place
+// the read position of the elements is not moved, as a search may be made between reads
+bool ChangeItemDatabase::buildTrigramIndex()
+{
+    const char* views[BATCH_READ_SIZE];
+    std::vector<uint32_t> trigrams;
+    int64_t position = 0;
+    int entries;
+
+    // only the descriptions of elements are read, the description file may hold more
+    trigramIndex.clear();
+    descriptions.seekToBeginning();
+    while ((position < items.getCount()) && ((entries = descriptions.getNextViews(views, static_cast<int>(std::min<int64_t>(BATCH_READ_SIZE, items.getCount() - position)))) > 0))
+    {
+        for (int i = 0; i < entries; i++)
+        {
+            textTrigrams(views[i], MAX_DESCRIPTION_SIZE - 1, trigrams);
+            for (size_t j = 0; j < trigrams.size(); j++)
+            {
+                trigramIndex[trigrams[j]].set(position);
+            }
+            position++;
+        }
+    }
+
+    // fail if an element could not be read
+    if (position != items.getCount())
+    {
+        trigramIndex.clear();
+        return 1;
+    }
+    trigramIndexBuilt = 1;
+    return 0;
+}
+
+//========
+
+// reads every entry of the tally file, each entry giving the slot of its product, status and priority
+// on failure the file is left open and the tallies empty, ready to be counted again and saved
+bool ChangeItemDatabase::loadTallies(StorageBackend backend)
+{
+    tallySlots.clear();
+    tallies.clear();
+    if (tallyFile.open(tallyFilename, backend))
+    {
+        return 1;
+    }
+
+    int64_t entryCount = tallyFile.getSize() / static_cast<int64_t>(sizeof(change_item_tally_entry));
+    int64_t total = 0;
+    bool failed = (tallyFile.getSize() % sizeof(change_item_tally_entry)) != 0;
+    change_item_tally_entry entry;
+    for (int64_t slot = 0; (slot < entryCount) && !failed; slot++)
+    {
+        failed = tallyFile.read(sizeof(change_item_tally_entry) * slot, &entry, sizeof(change_item_tally_entry));
+        std::tuple<std::string, int8_t, int8_t> key(std::string(entry.product, strnlen(entry.product, MAX_PRODUCT_NAME_SIZE)), entry.status, entry.priority);
+        failed = failed || (entry.count < 0) || !tallySlots.insert(std::make_pair(key, slot)).second;
+        tallies.push_back(entry.count);
+        total += entry.count;
+    }
+
+    if (failed || (total != items.getCount() + static_cast<int64_t>(redirects.size())))
+    {
+        tallySlots.clear();
+        tallies.clear();
+        return 1;
+    }
+    return 0;
+}
+
+//========
+
+// the tally file is emptied first, so no entry of the old tallies is left behind
+bool ChangeItemDatabase::saveTallies(StorageBackend backend)
+{
+    tallyFile.close();
+    std::remove(tallyFilename);
+    if (tallyFile.open(tallyFilename, backend))
+    {
+        return 1;
+    }
+
+    std::vector<change_item_tally_entry> entries(tallies.size());
+    for (std::map<std::tuple<std::string, int8_t, int8_t>, int64_t>::const_iterator tally = tallySlots.begin(); tally != tallySlots.end(); tally++)
+    {
+        change_item_tally_entry& entry = entries[tally->second];
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.product, std::get<0>(tally->first).c_str(), MAX_PRODUCT_NAME_SIZE - 1);
+        entry.status = std::get<1>(tally->first);
+        entry.priority = std::get<2>(tally->first);
+        entry.count = tallies[tally->second];
+    }
+    if (entries.empty())
+    {
+        return 0;
+    }
+    return tallyFile.write(0, entries.data(), sizeof(change_item_tally_entry) * entries.size());
+}
+
+//========
+
+int64_t ChangeItemDatabase::tallySlot(const change_item& element)
+{
+    std::tuple<std::string, int8_t, int8_t> key(std::string(element.product, strnlen(element.product, MAX_PRODUCT_NAME_SIZE)), element.status, element.priority);
+    std::map<std::tuple<std::string, int8_t, int8_t>, int64_t>::iterator found = tallySlots.find(key);
+    if (found != tallySlots.end())
+    {
+        return found->second;
+    }
+    tallySlots.insert(std::make_pair(key, static_cast<int64_t>(tallies.size())));
+    tallies.push_back(0);
+    return tallies.size() - 1;
+}
+
+//========
+
+// opens the zone file and loads the summary of each zone
+// the file holds one entry per zone of the database file, if it does not it is rebuilt with one scan of the database file
+bool ChangeItemDatabase::loadZones(StorageBackend backend)
+{
+    if (zoneFile.open(zoneFilename, backend))
+    {
+        return 1;
+    }
+
+    int64_t elementCount = items.getCount();
+    int64_t zoneCount = (elementCount + CHANGE_ITEM_ZONE_SIZE - 1) / CHANGE_ITEM_ZONE_SIZE;
+    zones.assign(zoneCount, change_item_zone());
+
+    // zone file matches database, load every entry at once
+    if (zoneFile.getSize() == static_cast<int64_t>(sizeof(change_item_zone)) * zoneCount)
+    {
+        return (zoneCount > 0) && zoneFile.read(0, zones.data(), sizeof(change_item_zone) * zoneCount);
+    }
+
+    // zone file is out of date, rebuild from database file
+    zoneFile.close();
+    std::remove(zoneFilename);
+    if (zoneFile.open(zoneFilename, backend))
+    {
+        return 1;
+    }
+
+    change_item block[BATCH_READ_SIZE];
+    change_item everything; // filter matching every element
+    int64_t position = 0;
+    int entries;
+
+    items.seekToBeginning();
+    while ((entries = items.getNextBatch(block, BATCH_READ_SIZE, everything)) > 0)
+    {
+        for (int i = 0; i < entries; i++)
+        {
+            change_item_zone& zone = zones[position / CHANGE_ITEM_ZONE_SIZE];
+            if (position % CHANGE_ITEM_ZONE_SIZE == 0)
+            {
+                zone.minId = block[i].id;
+                zone.maxId = block[i].id;
+            }
+            widenZone(zone, block[i]);
+            position++;
+        }
+    }
+    items.seekToBeginning();
+
+    // fail if an element could not be read
+    if (position != elementCount)
+    {
+        return 1;
+    }
+    return (zoneCount > 0) && zoneFile.write(0, zones.data(), sizeof(change_item_zone) * zoneCount);
+}
+
+//========
+
+void ChangeItemDatabase::widenZone(change_item_zone& zone, const change_item& element)
+{
+    zone.minId = std::min(zone.minId, element.id);
+    zone.maxId = std::max(zone.maxId, element.id);
+    zone.statuses |= (element.status == 0) ? (1 << 8) : static_cast<uint8_t>(element.status);
+    zone.priorities |= ((element.priority >= 0) && (element.priority < 7)) ? (1 << element.priority) : (1 << 7);
+    zone.products |= zoneBloomBits(Dictionary::productNames.encode(element.product));
+    zone.releases |= zoneBloomBits(Dictionary::releaseIds.encode(element.release));
+}
+
+//========
+
+// passes over the zones whose summary rules out the codes, from the zone holding "from"
+int64_t ChangeItemDatabase::nextZone(const int32_t* codes, int64_t from)
+{
+    int64_t zoneNumber = from / CHANGE_ITEM_ZONE_SIZE;
+    if ((zoneNumber >= static_cast<int64_t>(zones.size())) || zoneMayMatch(zones[zoneNumber], codes))
+    {
+        return from;
+    }
+    do
+    {
+        zoneNumber++;
+    }
+    while ((zoneNumber < static_cast<int64_t>(zones.size())) && !zoneMayMatch(zones[zoneNumber], codes));
+    return zoneNumber * CHANGE_ITEM_ZONE_SIZE;
+}
+
+//========
+
+// the description of an element is at the position of the element, found from its ID
+int ChangeItemDatabase::readDescriptions(change_item* elements, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (descriptions.read(positionOf(elements[i].id), elements[i]))
+        {
+            return i;
+        }
+    }
+    return count;
+}
+
+//========
+
+// opens the archive file and loads the offset of each block and the redirects that follow the blocks
+// an empty file is an empty archive, and the database file must be open to check it against the archive
+bool ChangeItemDatabase::loadArchive(StorageBackend backend)
+{
+    archiveBlocks.clear();
+    redirects.clear();
+    if (archiveFile.open(archiveFilename, backend))
+    {
+        return 1;
+    }
+    int64_t size = archiveFile.getSize();
+    if (size == 0)
+    {
+        archiveBlocks.push_back(CHANGE_ARCHIVE_HEADER_SIZE);
+        return 0;
+    }
+
+    char header[CHANGE_ARCHIVE_HEADER_SIZE];
+    if ((size < CHANGE_ARCHIVE_HEADER_SIZE) || archiveFile.read(0, header, CHANGE_ARCHIVE_HEADER_SIZE) || memcmp(header, CHANGE_ARCHIVE_MAGIC, RECORD_MAGIC_SIZE))
+    {
+        return 1;
+    }
+    const char* field = header + RECORD_MAGIC_SIZE;
+    uint32_t version = static_cast<uint32_t>(unpackInt(field, 4));
+    int64_t blockCount = unpackInt(field, 8);
+    int64_t redirectCount = unpackInt(field, 8);
+    int64_t blocksEnd = unpackInt(field, 8);
+
+    // the block offsets and redirects, 8 bytes each, fill the file from the end of the blocks
+    if ((version != CHANGE_ARCHIVE_VERSION) || (blockCount < 0) || (redirectCount < 0) || (blocksEnd < CHANGE_ARCHIVE_HEADER_SIZE)
+        || (blockCount > size / 8) || (redirectCount > size / 8) || (blocksEnd + 8 * (blockCount + redirectCount) != size))
+    {
+        return 1;
+    }
+    std::vector<char> directory(8 * (blockCount + redirectCount));
+    if (!directory.empty() && archiveFile.read(blocksEnd, directory.data(), directory.size()))
+    {
+        return 1;
+    }
+
+    // blocks follow one another from the header, and redirects are in order of ID, each naming a block
+    field = directory.data();
+    for (int64_t i = 0; i < blockCount; i++)
+    {
+        int64_t offset = unpackInt(field, 8);
+        bool follows = archiveBlocks.empty() ? (offset == CHANGE_ARCHIVE_HEADER_SIZE) : (offset > archiveBlocks.back());
+        if (!follows || (offset >= blocksEnd))
+        {
+            archiveBlocks.clear();
+            return 1;
+        }
+        archiveBlocks.push_back(offset);
+    }
+    if ((blockCount == 0) && (blocksEnd != CHANGE_ARCHIVE_HEADER_SIZE))
+    {
+        return 1;
+    }
+    archiveBlocks.push_back(blocksEnd);
+    for (int64_t i = 0; i < redirectCount; i++)
+    {
+        change_item_redirect redirect;
+        redirect.id = static_cast<int32_t>(unpackInt(field, 4));
+        redirect.block = static_cast<int32_t>(unpackInt(field, 4));
+        if ((redirect.id < 1) || (!redirects.empty() && (redirect.id <= redirects.back().id)) || (redirect.block < 0) || (redirect.block >= blockCount))
+        {
+            archiveBlocks.clear();
+            redirects.clear();
+            return 1;
+        }
+        redirects.push_back(redirect);
+    }
+
+    // the database file must hold the elements the archive does not, so its last element is where the redirects place it
+    change_item last;
+    if ((items.getCount() > 0) && (items.read(items.getCount() - 1, last) || (positionOf(last.id) != items.getCount() - 1)))
+    {
+        archiveBlocks.clear();
+        redirects.clear();
+        return 1;
+    }
+    return 0;
+}
+
+//========
+
+bool ChangeItemDatabase::readArchiveBlock(int64_t block, std::vector<change_item>& elements)
+{
+    if ((block < 0) || (block + 1 >= static_cast<int64_t>(archiveBlocks.size())))
+    {
+        return 1;
+    }
+    std::vector<char> bytes(archiveBlocks[block + 1] - archiveBlocks[block]);
+    if (bytes.empty() || archiveFile.read(archiveBlocks[block], bytes.data(), bytes.size()))
+    {
+        return 1;
+    }
+    return unpackArchiveBlock(bytes.data(), bytes.size(), elements);
+}
+
+//========
+
+// reads every block of the archive, as archived elements are tallied with the others
+bool ChangeItemDatabase::tallyArchive()
+{
+    std::vector<change_item> block;
+    for (int64_t i = 0; i + 1 < static_cast<int64_t>(archiveBlocks.size()); i++)
+    {
+        if (readArchiveBlock(i, block))
+        {
+            return 1;
+        }
+        for (size_t j = 0; j < block.size(); j++)
+        {
+            tallies[tallySlot(block[j])]++;
+        }
+    }
+    return 0;
+}
+
+//========
+
+// a new archive file beside the old one is of an archive that was not committed, so the files it wrote are removed
+// once committed, the new database and description files replace the old ones, repeating nothing already done
+bool ChangeItemDatabase::finishArchive()
+{
+    std::string archivePath = std::string(archiveFilename) + ARCHIVE_SUFFIX;
+    std::string itemPath = std::string(filename) + ARCHIVE_SUFFIX;
+    std::string descriptionPath = std::string(descriptionFilename) + ARCHIVE_SUFFIX;
+
+    if (fileExists(archivePath.c_str()))
+    {
+        if (fileExists(archiveFilename))
+        {
+            std::remove(archivePath.c_str());
+            std::remove(itemPath.c_str());
+            std::remove(descriptionPath.c_str());
+            return 0;
+        }
+        if (StorageFile::replaceFile(archivePath.c_str(), archiveFilename))
+        {
+            return 1;
+        }
+    }
+    if (!fileExists(itemPath.c_str()) && !fileExists(descriptionPath.c_str()))
+    {
+        return 0;
+    }
+
+    // the index and zone files are of the old database file, so they are removed first and rebuilt at the next init
+    std::remove(indexFilename);
+    std::remove(zoneFilename);
+    if (fileExists(itemPath.c_str()) && StorageFile::replaceFile(itemPath.c_str(), filename))
+    {
+        return 1;
+    }
+    if (fileExists(descriptionPath.c_str()) && StorageFile::replaceFile(descriptionPath.c_str(), descriptionFilename))
+    {
+        return 1;
+    }
+    return 0;
+}
+
+//========
+
+// the database file holds the elements not archived in order of ID, so the position of an element is its ID less one,
+// less the number of archived elements before it
+int64_t ChangeItemDatabase::positionOf(int32_t id)
+{
+    std::vector<change_item_redirect>::const_iterator redirect = std::lower_bound(redirects.begin(), redirects.end(), id, redirectBefore);
+    if ((redirect != redirects.end()) && (redirect->id == id))
+    {
+        return -1;
+    }
+    return static_cast<int64_t>(id) - 1 - (redirect - redirects.begin());
 }
 
 //========
 
-#endif
\ No newline at end of file
+#endif
@@ -2,6 +2,43 @@
 description:
 This is the module for maintenance of the change item objects.
 version history:
+ver20 -26/10/17
+        -added mayMatchBlock with a given kernel, and hasKernel, so test drivers check every kernel
+ver19 -26/10/17
+        -added change_item_redirect, left behind by an element moved to the archive
+        -added archive and readElement
+ver18 -26/10/17
+        -getChangeItemCount returns a 64 bit count
+ver17 -26/10/17
+        -added change_item_zone, the summary of a zone of the database file, and the zone map
+ver16 -26/10/17
+        -descriptions packed by ChangeDescriptionTraits into their own file, format version 3 without them
+        -added migrate
+        -removed ChangeItemTraits::DESCRIPTION_OFFSET
+ver15 -26/10/17
+        -added ChangeItemTraits::mayMatchBlock, checking a block of packed records for the filtered scans
+ver14 -26/10/17
+        -added ChangeItemTraits::DESCRIPTION_OFFSET
+ver13 -26/10/17
+        -change items store their product and release as ids of the shared dictionaries, format version 2
+        -added ChangeItemTraits hooks reading version 1 records and checking filters on packed records
+ver12 -26/10/17
+        -change items packed by ChangeItemTraits, for the packed record format of RecordStore
+ver11 -26/10/17
+        -added getNextUnresolved, reading the unresolved change items of a product from a list kept for each product
+ver10 -26/10/17
+        -added countItems, counting change items from a tally of each product, status and priority
+ver9 -26/10/17
+        -added search, finding change items by description through a trigram index
+ver8 -26/10/17
+        -product index, and indexes kept in Change.idx
+ver7 -26/10/17
+        -bitmap indexes on status and priority used by the filtered reads
+ver6 -26/10/17
+        -elements stored in a RecordStore, filtering moved to ChangeItemTraits
+ver5 -26/10/17
+        -file access through StorageFile, backend chosen at init
+        -added getNextBatch
 ver4 -24/07/25 update by Nicolao
         -separation of the change item and request modules
 ver3 -24/07/13, cleaning up errors by Nicolao
@@ -20,13 +57,21 @@ ver1 -24/07/02, original by Wah Paw Hser and Puja Shah
 //==================
 
 #include <stdint.h>
-#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "CompressedBitmap.h"
 #include "Constants.h"
+#include "RecordStore.h"
+#include "StorageFile.h"
 
 //==================
 
 enum ChangeItemStates{unreviewed = 1, reviewed = 2, inProgress = 4, done = 8, cancelled = 16}; // possible values for status
 enum PriorityStates{lowest, low, middle, high, highest}; // possible values for priority
+enum ChangeItemKernel{scalarKernel, sse2Kernel, avx2Kernel}; // ways mayMatchBlock can check a block of change items
 
 //==================
 
@@ -40,6 +85,217 @@ typedef struct
     char description[MAX_DESCRIPTION_SIZE] = "";
 }change_item;
 
+// packing and filtering of change items for the RecordStore holding them
+struct ChangeItemTraits : RecordTraits
+{
+    static constexpr char MAGIC[9] = "\211ITSITEM"; // names change item files in their header
+    static const uint32_t FORMAT_VERSION = 3; // version 3 leaves the description to ChangeDescriptionTraits
+    static const int RECORD_SIZE = 4 + 1 + 1 + 4 + 4; // bytes of a packed change item
+    static const int FILTER_CODES = 5; // id, status, priority, product id and release id of a filter
+
+    static void pack(
+        /* element to pack
+        used as input */
+        const change_item& element,
+        /* RECORD_SIZE bytes the element is packed into
+        used as output, mutates */
+        char* bytes
+    );
+    /* description:
+        packs the fields of the element in the order they are declared, the product and release as their
+        ids in Dictionary::productNames and Dictionary::releaseIds. the description is not packed.
+    preconditions:
+        the shared dictionaries are open.
+    */
+
+    static void unpack(
+        /* RECORD_SIZE bytes of a packed element
+        used as input */
+        const char* bytes,
+        /* used to store the element unpacked
+        used as output, mutates */
+        change_item& element
+    );
+    /* description:
+        reads back the fields of an element packed by pack, leaving the description empty.
+    preconditions:
+        the shared dictionaries are open.
+    */
+
+    static int formatSize(
+        /* earlier format version
+        used as input */
+        uint32_t version
+    );
+    /* returns:
+        the size of a record packed in the version, 0 if the version is unknown.
+    */
+
+    static void unpackFormat(
+        /* earlier format version
+        used as input */
+        uint32_t version,
+        /* bytes of an element packed in the version
+        used as input */
+        const char* bytes,
+        /* used to store the element unpacked
+        used as output, mutates */
+        change_item& element
+    );
+    /* description:
+        reads back an element packed in an earlier version, version 1 holding the product and release as strings,
+        and versions 1 and 2 holding the description.
+    */
+
+    static void encodeFilter(
+        /* filter to encode
+        used as input */
+        const change_item& filter,
+        /* used to store FILTER_CODES codes, -1 for a field not filtered on
+        used as output, mutates */
+        int32_t* codes
+    );
+    /* description:
+        gives the integer fields of the filter, and the dictionary ids of its product and release,
+        -2 for a string in no record.
+    */
+
+    static bool mayMatch(
+        /* RECORD_SIZE bytes of a packed element
+        used as input */
+        const char* bytes,
+        /* codes given by encodeFilter
+        used as input */
+        const int32_t* codes
+    );
+    /* returns:
+        false if the packed element certainly does not match the filter of the codes.
+    */
+
+    static uint64_t mayMatchBlock(
+        /* count packed elements of RECORD_SIZE bytes each
+        used as input */
+        const char* bytes,
+        /* number of elements in the block, at most 64
+        used as input */
+        int count,
+        /* codes given by encodeFilter
+        used as input */
+        const int32_t* codes
+    );
+    /* description:
+        checks a block of elements as mayMatch checks one. on x86 processors the elements are checked
+        8 at a time with AVX2, or 4 at a time with SSE2, whichever the processor running the program has.
+    returns:
+        a mask with bit n set for element n of the block, unless mayMatch rules the element out.
+    */
+
+    static uint64_t mayMatchBlock(
+        /* count packed elements of RECORD_SIZE bytes each
+        used as input */
+        const char* bytes,
+        /* number of elements in the block, at most 64
+        used as input */
+        int count,
+        /* codes given by encodeFilter
+        used as input */
+        const int32_t* codes,
+        /* kernel checking the block
+        used as input */
+        ChangeItemKernel kernel
+    );
+    /* description:
+        checks a block of elements as mayMatchBlock does, with the kernel given in place of the one chosen
+        for the processor. used by test drivers to check every kernel against mayMatch.
+    preconditions:
+        hasKernel(kernel) is true.
+    returns:
+        a mask with bit n set for element n of the block, unless mayMatch rules the element out.
+    */
+
+    static bool hasKernel(
+        /* kernel to check for
+        used as input */
+        ChangeItemKernel kernel
+    );
+    /* returns:
+        true if the kernel is built into the program and the processor running the program can run it.
+    */
+
+    static bool matches(
+        /* element to check
+        used as input */
+        const change_item& element,
+        /* filter to check against
+        used as input */
+        const change_item& filter
+    );
+    /* returns:
+        true if the element matches every defined field of the filter.
+    */
+};
+
+// packing of the descriptions of change items, stored apart from the other fields
+// the description of an element is at the element's position in its own RecordStore, as no scan filters on it
+struct ChangeDescriptionTraits : RecordTraits
+{
+    static constexpr char MAGIC[9] = "\211ITSDESC"; // names change item description files in their header
+    static const int RECORD_SIZE = MAX_DESCRIPTION_SIZE - 1; // bytes of a packed description
+
+    static void pack(
+        /* element whose description is packed
+        used as input */
+        const change_item& element,
+        /* RECORD_SIZE bytes the description is packed into
+        used as output, mutates */
+        char* bytes
+    );
+
+    static void unpack(
+        /* RECORD_SIZE bytes of a packed description
+        used as input */
+        const char* bytes,
+        /* used to store the description unpacked, its other fields are left as they are
+        used as output, mutates */
+        change_item& element
+    );
+
+    static bool matches(
+        /* element to check
+        used as input */
+        const change_item& element,
+        /* filter to check against
+        used as input */
+        const change_item& filter
+    );
+    /* returns:
+        true, as descriptions are never filtered on.
+    */
+};
+
+// summary of the elements of one zone of the database file, CHANGE_ITEM_ZONE_SIZE positions long
+// a zone may hold an element matching a filter only if its summary admits the filter
+typedef struct
+{
+    int32_t minId; // smallest ID in the zone
+    int32_t maxId; // largest ID in the zone
+    uint16_t statuses; // bits of the status values in the zone, bit 8 set if a status value is 0
+    uint8_t priorities; // bit n set if an element of the zone holds priority n, bit 7 for priorities outside 0 to 6
+    uint64_t products; // Bloom filter of the product ids of the zone
+    uint64_t releases; // Bloom filter of the release ids of the zone
+}change_item_zone;
+
+const int64_t CHANGE_ITEM_ZONE_SIZE = 4096; // positions summarised by one zone
+
+// redirect left behind by an archived element, naming the block of the archive holding it
+typedef struct
+{
+    int32_t id; // ID of the archived element
+    int32_t block; // number of the archive block holding the element
+}change_item_redirect;
+
+const int CHANGE_ARCHIVE_BLOCK_SIZE = 64; // most elements packed in one block of the archive
+
 //==================
 
 // class managing file interaction with change item database
@@ -47,7 +303,11 @@ typedef struct
 class ChangeItemDatabase
 {
     public:
-    static bool init();
+    static bool init(
+        /* way in which the database file is accessed
+        used as input */
+        StorageBackend backend = DEFAULT_STORAGE_BACKEND
+    );
     /* description:
         this function prepares the database for interaction.
     preconditions:
@@ -113,12 +373,83 @@ class ChangeItemDatabase
     /* description:
         saves the next change item to the change item "readInto".
         will only get change items matching the paramatres of the change item referenced by "filter".
+        when the filter defines a status, a priority or a product, only the change items listed by the indexes are read,
+        otherwise the zones whose summary rules out the filter are not read.
     postconditions:
         position in file will increase.
     returns:
         return 0 on successful read, return 1 on failure.
     */
 
+    static int getNextBatch(
+        /* used to store the change items read in by getNextBatch
+        used as output, mutates */
+        change_item* readInto,
+        /* maximum number of change items to store in readInto
+        used as input */
+        int maxCount,
+        /* used to filter, getNextBatch will only get change items matching the defined paramatres of the passed change item
+        used as input, does not mutate*/
+        const change_item& filter
+    );
+    /* description:
+        saves up to maxCount of the next change items matching the filter to the array "readInto".
+        when the filter defines a status, a priority or a product, only the change items listed by the indexes are read,
+        otherwise the file is read BATCH_READ_SIZE elements at a time, except the zones whose summary rules out the filter.
+    postconditions:
+        position in file will increase.
+        every change item saved can be retrieved again by select.
+    returns:
+        the number of change items saved, 0 when no more change items match.
+    */
+
+    static int getNextUnresolved(
+        /* used to store the change items read in by getNextUnresolved
+        used as output, mutates */
+        change_item* readInto,
+        /* maximum number of change items to store in readInto
+        used as input */
+        int maxCount,
+        /* name of the product whose change items are read
+        used as input */
+        const char* product
+    );
+    /* description:
+        saves up to maxCount of the next unreviewed, reviewed or inProgress change items of the product to the array "readInto",
+        in order of ID. only the change items in the product's list of unresolved change items are read.
+    postconditions:
+        position in file will increase.
+        every change item saved can be retrieved again by select.
+    returns:
+        the number of change items saved, 0 when no more change items of the product are unresolved.
+    */
+
+    static int search(
+        /* used to store the change items found, most similar first
+        used as output, mutates */
+        change_item* readInto,
+        /* maximum number of change items to store in readInto
+        used as input */
+        int maxCount,
+        /* text to look for in the descriptions
+        used as input */
+        const char* text,
+        /* used to filter, search will only get change items matching the defined paramatres of the passed change item
+        used as input, does not mutate*/
+        const change_item& filter
+    );
+    /* description:
+        saves up to maxCount of the change items matching the filter whose description is most similar to text.
+        similarity is the number of the trigrams of the words of text found in the description, letter case ignored.
+        change items sharing fewer than half of those trigrams are not saved, and ties are saved by ID.
+        the trigram index is built on the first search, and kept up to date by writeElement from then on.
+    postconditions:
+        position in file is unchanged.
+        every change item saved can be retrieved again by select, in the order saved.
+    returns:
+        the number of change items saved, 0 when none is similar to text.
+    */
+
     static bool select(
         /* used to store the change item read in by select
         used as output, mutates */
@@ -148,23 +479,118 @@ class ChangeItemDatabase
         return 0 on successful seek, return 1 on failure.
     */    
 
-    static int getChangeItemCount();
+    static bool migrate();
+    /* description:
+        converts the database file of an earlier version to the current format, moving the descriptions
+        it holds to the description file. init converts the file itself, so this is only needed to convert
+        the file ahead of time.
+    preconditions:
+        the ChangeItemDatabase is uninitialised, and the shared dictionaries are open.
+    returns:
+        return 0 if the database file is in the current format, return 1 if it could not be converted.
+    */
+
+    static bool readElement(
+        /* used to store the change item read in by readElement
+        used as output, mutates */
+        change_item& readInto,
+        /* ID of the change item to read
+        used as input */
+        int32_t id
+    );
+    /* description:
+        saves the change item of an ID to the change item "readInto", reading it from the archive if it is archived.
+    postconditions:
+        position in file and the items available to select are unchanged.
+    returns:
+        return 0 on successful read, return 1 if no change item has the ID or it could not be read.
+    */
+
+    static bool archive();
+    /* description:
+        moves the done and cancelled change items out of the database file into the archive, a read only file
+        of compressed blocks, leaving a redirect from each ID moved to its block. the getNext, getNextBatch,
+        getNextUnresolved and search reads only read the change items left in the database file, while
+        readElement and countItems still find the archived ones. archived change items keep their ID.
+    preconditions:
+        the ChangeItemDatabase and the WriteAheadLog are uninitialised, and the shared dictionaries are open.
+    postconditions:
+        the database file only holds change items that are not done or cancelled.
+    returns:
+        return 0 on success, return 1 on failure.
+    */
+
+    static int64_t getChangeItemCount();
     /* description:
         returns changeItemCount
-    returns: number of change items in the database
+    returns: number of change items in the database, archived change items included
 
     */
-    private:
 
-    // utilities for select
-    static int64_t previouslyAccessed[20]; // records the indexes of the previous elements accessed, circular array
-    static int64_t previouslyAccessedPosition; // position in previously accessed
+    static int64_t countItems(
+        /* filter whose product, status and priority are counted, other fields are ignored
+        used as input */
+        const change_item& filter
+    );
+    /* description:
+        counts the elements matching the product, status and priority defined by the filter, as getNext matches them.
+        archived elements are counted too.
+        only the tallies of each product, status and priority are read, never the database file.
+    returns:
+        the number of matching elements, 0 if the database is uninitialised.
+    */
+
+    private:
+    static bool loadIndexes(StorageBackend backend); // loads the index file, rebuilding it if it does not match the database, return 0 on success
+    static void indexElement(int64_t position, const change_item& element); // adds an element to the indexes
+    static void unindexElement(int64_t position, const change_item& element); // removes an element from the indexes
+    static int64_t nextIndexed(const change_item& filter, int64_t from); // next position from "from" listed by the indexes for the filter, -1 if none
+    static bool buildTrigramIndex(); // indexes the description of every element of the database file, return 0 on success
+    static bool loadTallies(StorageBackend backend); // loads the tally file, return 0 if its tallies add up to the element count
+    static bool saveTallies(StorageBackend backend); // writes every tally to the emptied tally file, return 0 on success
+    static int64_t tallySlot(const change_item& element); // entry of the element's product, status and priority in the tally file, added if new
+    static int readDescriptions(change_item* elements, int count); // reads the descriptions of elements read without them, returns the number read before a failure
+    static bool loadZones(StorageBackend backend); // loads the zone file, rebuilding it if it does not cover the database, return 0 on success
+    static void widenZone(change_item_zone& zone, const change_item& element); // adds an element to the summary of its zone
+    static int64_t nextZone(const int32_t* codes, int64_t from); // first position from "from" in a zone that may hold an element matching the codes of a filter
+    static bool loadArchive(StorageBackend backend); // opens the archive file and loads its block offsets and redirects, return 0 on success
+    static bool readArchiveBlock(int64_t block, std::vector<change_item>& elements); // reads and unpacks the elements of a block of the archive, return 0 on success
+    static bool tallyArchive(); // adds every archived element to the tallies, return 0 on success
+    static bool finishArchive(); // completes or abandons an archive interrupted by a crash, return 0 on success
+    static int64_t positionOf(int32_t id); // position in the database file of the element of an ID, -1 if the element is archived
 
     // utilities for file interaction
     static const char* filename;
-    static std::fstream itemData; // database elements
-    static int64_t fileIndex; // currently viewed element in database file
-    static int64_t changeItemCount; // this value is caculated at initialisation
+    static RecordStore<change_item, ChangeItemTraits> items; // database elements without descriptions, read position and select cache
+    static const char* descriptionFilename;
+    static RecordStore<change_item, ChangeDescriptionTraits> descriptions; // description of each element, at the element's position
+
+    // utilities for the indexes
+    static const char* indexFilename;
+    static StorageFile indexFile; // indexed fields of each element, one entry per element
+    static std::map<int8_t, CompressedBitmap> statusIndex; // positions of the elements holding each status value
+    static std::map<int8_t, CompressedBitmap> priorityIndex; // positions of the elements holding each priority value
+    static std::map<std::string, CompressedBitmap> productIndex; // positions of the elements of each product
+    static std::map<std::string, CompressedBitmap> unresolvedIndex; // positions of the elements of each product not done or cancelled
+    static std::unordered_map<uint32_t, CompressedBitmap> trigramIndex; // positions of the elements whose description holds each trigram
+    static bool trigramIndexBuilt; // true once the trigram index holds every element
+
+    // utilities for the zone map
+    static const char* zoneFilename;
+    static StorageFile zoneFile; // summary of each zone, one entry per zone
+    static std::vector<change_item_zone> zones; // summary of each zone, in order of position
+
+    // utilities for the archive
+    static const char* archiveFilename;
+    static StorageFile archiveFile; // blocks of archived elements, then the offset of each block and the redirects
+    static std::vector<int64_t> archiveBlocks; // offset of each block in the archive file, then the end of the last block
+    static std::vector<change_item_redirect> redirects; // redirect of each archived element, in order of ID
+
+    // utilities for the tallies
+    static const char* tallyFilename;
+    static StorageFile tallyFile; // element count of each product, status and priority, one entry per combination
+    static std::map<std::tuple<std::string, int8_t, int8_t>, int64_t> tallySlots; // entry of each product, status and priority in the tally file
+    static std::vector<int64_t> tallies; // element count of each entry of the tally file
 };
 
 #endif
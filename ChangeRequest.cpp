@@ -4,8 +4,41 @@ Module implementing change requests.
 
 elements are unordered for add in O(1)
 elements are searched linearly for simplicity and assurance of functionality
+except when filtering by change item, where the changeItemId index gives the positions of
+the matching elements directly
 
 version history:
+ver16 -26/10/17
+        -the index files are StorageFiles written in the log group of the request, writeElement failing when an entry cannot be written
+ver15 -26/10/17
+        -request dates not on the calendar are refused by write and migrate instead of stored as the empty date
+ver14 -26/10/17
+        -writeElement fails when a new release cannot be added to its dictionary
+ver13 -26/10/17
+        -requesterId packed in 4 bytes, format version 4
+        -reads raw records of the struct holding a 16 bit requesterId, and version 3 records
+ver12 -26/10/17
+        -added mayMatchBlock
+ver11 -26/10/17
+        -request dates packed as days since 1970-01-01, version 2 files converted when opened
+        -added request date index, kept in RequestDate.idx and sorted by date in memory
+        -added getNextByDate
+ver10 -26/10/17
+        -releases packed as dictionary ids, version 1 files converted when opened
+        -init and uninit open and close the shared dictionaries
+ver9 -26/10/17
+        -added ChangeRequestTraits pack and unpack, the database file is in the packed record format
+ver8 -26/10/17
+        -elements stored in a RecordStore, which holds the read position and select cache
+        -init and uninit check whether the store is open, so the database can be initialised again after uninit
+ver7 -26/10/17
+        -file access through StorageFile, so the file may be memory mapped
+        -elements are tracked by element index instead of stream position
+        -added getNextBatch, reading BATCH_READ_SIZE elements per file access
+ver6 -26/10/17
+        -added changeItemId postings index, kept in Request.idx
+            -one entry appended per written request
+            -filtered getNext reads only the indexed requests when filtering by change item
 ver5 -24/07/16, update by Nicolao
         -separation of change item and change request modules
         -update to init function
@@ -29,138 +62,313 @@ ver1 -24/07/12, original by Nicolao
 
 #include "ChangeRequest.h"
 #include "Constants.h"
-#include <fstream>
+#include "Date.h"
+#include "Dictionary.h"
+#include "StorageFile.h"
+#include "WriteAheadLog.h"
+#include <cstdio>
 #include <cstring>
+#include <algorithm>
 
 //==================
 
-// utilities for select
-int64_t ChangeRequestDatabase::previouslyAccessed[20]; // records the indexes of the previous elements accessed, circular array
-int64_t ChangeRequestDatabase::previouslyAccessedPosition = 0; // position in previously accessed
-
 // utilities for file interaction
 const char* ChangeRequestDatabase::filename = "Request.dat";
-std::fstream ChangeRequestDatabase::requestData; // database elements
-int64_t ChangeRequestDatabase::changeRequestCount = 0; // this value is determined at initialisation
+RecordStore<change_request, ChangeRequestTraits> ChangeRequestDatabase::requests; // database elements, read position and select cache
+
+// utilities for the changeItemId index
+const char* ChangeRequestDatabase::indexFilename = "Request.idx";
+StorageFile ChangeRequestDatabase::indexFile; // index entries
+std::unordered_map<int32_t, std::vector<int64_t>> ChangeRequestDatabase::itemIndex; // postings of each change item
+
+// entry of the changeItemId index file
+typedef struct
+{
+    int32_t changeItemId;
+    int64_t position; // element position in request file
+}request_index_entry;
+
+// utilities for the request date index
+const char* ChangeRequestDatabase::dateIndexFilename = "RequestDate.idx";
+StorageFile ChangeRequestDatabase::dateIndexFile; // date index entries
+std::vector<std::pair<int32_t, int64_t>> ChangeRequestDatabase::dateIndex; // days and position of each request, sorted
+std::pair<int32_t, int64_t> ChangeRequestDatabase::dateCursor(NO_DATE, -1); // date index entry last read
+
+// entry of the request date index file
+typedef struct
+{
+    int32_t days; // request date, NO_DATE for a request without one
+    int64_t position; // element position in request file
+}request_date_entry;
+
+// layout of the raw records written before the file header, holding a 16 bit requesterId
+typedef struct
+{
+    int32_t changeItemId;
+    int16_t requesterId;
+    char requestDate[DATE_SIZE];
+    char release[MAX_RELEASE_ID_SIZE];
+}change_request_raw;
 
 //==================
 
 // long term storage is implemented through locally stored files
-// gets request count by dividing file content length by number size of entry
-bool ChangeRequestDatabase::init()
+// request count is found from the size of the file
+bool ChangeRequestDatabase::init(StorageBackend backend)
 {
     // assert that the module is only initialised once
-    static bool isInitialised = 0;
-    if (isInitialised)
+    if (requests.isOpen())
     {
         return 1;
     }
     
-    // open database file 
-    requestData.open(filename, std::ios::in | std::ios::out | std::ios::binary);
-    if (!requestData.is_open()) // if file not found create file
+    // open the dictionaries releases are encoded by, before the file is migrated or read
+    if (Dictionary::initShared(backend))
     {
-        requestData.clear();
-        std::ofstream createFile(filename, std::ios::out | std::ios::binary);
-        createFile.close();
-        requestData.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        return 1;
     }
 
-    if (!requestData.is_open()) // if file still cannot be opened fail to initialise
+    // open database file, file is created if not found
+    if (requests.open(filename, backend)) // if file cannot be opened fail to initialise
     {
+        Dictionary::uninitShared();
         return 1;
     }
 
-    // retrieve from file the first element. first element contains info about number of elements
-    requestData.seekg(0, std::ios::end);
-    changeRequestCount = ((requestData.tellg()) / (sizeof(change_request)));
-    seekToBeginning();
+    // load changeItemId index and request date index
+    if (loadIndex(backend) || loadDateIndex(backend))
+    {
+        dateIndexFile.close();
+        dateIndex.clear();
+        indexFile.close();
+        itemIndex.clear();
+        requests.close();
+        Dictionary::uninitShared();
+        return 1;
+    }
 
     // successful run
-    isInitialised = 1;
     return 0;
 }
 
 //========
 
-// closes file
-bool ChangeRequestDatabase::uninit()
+// opens the index file and loads its postings
+// the index holds one entry per request, if it does not it is rebuilt with one scan of the request file
+bool ChangeRequestDatabase::loadIndex(StorageBackend backend)
 {
-    // assert that module is only unintialised once
-    static bool isUninitialised = 0;
-    if (isUninitialised)
+    // open index file, file is created if not found
+    if (indexFile.open(indexFilename, backend))
     {
         return 1;
     }
 
-    // clean up
-    // close file
-    requestData.close();
+    itemIndex.clear();
 
-    // successful run
-    isUninitialised = 1;
+    int64_t entryCount = requests.getCount();
+    int64_t position = 0;
+    request_index_entry block[BATCH_READ_SIZE];
+
+    // index matches database, load postings BATCH_READ_SIZE entries at a time
+    // entries are appended in file order so each posting list is ascending
+    if (indexFile.getSize() == static_cast<int64_t>(sizeof(request_index_entry)) * entryCount)
+    {
+        while (position < entryCount)
+        {
+            int64_t blockCount = std::min<int64_t>(entryCount - position, BATCH_READ_SIZE);
+            if (indexFile.read(sizeof(request_index_entry) * position, block, sizeof(request_index_entry) * blockCount))
+            {
+                return 1;
+            }
+            for (int64_t i = 0; i < blockCount; i++)
+            {
+                itemIndex[block[i].changeItemId].push_back(block[i].position);
+            }
+            position += blockCount;
+        }
+        return 0;
+    }
+
+    // index is out of date, rebuild from request file
+    indexFile.close();
+    std::remove(indexFilename);
+    if (indexFile.open(indexFilename, backend))
+    {
+        return 1;
+    }
+
+    change_request element;
+    request_index_entry entry;
+    for (; position < entryCount; position++)
+    {
+        if (requests.read(position, element))
+        {
+            return 1;
+        }
+        entry.changeItemId = element.changeItemId;
+        entry.position = position;
+        if (indexFile.write(sizeof(request_index_entry) * position, &entry, sizeof(request_index_entry)))
+        {
+            return 1;
+        }
+        itemIndex[entry.changeItemId].push_back(entry.position);
+    }
     return 0;
 }
 
 //========
 
-// save an element to database by copying it into a buffer of bytes and then writing those bytes to file
-bool ChangeRequestDatabase::writeElement(change_request& readIn)
+// opens the date index file and loads its entries, sorting them by date
+// the file holds one entry per request in file order, if it does not it is rebuilt with one scan of the request file
+bool ChangeRequestDatabase::loadDateIndex(StorageBackend backend)
 {
-    // fail if uninitialised
-    if (!requestData.is_open())
+    // open date index file, file is created if not found
+    if (dateIndexFile.open(dateIndexFilename, backend))
     {
         return 1;
     }
 
-    // case for create new
-    if ((readIn.requesterId != -1) && (readIn.changeItemId != -1)) // the change request has some associated requester and item
+    dateIndex.clear();
+    dateCursor = std::make_pair(NO_DATE, int64_t(-1));
+
+    int64_t entryCount = requests.getCount();
+    int64_t position = 0;
+    request_date_entry block[BATCH_READ_SIZE];
+    dateIndex.reserve(entryCount);
+
+    // index matches database, load entries BATCH_READ_SIZE at a time
+    if (dateIndexFile.getSize() == static_cast<int64_t>(sizeof(request_date_entry)) * entryCount)
     {
-        requestData.seekp(sizeof(change_request) * changeRequestCount);
-        changeRequestCount++;
+        while (position < entryCount)
+        {
+            int64_t blockCount = std::min<int64_t>(entryCount - position, BATCH_READ_SIZE);
+            if (dateIndexFile.read(sizeof(request_date_entry) * position, block, sizeof(request_date_entry) * blockCount))
+            {
+                return 1;
+            }
+            for (int64_t i = 0; i < blockCount; i++)
+            {
+                dateIndex.push_back(std::make_pair(block[i].days, block[i].position));
+            }
+            position += blockCount;
+        }
+        std::sort(dateIndex.begin(), dateIndex.end());
+        return 0;
     }
-    else
+
+    // index is out of date, rebuild from request file
+    dateIndexFile.close();
+    std::remove(dateIndexFilename);
+    if (dateIndexFile.open(dateIndexFilename, backend))
     {
         return 1;
     }
 
-    // write to file
-    char buffer[sizeof(change_request)];
-    memcpy(buffer, &readIn, sizeof(change_request));
-    requestData.write(buffer, sizeof(change_request));
+    change_request element;
+    request_date_entry entry;
+    for (; position < entryCount; position++)
+    {
+        if (requests.read(position, element))
+        {
+            return 1;
+        }
+        entry.days = dateToDays(element.requestDate);
+        entry.position = position;
+        if (dateIndexFile.write(sizeof(request_date_entry) * position, &entry, sizeof(request_date_entry)))
+        {
+            return 1;
+        }
+        dateIndex.push_back(std::make_pair(entry.days, entry.position));
+    }
+    std::sort(dateIndex.begin(), dateIndex.end());
     return 0;
 }
 
 //========
 
-// loads a read from the file into passed request
-bool ChangeRequestDatabase::getNext(change_request& readInto)
+// closes file
+bool ChangeRequestDatabase::uninit()
+{
+    // assert that module is only unintialised once
+    if (!requests.isOpen())
+    {
+        return 1;
+    }
+
+    // clean up
+    // close files
+    indexFile.close();
+    itemIndex.clear();
+    dateIndexFile.close();
+    dateIndex.clear();
+    bool failed = requests.close();
+    return Dictionary::uninitShared() || failed;
+}
+
+//========
+
+// save an element to database by copying it into a buffer of bytes and then writing those bytes to file
+bool ChangeRequestDatabase::writeElement(change_request& readIn)
 {
     // fail if uninitialised
-    if (!requestData.is_open())
+    if (!requests.isOpen())
     {
         return 1;
     }
 
-    // record index
-    int elementPosition = requestData.tellg();
-    // buffer byte block for contentss
-    char buffer[sizeof(change_request)];
-    // read to buffer
-    requestData.read(buffer, sizeof(change_request));
+    // case for create new
+    int64_t elementPosition;
+    if ((readIn.requesterId != -1) && (readIn.changeItemId != -1)) // the change request has some associated requester and item
+    {
+        elementPosition = requests.getCount();
+    }
+    else
+    {
+        return 1;
+    }
 
-    // assert the read succeeded
-    if (!requestData.good())
+    // fail if a new release cannot be added to its dictionary, as the request would be packed without it
+    if (Dictionary::releaseIds.encode(readIn.release) == -1)
     {
         return 1;
     }
 
-    // copy bytes of buffer into change_request
-    memcpy(&readInto, buffer, sizeof(change_request));
-    // cache the file index of this element
-    previouslyAccessed[previouslyAccessedPosition] = elementPosition;
-    previouslyAccessedPosition = (previouslyAccessedPosition + 1) % SIZE_OF_ACCESSED_INDEX_CACHE;
-    return 0;
+    // entries of the request in the changeItemId index and the date index
+    request_index_entry entry;
+    entry.changeItemId = readIn.changeItemId;
+    entry.position = elementPosition;
+    request_date_entry dateEntry;
+    dateEntry.days = dateToDays(readIn.requestDate);
+    dateEntry.position = elementPosition;
+
+    // write to file, and append the index entries in the same log group
+    // a failed write fails the request, leaving the in memory indexes unchanged, and the transaction
+    // writing the request aborts the log group, so neither index file is left out of step with the request file
+    WriteAheadLog::holdCommit();
+    bool failed = requests.write(elementPosition, readIn)
+        || indexFile.write(sizeof(request_index_entry) * elementPosition, &entry, sizeof(request_index_entry))
+        || dateIndexFile.write(sizeof(request_date_entry) * elementPosition, &dateEntry, sizeof(request_date_entry));
+    bool commitFailed = WriteAheadLog::releaseCommit();
+    if (failed)
+    {
+        return 1;
+    }
+
+    // add the request to its change item's postings
+    itemIndex[entry.changeItemId].push_back(entry.position);
+
+    // add the request to the date index, requests mostly arrive in date order so it is inserted near the end
+    std::pair<int32_t, int64_t> dated(dateEntry.days, dateEntry.position);
+    dateIndex.insert(std::upper_bound(dateIndex.begin(), dateIndex.end(), dated), dated);
+    return commitFailed;
+}
+
+//========
+
+// loads a read from the file into passed request
+bool ChangeRequestDatabase::getNext(change_request& readInto)
+{
+    return requests.getNext(readInto);
 }
 
 //========
@@ -171,107 +379,271 @@ bool ChangeRequestDatabase::getNext(change_request& readInto)
 bool ChangeRequestDatabase::getNext(change_request& readInto, change_request& filter)
 {
     // fail if uninitialised
-    if (!requestData.is_open())
+    if (!requests.isOpen())
     {
         return 1;
     }
 
-    // buffer byte block for contents
-    char buffer[sizeof(change_request)];
-    int elementPosition;
-
-    // read elements until finding one that meets filter requirements or until end of file is reached
-    while (1)
+    // filtering by change item, only visit the positions in that item's postings
+    if (filter.changeItemId != -1)
     {
-        // record index
-        elementPosition = requestData.tellg();
-        // read to buffer
-        requestData.read(buffer, sizeof(change_request));
-
-        // if no match is ever found and end of file is reached, exit
-        if (!requestData.good())
+        std::unordered_map<int32_t, std::vector<int64_t>>::const_iterator postings = itemIndex.find(filter.changeItemId);
+        if (postings == itemIndex.end())
         {
+            requests.setPosition(requests.getCount());
             return 1;
         }
 
-        // copy bytes of buffer into change_request
-        memcpy(&readInto, buffer, sizeof(change_request));
+        // skip the postings before the current position
+        std::vector<int64_t>::const_iterator candidate = std::lower_bound(postings->second.begin(), postings->second.end(), requests.getPosition());
+        for (; candidate != postings->second.end(); candidate++)
+        {
+            if (requests.read(*candidate, readInto))
+            {
+                return 1;
+            }
+
+            // deliver request if it satisfies the rest of the filter
+            if (ChangeRequestTraits::matches(readInto, filter))
+            {
+                // cache the file index of this element
+                requests.remember(*candidate);
+                requests.setPosition(*candidate + 1);
+                return 0;
+            }
+        }
 
-        bool idMatch = (filter.changeItemId == -1) || (readInto.changeItemId == filter.changeItemId);
-        bool requesterMatch = (filter.requesterId == -1) || (readInto.requesterId == filter.requesterId);
-        bool dateMatch = (!strcmp(filter.requestDate, "")) || (!strcmp(readInto.requestDate, filter.requestDate));
-        bool releaseMatch = (!strcmp(filter.release, "")) || (!strcmp(readInto.release, filter.release));
+        // no more postings, leave the file at its end
+        requests.setPosition(requests.getCount());
+        return 1;
+    }
 
-        // if match is found finish filtering and deliver request satisfying filters
-        if (idMatch && requesterMatch && dateMatch && releaseMatch)
+    // read elements until finding one that meets filter requirements or until end of file is reached
+    return requests.getNext(readInto, filter);
+}
+
+//========
+
+// loads up to maxCount requests similar to filter element into the passed array
+// reads the file in blocks of BATCH_READ_SIZE elements and filters each block in memory
+// when filtering by change item the indexed getNext is used, as the matches are not contiguous
+int ChangeRequestDatabase::getNextBatch(change_request* readInto, int maxCount, const change_request& filter)
+{
+    // filtering by change item, read each indexed match
+    if (filter.changeItemId != -1)
+    {
+        int found = 0;
+        change_request indexFilter = filter;
+        while ((found < maxCount) && !getNext(readInto[found], indexFilter))
         {
-            // cache the file index of this element
-            previouslyAccessed[previouslyAccessedPosition] = elementPosition;
-            previouslyAccessedPosition = (previouslyAccessedPosition + 1) % SIZE_OF_ACCESSED_INDEX_CACHE;
-            // finish, having found a element matching filter
-            return 0;
+            found++;
         }
-    }  
+        return found;
+    }
+
+    return requests.getNextBatch(readInto, maxCount, filter);
 }
 
 //========
 
-// retrieve and load a recently accessed request from file
-bool ChangeRequestDatabase::select(change_request& readInto, int index, int menuCount)
+// steps through the date index from the later of the first day and the entry last read, reading only the indexed requests
+int ChangeRequestDatabase::getNextByDate(change_request* readInto, int maxCount, const char* from, const char* to)
 {
     // fail if uninitialised
-    if (!requestData.is_open())
+    if (!requests.isOpen())
     {
-        return 1;
+        return 0;
     }
-    
-    // algebraically find the index of the position of the desired element
-    // using a circular array
-    // using the length of the array: SIZE_OF_INDEX_CACHE
-    // using the number of options in a menu printout: menuCount
-    // and using the selected index in that menu printout: index
-    int desiredIndex = (previouslyAccessedPosition -1 + index - menuCount) % SIZE_OF_ACCESSED_INDEX_CACHE;
 
-    // wrap around for negative indexes
-    if (desiredIndex < 0)
+    // an open range starts after the requests without a date, which hold the least date
+    int32_t fromDays = strcmp(from, "") ? dateToDays(from) : NO_DATE + 1;
+    int32_t toDays = strcmp(to, "") ? dateToDays(to) : INT32_MAX;
+    if ((fromDays == NO_DATE) || (toDays == NO_DATE))
     {
-        desiredIndex = SIZE_OF_ACCESSED_INDEX_CACHE + desiredIndex;
+        return 0;
     }
 
-    // seek to index of desired request
-    requestData.seekg(previouslyAccessed[desiredIndex]);
+    std::vector<std::pair<int32_t, int64_t>>::const_iterator entry = std::upper_bound(dateIndex.begin(), dateIndex.end(), dateCursor);
+    std::vector<std::pair<int32_t, int64_t>>::const_iterator first = std::lower_bound(dateIndex.begin(), dateIndex.end(), std::make_pair(fromDays, int64_t(-1)));
+    if (first > entry)
+    {
+        entry = first;
+    }
 
-    // retrieve desired element
-    // buffer byte block for contentss
-    char buffer[sizeof(change_request)];
-    // read to buffer
-    requestData.read(buffer, sizeof(change_request));
-    // copy bytes of buffer into change_request
-    memcpy(&readInto, buffer, sizeof(change_request));
-    
-    previouslyAccessedPosition = 0;
+    int found = 0;
+    for (; (entry != dateIndex.end()) && (entry->first <= toDays) && (found < maxCount); entry++)
+    {
+        if (requests.read(entry->second, readInto[found]))
+        {
+            break;
+        }
+        requests.remember(entry->second);
+        dateCursor = *entry;
+        found++;
+    }
+    return found;
+}
+
+//========
+
+// packs a request field by field, without padding
+void ChangeRequestTraits::pack(const change_request& element, char* bytes)
+{
+    packInt(bytes, element.changeItemId, 4);
+    packInt(bytes, element.requesterId, 4);
+    packInt(bytes, dateToDays(element.requestDate), 4);
+    packInt(bytes, Dictionary::releaseIds.encode(element.release), 4);
+}
+
+//========
+
+bool ChangeRequestTraits::packable(const change_request& element)
+{
+    return (element.requestDate[0] == '\0') || (dateToDays(element.requestDate) != NO_DATE);
+}
+
+//========
+
+void ChangeRequestTraits::unpack(const char* bytes, change_request& element)
+{
+    element.changeItemId = static_cast<int32_t>(unpackInt(bytes, 4));
+    element.requesterId = static_cast<int32_t>(unpackInt(bytes, 4));
+    daysToDate(static_cast<int32_t>(unpackInt(bytes, 4)), element.requestDate);
+    Dictionary::releaseIds.decode(static_cast<int32_t>(unpackInt(bytes, 4)), element.release);
+}
+
+//========
+
+int ChangeRequestTraits::formatSize(uint32_t version)
+{
+    if (version == 0)
+    {
+        return sizeof(change_request_raw);
+    }
+    if (version == 1)
+    {
+        return 4 + 2 + (DATE_SIZE - 1) + (MAX_RELEASE_ID_SIZE - 1);
+    }
+    if (version == 2)
+    {
+        return 4 + 2 + (DATE_SIZE - 1) + 4;
+    }
+    if (version == 3)
+    {
+        return 4 + 2 + 4 + 4;
+    }
     return 0;
 }
 
 //========
 
-// move file pointer to beginning
-// recover from eof flag
-bool ChangeRequestDatabase::seekToBeginning()
+// the 16 bit requesterId of the earlier versions is widened with its sign, so -1 stays -1
+void ChangeRequestTraits::unpackFormat(uint32_t version, const char* bytes, change_request& element)
 {
-    // fail if uninitialised
-    if (!requestData.is_open())
+    if (version == 0)
     {
-        return 1;
+        change_request_raw raw;
+        memcpy(&raw, bytes, sizeof(raw));
+        element.changeItemId = raw.changeItemId;
+        element.requesterId = raw.requesterId;
+        memcpy(element.requestDate, raw.requestDate, DATE_SIZE);
+        memcpy(element.release, raw.release, MAX_RELEASE_ID_SIZE);
+    }
+    else if (version == 1)
+    {
+        element.changeItemId = static_cast<int32_t>(unpackInt(bytes, 4));
+        element.requesterId = static_cast<int16_t>(unpackInt(bytes, 2));
+        unpackString(bytes, element.requestDate, DATE_SIZE);
+        unpackString(bytes, element.release, MAX_RELEASE_ID_SIZE);
+    }
+    else if (version == 2)
+    {
+        element.changeItemId = static_cast<int32_t>(unpackInt(bytes, 4));
+        element.requesterId = static_cast<int16_t>(unpackInt(bytes, 2));
+        unpackString(bytes, element.requestDate, DATE_SIZE);
+        Dictionary::releaseIds.decode(static_cast<int32_t>(unpackInt(bytes, 4)), element.release);
+    }
+    else if (version == 3)
+    {
+        element.changeItemId = static_cast<int32_t>(unpackInt(bytes, 4));
+        element.requesterId = static_cast<int16_t>(unpackInt(bytes, 2));
+        daysToDate(static_cast<int32_t>(unpackInt(bytes, 4)), element.requestDate);
+        Dictionary::releaseIds.decode(static_cast<int32_t>(unpackInt(bytes, 4)), element.release);
     }
+}
 
-    requestData.clear(); // clear eof error flag
+//========
 
-    // move file pointer to the beginning of database
-    // first element is info element and should be ignored
-    // so move to the beginning offset by one element
-    requestData.seekg(std::ios::beg);
-    return 0;
+void ChangeRequestTraits::encodeFilter(const change_request& filter, int32_t* codes)
+{
+    codes[0] = filter.changeItemId;
+    codes[1] = filter.requesterId;
+    codes[2] = dateToDays(filter.requestDate);
+    codes[3] = -1;
+    if (strcmp(filter.release, ""))
+    {
+        int32_t releaseId = Dictionary::releaseIds.find(filter.release);
+        codes[3] = (releaseId == -1) ? -2 : releaseId;
+    }
+}
+
+//========
+
+// compares the fields in place, a filter date that is not a date of the calendar is left to matches
+bool ChangeRequestTraits::mayMatch(const char* bytes, const int32_t* codes)
+{
+    const char* field = bytes;
+    int32_t changeItemId = static_cast<int32_t>(unpackInt(field, 4));
+    int32_t requesterId = static_cast<int32_t>(unpackInt(field, 4));
+    int32_t days = static_cast<int32_t>(unpackInt(field, 4));
+    int32_t releaseId = static_cast<int32_t>(unpackInt(field, 4));
+    return ((codes[0] == -1) || (changeItemId == codes[0]))
+        && ((codes[1] == -1) || (requesterId == codes[1]))
+        && ((codes[2] == NO_DATE) || (days == codes[2]))
+        && ((codes[3] == -1) || (releaseId == codes[3]));
+}
+
+//========
+
+uint64_t ChangeRequestTraits::mayMatchBlock(const char* bytes, int count, const int32_t* codes)
+{
+    uint64_t candidates = 0;
+    for (int i = 0; i < count; i++)
+    {
+        candidates |= uint64_t(mayMatch(bytes + RECORD_SIZE * i, codes)) << i;
+    }
+    return candidates;
+}
+
+//========
+
+// checks a request against each defined field of a filter
+bool ChangeRequestTraits::matches(const change_request& element, const change_request& filter)
+{
+    bool idMatch = (filter.changeItemId == -1) || (element.changeItemId == filter.changeItemId);
+    bool requesterMatch = (filter.requesterId == -1) || (element.requesterId == filter.requesterId);
+    bool dateMatch = (!strcmp(filter.requestDate, "")) || (!strcmp(element.requestDate, filter.requestDate));
+    bool releaseMatch = (!strcmp(filter.release, "")) || (!strcmp(element.release, filter.release));
+    return idMatch && requesterMatch && dateMatch && releaseMatch;
+}
+
+//========
+
+// retrieve and load a recently accessed request from file
+bool ChangeRequestDatabase::select(change_request& readInto, int index, int menuCount)
+{
+    return requests.select(readInto, index, menuCount);
+}
+
+//========
+
+// move file pointer to beginning
+bool ChangeRequestDatabase::seekToBeginning()
+{
+    dateCursor = std::make_pair(NO_DATE, int64_t(-1));
+    return requests.seekToBeginning();
 }
 
+//========
+
 #endif
\ No newline at end of file
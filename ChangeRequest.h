@@ -2,6 +2,29 @@
 description:
 This is the module for maintenance of the change request objects
 version history:
+ver13 -26/10/17
+        -the index files are StorageFiles, loaded by the backend chosen at init
+ver12 -26/10/17
+        -added ChangeRequestTraits::packable, refusing request dates not on the calendar
+ver11 -26/10/17
+        -requesterId widened to 32 bits, format version 4
+        -formatSize and unpackFormat read raw records and version 3 records
+ver10 -26/10/17
+        -added ChangeRequestTraits::mayMatchBlock, checking a block of packed records for the filtered scans
+ver9 -26/10/17
+        -request dates stored as integer dates, format version 3
+        -added getNextByDate, reading the requests of a range of dates through the request date index
+ver8 -26/10/17
+        -change requests store their release as an id of the shared dictionary, format version 2
+        -added ChangeRequestTraits hooks reading version 1 records and checking filters on packed records
+ver7 -26/10/17
+        -change requests packed by ChangeRequestTraits, for the packed record format of RecordStore
+ver6 -26/10/17
+        -elements stored in a RecordStore, filtering moved to ChangeRequestTraits
+ver5 -26/10/17
+        -added changeItemId postings index used by filtered getNext
+        -file access through StorageFile, backend chosen at init
+        -added getNextBatch
 ver4 -24/07/25, update by Nicolao
         -seperation of change request and change item modules
 ver3 -24/07/13, cleaning up errors by Nicolao
@@ -20,18 +43,147 @@ ver1 -24/07/02, original by Wah Paw Hser and Puja Shah
 //==================
 
 #include <stdint.h>
-#include <fstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "Constants.h"
+#include "RecordStore.h"
+#include "StorageFile.h"
 
 //==================
 
 typedef struct {
     int32_t changeItemId = -1;
-    int16_t requesterId = -1;
+    int32_t requesterId = -1;
     char requestDate[DATE_SIZE]= "";
     char release[MAX_RELEASE_ID_SIZE] = "";
 }change_request;
 
+// packing and filtering of change requests for the RecordStore holding them
+struct ChangeRequestTraits : RecordTraits
+{
+    static constexpr char MAGIC[9] = "\211ITSRQST"; // names change request files in their header
+    static const uint32_t FORMAT_VERSION = 4; // version 2 stores the release as its id in Dictionary::releaseIds, version 3 the date as days, version 4 a 32 bit requesterId
+    static const int RECORD_SIZE = 4 + 4 + 4 + 4; // bytes of a packed change request
+    static const int FILTER_CODES = 4; // changeItemId, requesterId, date and release id of a filter
+
+    static void pack(
+        /* element to pack
+        used as input */
+        const change_request& element,
+        /* RECORD_SIZE bytes the element is packed into
+        used as output, mutates */
+        char* bytes
+    );
+    /* description:
+        packs the fields of the element in the order they are declared, the request date as an integer date
+        and the release as its dictionary id.
+    preconditions:
+        the shared dictionaries are open.
+    */
+
+    static bool packable(
+        /* element to check
+        used as input */
+        const change_request& element
+    );
+    /* returns:
+        true unless the request date is neither empty nor a date of the calendar, which pack would store as the empty date.
+    */
+
+    static void unpack(
+        /* RECORD_SIZE bytes of a packed element
+        used as input */
+        const char* bytes,
+        /* used to store the element unpacked
+        used as output, mutates */
+        change_request& element
+    );
+    /* description:
+        reads back the fields of an element packed by pack.
+    preconditions:
+        the shared dictionaries are open.
+    */
+
+    static int formatSize(
+        /* earlier format version
+        used as input */
+        uint32_t version
+    );
+    /* returns:
+        the size of a record packed in the version, or of a raw record for version 0, 0 if the version is unknown.
+    */
+
+    static void unpackFormat(
+        /* earlier format version
+        used as input */
+        uint32_t version,
+        /* bytes of an element packed in the version
+        used as input */
+        const char* bytes,
+        /* used to store the element unpacked
+        used as output, mutates */
+        change_request& element
+    );
+    /* description:
+        reads back an element packed in an earlier version, version 1 holding the date and release as strings,
+        version 2 the date as a string, versions 1 to 3 a 16 bit requesterId.
+        version 0 reads a raw record, written before the file header with a 16 bit requesterId.
+    */
+
+    static void encodeFilter(
+        /* filter to encode
+        used as input */
+        const change_request& filter,
+        /* used to store FILTER_CODES codes, -1 for a field not filtered on
+        used as output, mutates */
+        int32_t* codes
+    );
+    /* description:
+        gives the integer fields of the filter, the days of its request date, NO_DATE if it is not filtered on,
+        and the dictionary id of its release, -2 if the release is in no record.
+    */
+
+    static bool mayMatch(
+        /* RECORD_SIZE bytes of a packed element
+        used as input */
+        const char* bytes,
+        /* codes given by encodeFilter
+        used as input */
+        const int32_t* codes
+    );
+    /* returns:
+        false if the packed element certainly does not match the filter of the codes.
+    */
+
+    static uint64_t mayMatchBlock(
+        /* count packed elements of RECORD_SIZE bytes each
+        used as input */
+        const char* bytes,
+        /* number of elements in the block, at most 64
+        used as input */
+        int count,
+        /* codes given by encodeFilter
+        used as input */
+        const int32_t* codes
+    );
+    /* returns:
+        a mask with bit n set for element n of the block, unless mayMatch rules the element out.
+    */
+
+    static bool matches(
+        /* element to check
+        used as input */
+        const change_request& element,
+        /* filter to check against
+        used as input */
+        const change_request& filter
+    );
+    /* returns:
+        true if the element matches every defined field of the filter.
+    */
+};
+
 //==================
 
 // class managing file interaction with change request file
@@ -39,7 +191,11 @@ typedef struct {
 class ChangeRequestDatabase
 {
 public:
-    static bool init();
+    static bool init(
+        /* way in which the database file is accessed
+        used as input */
+        StorageBackend backend = DEFAULT_STORAGE_BACKEND
+    );
     /* description:
         this function prepares the database for interaction.
     preconditions:
@@ -104,12 +260,63 @@ public:
     /* description:
         saves the next change request to the change request "readInto".
         will only get change requests matching the paramatres of the change request referenced by "filter".
+        when the filter defines a changeItemId only the requests listed for that item in the
+        changeItemId index are read.
     postconditions:
         position in file will increase.
     returns:
         return 0 on successful read, return 1 on failure.
     */
 
+    static int getNextBatch(
+        /* used to store the change requests read in by getNextBatch
+        used as output, mutates */
+        change_request* readInto,
+        /* maximum number of change requests to store in readInto
+        used as input */
+        int maxCount,
+        /* used to filter, getNextBatch will only get change requests matching the defined paramatres of the passed change request
+        used as input, does not mutate*/
+        const change_request& filter
+    );
+    /* description:
+        saves up to maxCount of the next change requests matching the filter to the array "readInto".
+        the file is read BATCH_READ_SIZE elements at a time.
+    postconditions:
+        position in file will increase.
+        every change request saved can be retrieved again by select.
+    returns:
+        the number of change requests saved, 0 when no more change requests match.
+    */
+
+    static int getNextByDate(
+        /* used to store the change requests read in by getNextByDate
+        used as output, mutates */
+        change_request* readInto,
+        /* maximum number of change requests to store in readInto
+        used as input */
+        int maxCount,
+        /* YYYY-MM-DD date of the first day of the range, the empty string for no first day
+        used as input */
+        const char* from,
+        /* YYYY-MM-DD date of the last day of the range, the empty string for no last day
+        used as input */
+        const char* to
+    );
+    /* description:
+        saves up to maxCount of the next change requests dated from the first to the last day of the range to
+        the array "readInto", in order of date. the requests are found in the date index, so no scan of the
+        file is made. requests without a request date are not read.
+        the first call after seekToBeginning starts at the first day of the range, later calls continue after
+        the last change request saved.
+    postconditions:
+        position in file is unchanged.
+        every change request saved can be retrieved again by select.
+    returns:
+        the number of change requests saved, 0 when no more change requests are in the range or a day given
+        is not a date of the calendar.
+    */
+
     static bool select(
         /* used to store the change reqeust read in by select.
         used as output, mutates */
@@ -137,14 +344,22 @@ public:
     */    
 
 private:
-    // utilities for select
-    static int64_t previouslyAccessed[20]; // records the indexes of the previous elements accessed, circular array
-    static int64_t previouslyAccessedPosition; // position in previously accessed
-
     // utilities for file interaction
     static const char* filename;
-    static std::fstream requestData; // database elements
-    static int64_t changeRequestCount; // this value is determined at initialisation
+    static RecordStore<change_request, ChangeRequestTraits> requests; // database elements, read position and select cache
+
+    // utilities for the changeItemId index
+    static bool loadIndex(StorageBackend backend); // loads the index file, rebuilding it if it does not match the database
+    static const char* indexFilename;
+    static StorageFile indexFile; // index entries, one per request
+    static std::unordered_map<int32_t, std::vector<int64_t>> itemIndex; // changeItemId to ascending element positions of its requests
+
+    // utilities for the request date index
+    static bool loadDateIndex(StorageBackend backend); // loads the date index file, rebuilding it if it does not match the database
+    static const char* dateIndexFilename;
+    static StorageFile dateIndexFile; // date index entries, one per request in file order
+    static std::vector<std::pair<int32_t, int64_t>> dateIndex; // days and element position of each request, sorted
+    static std::pair<int32_t, int64_t> dateCursor; // date index entry last read by getNextByDate
 };
 
 #endif
@@ -0,0 +1,192 @@
+/* CompressedBitmap.cpp
+description:
+Module implementing compressed bitmaps
+
+a chunk becomes bits once its list grows past BITMAP_LIST_LIMIT offsets, and becomes a list again only
+once it shrinks to half of that, so a chunk near the limit is not converted back and forth on every update.
+
+version history:
+ver2 -26/10/17
+    -removed clearAll, test, count, unite and intersect, which nothing used
+ver1 -26/10/17
+*/
+
+#ifndef COMPRESSED_BITMAP_CPP
+#define COMPRESSED_BITMAP_CPP
+
+//==================
+
+#include "CompressedBitmap.h"
+#include <algorithm>
+
+//==================
+
+const int WORDS_PER_CHUNK = BITMAP_CHUNK_SIZE / 64; // words in a chunk stored as bits
+
+//==================
+
+void CompressedBitmap::set(int64_t position)
+{
+    Chunk& chunk = chunks[position / BITMAP_CHUNK_SIZE];
+    uint16_t offset = position % BITMAP_CHUNK_SIZE;
+
+    if (chunk.words.empty())
+    {
+        std::vector<uint16_t>::iterator found = std::lower_bound(chunk.list.begin(), chunk.list.end(), offset);
+        if ((found != chunk.list.end()) && (*found == offset))
+        {
+            return;
+        }
+        chunk.list.insert(found, offset);
+    }
+    else
+    {
+        uint64_t bit = uint64_t(1) << (offset % 64);
+        if (chunk.words[offset / 64] & bit)
+        {
+            return;
+        }
+        chunk.words[offset / 64] |= bit;
+    }
+    chunk.count++;
+    pack(chunk);
+}
+
+//========
+
+void CompressedBitmap::clear(int64_t position)
+{
+    std::map<int64_t, Chunk>::iterator found = chunks.find(position / BITMAP_CHUNK_SIZE);
+    if (found == chunks.end())
+    {
+        return;
+    }
+    Chunk& chunk = found->second;
+    uint16_t offset = position % BITMAP_CHUNK_SIZE;
+
+    if (chunk.words.empty())
+    {
+        std::vector<uint16_t>::iterator listed = std::lower_bound(chunk.list.begin(), chunk.list.end(), offset);
+        if ((listed == chunk.list.end()) || (*listed != offset))
+        {
+            return;
+        }
+        chunk.list.erase(listed);
+    }
+    else
+    {
+        uint64_t bit = uint64_t(1) << (offset % 64);
+        if (!(chunk.words[offset / 64] & bit))
+        {
+            return;
+        }
+        chunk.words[offset / 64] &= ~bit;
+    }
+    chunk.count--;
+
+    // chunks holding no positions are not stored
+    if (chunk.count == 0)
+    {
+        chunks.erase(found);
+        return;
+    }
+    pack(chunk);
+}
+
+//========
+
+// looks in the chunk holding from, then takes the first position of the next chunk stored
+int64_t CompressedBitmap::next(int64_t from) const
+{
+    if (from < 0)
+    {
+        from = 0;
+    }
+
+    std::map<int64_t, Chunk>::const_iterator current = chunks.lower_bound(from / BITMAP_CHUNK_SIZE);
+    if ((current != chunks.end()) && (current->first == from / BITMAP_CHUNK_SIZE))
+    {
+        int offset = next(current->second, from % BITMAP_CHUNK_SIZE);
+        if (offset != -1)
+        {
+            return current->first * BITMAP_CHUNK_SIZE + offset;
+        }
+        current++;
+    }
+
+    if (current == chunks.end())
+    {
+        return -1;
+    }
+    return current->first * BITMAP_CHUNK_SIZE + next(current->second, 0);
+}
+
+//========
+
+void CompressedBitmap::pack(Chunk& chunk)
+{
+    // a growing list becomes bits
+    if (chunk.words.empty() && (chunk.count > BITMAP_LIST_LIMIT))
+    {
+        chunk.words.assign(WORDS_PER_CHUNK, 0);
+        for (size_t i = 0; i < chunk.list.size(); i++)
+        {
+            chunk.words[chunk.list[i] / 64] |= uint64_t(1) << (chunk.list[i] % 64);
+        }
+        std::vector<uint16_t>().swap(chunk.list);
+    }
+    // shrinking bits become a list
+    else if (!chunk.words.empty() && (chunk.count <= BITMAP_LIST_LIMIT / 2))
+    {
+        chunk.list.clear();
+        for (int offset = next(chunk, 0); offset != -1; offset = next(chunk, offset + 1))
+        {
+            chunk.list.push_back(offset);
+        }
+        std::vector<uint64_t>().swap(chunk.words);
+    }
+}
+
+//========
+
+int CompressedBitmap::next(const Chunk& chunk, int from)
+{
+    if (from >= BITMAP_CHUNK_SIZE)
+    {
+        return -1;
+    }
+
+    if (chunk.words.empty())
+    {
+        std::vector<uint16_t>::const_iterator found = std::lower_bound(chunk.list.begin(), chunk.list.end(), from);
+        if (found == chunk.list.end())
+        {
+            return -1;
+        }
+        return *found;
+    }
+
+    // skip the bits below from in its word, then look for the first nonzero word
+    int wordIndex = from / 64;
+    uint64_t word = chunk.words[wordIndex] & (~uint64_t(0) << (from % 64));
+    while (word == 0)
+    {
+        wordIndex++;
+        if (wordIndex == WORDS_PER_CHUNK)
+        {
+            return -1;
+        }
+        word = chunk.words[wordIndex];
+    }
+
+    int bit = 0;
+    while (!((word >> bit) & 1))
+    {
+        bit++;
+    }
+    return wordIndex * 64 + bit;
+}
+
+//========
+
+#endif
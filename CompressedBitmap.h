@@ -0,0 +1,125 @@
+/* CompressedBitmap.h
+description:
+This is the module for compressed bitmaps, sets of element positions used by the database indexes.
+positions are grouped in chunks of BITMAP_CHUNK_SIZE. a chunk holding few positions stores them as a
+sorted list, and a chunk holding many stores one bit per position, so sparse and dense sets both
+stay small. chunks holding no positions are not stored.
+version history:
+ver2 -26/10/17
+    -removed clearAll, test, count, unite and intersect, which nothing used
+ver1 -26/10/17
+*/
+
+#ifndef COMPRESSED_BITMAP_H
+#define COMPRESSED_BITMAP_H
+
+//==================
+
+#include <stdint.h>
+#include <cstddef>
+#include <map>
+#include <vector>
+
+//==================
+
+const int64_t BITMAP_CHUNK_SIZE = 1 << 16; // positions covered by one chunk
+const int BITMAP_LIST_LIMIT = 4096; // most positions a chunk holds as a sorted list
+
+//==================
+
+// class managing one set of element positions
+// provides setting, clearing and iterating positions
+class CompressedBitmap
+{
+    public:
+    void set(
+        /* position to add to the set
+        used as input */
+        int64_t position
+    );
+    /* postconditions:
+        the position is in the set.
+    */
+
+    void clear(
+        /* position to remove from the set
+        used as input */
+        int64_t position
+    );
+    /* postconditions:
+        the position is not in the set.
+    */
+
+    int64_t next(
+        /* first position to look at
+        used as input */
+        int64_t from
+    ) const;
+    /* returns:
+        the smallest position in the set that is not less than from, -1 if there is none.
+    */
+
+    template <typename Visitor>
+    void forEach(
+        /* called with each position in the set, in ascending order
+        used as input */
+        Visitor visit
+    ) const;
+    /* description:
+        visits every position in the set, faster than stepping through them with next.
+    */
+
+    private:
+    // positions of one chunk, as offsets from the start of the chunk
+    struct Chunk
+    {
+        std::vector<uint16_t> list; // sorted offsets, used while words is empty
+        std::vector<uint64_t> words; // one bit per offset, used for chunks holding many positions
+        int count = 0; // number of positions in the chunk
+    };
+
+    static void pack(Chunk& chunk); // stores a chunk as a sorted list or as bits, whichever its count calls for
+    static int next(const Chunk& chunk, int from); // smallest offset in the chunk not less than from, -1 if none
+
+    std::map<int64_t, Chunk> chunks; // chunks holding positions, by chunk number
+};
+
+//==================
+// implementation of forEach, in the header as it is a template
+
+template <typename Visitor>
+void CompressedBitmap::forEach(Visitor visit) const
+{
+    for (std::map<int64_t, Chunk>::const_iterator current = chunks.begin(); current != chunks.end(); current++)
+    {
+        int64_t start = current->first * BITMAP_CHUNK_SIZE;
+        const Chunk& chunk = current->second;
+
+        if (chunk.words.empty())
+        {
+            for (size_t i = 0; i < chunk.list.size(); i++)
+            {
+                visit(start + chunk.list[i]);
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < chunk.words.size(); i++)
+        {
+            // visit the set bits of the word, lowest first
+            uint64_t word = chunk.words[i];
+            int bit = 0;
+            while (word != 0)
+            {
+                if (word & 1)
+                {
+                    visit(start + int64_t(i) * 64 + bit);
+                }
+                word >>= 1;
+                bit++;
+            }
+        }
+    }
+}
+
+#endif
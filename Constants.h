@@ -3,6 +3,8 @@ description:
 This is the module for maintaing constant global variables of the program
 version history:
 
+ver3 -26/10/17
+     -added BATCH_READ_SIZE
 ver2 -24/07/30 update by Nicolao
      -increment many consts by one to account for terminating character
 ver1 -24/07/17, original Puja Shah
@@ -26,5 +28,6 @@ const int PHONE_NUMBER_SIZE = 11;               // length of phone number
 const int MAX_EMAIL_SIZE = 25;                  // max length for email address
 const int MAX_DEPARTMENT_SIZE = 13;             // max length for department name
 const int MAX_PRINTS = 16;
+const int BATCH_READ_SIZE = 64;                 // elements read from file at once by getNextBatch
 
 #endif
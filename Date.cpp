@@ -0,0 +1,130 @@
+/* Date.cpp
+description:
+Module implementing integer dates
+
+days are counted in eras of 400 years, the period of the Gregorian calendar, with years taken to start in
+March so the leap day ends the year.
+
+version history:
+ver2 -26/10/17
+    -daysToDate writes the empty date for the days just before 0000-01-01, which it wrote as dates of a negative year
+ver1 -26/10/17
+*/
+
+#ifndef DATE_CPP
+#define DATE_CPP
+
+//==================
+
+#include "Date.h"
+#include <cctype>
+#include <cstring>
+
+//==================
+
+const int32_t DAYS_PER_ERA = 146097; // days in 400 years
+const int32_t EPOCH_SHIFT = 719468; // days from 0000-03-01 to 1970-01-01
+const int32_t FIRST_DATE = -EPOCH_SHIFT - 60; // days of 0000-01-01, 0000 being a leap year
+const int32_t LAST_DATE = 2932896; // days of 9999-12-31
+
+//==================
+
+// days since 1970-01-01 of a year, month and day, counting from March
+static int32_t daysFromCivil(int32_t year, int32_t month, int32_t day)
+{
+    year -= (month <= 2);
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    int32_t yearOfEra = year - era * 400;
+    int32_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * DAYS_PER_ERA + dayOfEra - EPOCH_SHIFT;
+}
+
+//========
+
+// reads a number of the given count of digits, -1 if a character is not a digit
+static int32_t readDigits(const char* digits, int count)
+{
+    int32_t value = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (!isdigit(static_cast<unsigned char>(digits[i])))
+        {
+            return -1;
+        }
+        value = value * 10 + (digits[i] - '0');
+    }
+    return value;
+}
+
+//========
+
+// writes a number as the given count of digits, padded with zeros
+static void writeDigits(char* digits, int32_t value, int count)
+{
+    for (int i = count - 1; i >= 0; i--)
+    {
+        digits[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+//========
+
+int32_t dateToDays(const char* date)
+{
+    if ((strnlen(date, DATE_SIZE) != DATE_SIZE - 1) || (date[4] != '-') || (date[7] != '-'))
+    {
+        return NO_DATE;
+    }
+
+    int32_t year = readDigits(date, 4);
+    int32_t month = readDigits(date + 5, 2);
+    int32_t day = readDigits(date + 8, 2);
+    if ((year == -1) || (month < 1) || (month > 12) || (day < 1))
+    {
+        return NO_DATE;
+    }
+
+    // the day must be in the month
+    static const int monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leapYear = (year % 4 == 0) && ((year % 100 != 0) || (year % 400 == 0));
+    if (day > monthDays[month - 1] + ((month == 2) && leapYear))
+    {
+        return NO_DATE;
+    }
+    return daysFromCivil(year, month, day);
+}
+
+//========
+
+void daysToDate(int32_t days, char* date)
+{
+    if ((days < FIRST_DATE) || (days > LAST_DATE))
+    {
+        date[0] = '\0';
+        return;
+    }
+
+    // find the era, then the year, month and day within it, counting from March
+    int32_t shifted = days + EPOCH_SHIFT;
+    int32_t era = (shifted >= 0 ? shifted : shifted - DAYS_PER_ERA + 1) / DAYS_PER_ERA;
+    int32_t dayOfEra = shifted - era * DAYS_PER_ERA;
+    int32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int32_t monthIndex = (5 * dayOfYear + 2) / 153;
+    int32_t day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    int32_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    int32_t year = yearOfEra + era * 400 + (month <= 2);
+
+    writeDigits(date, year, 4);
+    date[4] = '-';
+    writeDigits(date + 5, month, 2);
+    date[7] = '-';
+    writeDigits(date + 8, day, 2);
+    date[DATE_SIZE - 1] = '\0';
+}
+
+//========
+
+#endif
@@ -0,0 +1,46 @@
+/* Date.h
+description:
+This is the module for the integer dates stored in the database files.
+a date is entered and shown as a YYYY-MM-DD string, and stored as the number of days since 1970-01-01,
+so dates are compared and ranged over as integers without parsing strings.
+version history:
+ver1 -26/10/17
+*/
+
+#ifndef DATE_H
+#define DATE_H
+
+//==================
+
+#include <stdint.h>
+#include "Constants.h"
+
+//==================
+
+const int32_t NO_DATE = INT32_MIN; // days of the empty date, which is before every date
+
+//==================
+
+int32_t dateToDays(
+    /* date string, of at most DATE_SIZE - 1 characters
+    used as input */
+    const char* date
+);
+/* returns:
+    the days since 1970-01-01 of a YYYY-MM-DD date of the calendar, NO_DATE for the empty string,
+    or for a string that is not such a date.
+*/
+
+void daysToDate(
+    /* days since 1970-01-01, or NO_DATE
+    used as input */
+    int32_t days,
+    /* used to store the date string, a char array of DATE_SIZE characters
+    used as output, mutates */
+    char* date
+);
+/* description:
+    writes the YYYY-MM-DD date of a number of days, the empty string for NO_DATE or a day outside years 0 to 9999.
+*/
+
+#endif
@@ -0,0 +1,168 @@
+/* Dictionary.cpp
+description:
+Module implementing dictionaries
+
+the file holds the strings of ids 1 and up, id 0 being the empty string held by no entry. a new string is
+appended to the file when it is first encoded, so a write ahead log holds its entry before any record
+written with its id. a partial entry left at the end of the file is ignored.
+
+version history:
+ver2 -26/10/17
+    -a new string is only added once its entry is written
+ver1 -26/10/17
+*/
+
+#ifndef DICTIONARY_CPP
+#define DICTIONARY_CPP
+
+//==================
+
+#include "Dictionary.h"
+#include <cstring>
+
+//==================
+
+// define shared dictionaries
+Dictionary Dictionary::productNames;
+Dictionary Dictionary::releaseIds;
+int Dictionary::sharedUsers = 0;
+
+//==================
+
+Dictionary::Dictionary()
+{
+    size = 1;
+}
+
+//========
+
+bool Dictionary::initShared(StorageBackend backend)
+{
+    if (sharedUsers > 0)
+    {
+        sharedUsers++;
+        return 0;
+    }
+
+    if (productNames.open("ProductName.dict", MAX_PRODUCT_NAME_SIZE, backend))
+    {
+        return 1;
+    }
+    if (releaseIds.open("ReleaseId.dict", MAX_RELEASE_ID_SIZE, backend))
+    {
+        productNames.close();
+        return 1;
+    }
+    sharedUsers = 1;
+    return 0;
+}
+
+//========
+
+bool Dictionary::uninitShared()
+{
+    if (sharedUsers == 0)
+    {
+        return 1;
+    }
+
+    sharedUsers--;
+    if (sharedUsers > 0)
+    {
+        return 0;
+    }
+    bool failed = productNames.close();
+    return releaseIds.close() || failed;
+}
+
+//========
+
+bool Dictionary::open(const char* filename, int size, StorageBackend backend)
+{
+    if (file.open(filename, backend))
+    {
+        return 1;
+    }
+    this->size = size;
+
+    values.assign(1, std::string());
+    ids.clear();
+    ids[std::string()] = 0;
+
+    // load every whole entry
+    int64_t entryCount = file.getSize() / (size - 1);
+    std::vector<char> entries((size - 1) * entryCount);
+    if ((entryCount > 0) && file.read(0, entries.data(), entries.size()))
+    {
+        file.close();
+        return 1;
+    }
+    for (int64_t i = 0; i < entryCount; i++)
+    {
+        const char* entry = entries.data() + (size - 1) * i;
+        values.push_back(std::string(entry, strnlen(entry, size - 1)));
+        ids.insert(std::make_pair(values.back(), static_cast<int32_t>(values.size() - 1)));
+    }
+    return 0;
+}
+
+//========
+
+bool Dictionary::close()
+{
+    std::vector<std::string>().swap(values);
+    std::unordered_map<std::string, int32_t>().swap(ids);
+    return file.close();
+}
+
+//========
+
+int32_t Dictionary::encode(const char* value)
+{
+    std::string key(value, strnlen(value, size - 1));
+    std::unordered_map<std::string, int32_t>::const_iterator found = ids.find(key);
+    if (found != ids.end())
+    {
+        return found->second;
+    }
+
+    // append the new string, its id is its entry number from 1
+    int32_t id = static_cast<int32_t>(values.size());
+    std::vector<char> entry(size - 1, 0);
+    memcpy(entry.data(), key.data(), key.size());
+    if (file.write(static_cast<int64_t>(size - 1) * (id - 1), entry.data(), size - 1))
+    {
+        return -1;
+    }
+    values.push_back(key);
+    ids.insert(std::make_pair(key, id));
+    return id;
+}
+
+//========
+
+int32_t Dictionary::find(const char* value) const
+{
+    std::unordered_map<std::string, int32_t>::const_iterator found = ids.find(std::string(value, strnlen(value, size - 1)));
+    if (found == ids.end())
+    {
+        return -1;
+    }
+    return found->second;
+}
+
+//========
+
+void Dictionary::decode(int32_t id, char* value) const
+{
+    if ((id <= 0) || (id >= static_cast<int32_t>(values.size())))
+    {
+        value[0] = '\0';
+        return;
+    }
+    memcpy(value, values[id].c_str(), values[id].size() + 1);
+}
+
+//========
+
+#endif
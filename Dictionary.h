@@ -0,0 +1,127 @@
+/* Dictionary.h
+description:
+This is the module for the dictionaries encoding the strings repeated across database records.
+a dictionary gives each distinct string a small integer id, so a record stores the id in place of the
+string and filters compare ids instead of strings. id 0 is the empty string.
+
+the strings are kept in a file, one entry of the string's width per string, in order of id, so an id never
+changes once given. the change item and change request databases share the dictionaries of product names
+and of releaseIds, opened by the first database initialised and closed by the last uninitialised.
+
+version history:
+ver2 -26/10/17
+    -encode gives -1 when the entry of a new string could not be written
+ver1 -26/10/17
+*/
+
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+//==================
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Constants.h"
+#include "StorageFile.h"
+
+//==================
+
+// class managing the strings of one dictionary and their ids
+// provides encoding strings to ids, adding new strings, and decoding ids back to strings
+class Dictionary
+{
+    public:
+    Dictionary();
+
+    static Dictionary productNames; // product names of change items
+    static Dictionary releaseIds; // releaseIds of change items and change requests
+
+    static bool initShared(
+        /* way in which the dictionary files are accessed
+        used as input */
+        StorageBackend backend = DEFAULT_STORAGE_BACKEND
+    );
+    /* description:
+        opens the shared dictionaries of product names and releaseIds, if not already open.
+        each call must be matched by a call to uninitShared.
+    returns:
+        return 0 on success, return 1 if a dictionary file could not be opened.
+    */
+
+    static bool uninitShared();
+    /* description:
+        closes the shared dictionaries once every initShared has been matched.
+    returns:
+        return 0 on success, return 1 on failure.
+    */
+
+    bool open(
+        /* name of the dictionary file, the file is created if it does not exist
+        used as input */
+        const char* filename,
+        /* size of the char array holding a string of the dictionary, including the terminating character
+        used as input */
+        int size,
+        /* way in which the dictionary file is accessed
+        used as input */
+        StorageBackend backend
+    );
+    /* description:
+        opens the dictionary file and loads its strings.
+    preconditions:
+        the dictionary is not open.
+    returns:
+        return 0 on successful open, return 1 on failure.
+    */
+
+    bool close();
+    /* description:
+        closes the dictionary file and frees its strings.
+    returns:
+        return 0 on successful close, return 1 on failure.
+    */
+
+    int32_t encode(
+        /* string to encode, of at most size - 1 characters
+        used as input */
+        const char* value
+    );
+    /* description:
+        gives the id of a string, adding the string to the dictionary and its file if it is new.
+        a new string whose entry could not be written is not added.
+    returns:
+        the id of the string, -1 if the string is new and could not be added.
+    */
+
+    int32_t find(
+        /* string to look for, of at most size - 1 characters
+        used as input */
+        const char* value
+    ) const;
+    /* returns:
+        the id of the string, -1 if the string is not in the dictionary.
+    */
+
+    void decode(
+        /* id of the string
+        used as input */
+        int32_t id,
+        /* used to store the string, a char array of size characters
+        used as output, mutates */
+        char* value
+    ) const;
+    /* description:
+        copies the string of an id, the empty string for an id the dictionary does not hold.
+    */
+
+    private:
+    StorageFile file; // the dictionary file
+    int size; // size of the char array of a string, an entry of the file is size - 1 bytes
+    std::vector<std::string> values; // string of each id
+    std::unordered_map<std::string, int32_t> ids; // id of each string
+    static int sharedUsers; // number of initShared calls not yet matched by uninitShared
+};
+
+#endif
@@ -0,0 +1,226 @@
+/* KeySet.cpp
+description:
+Module implementing sets of unique keys
+
+each key sets KEY_SET_HASHES bits of the filter, found by double hashing one 64 bit hash of the key.
+the filter file holds the number of keys, the number of bits, then the bits.
+a filter that grows too full is doubled while the hash map is built, otherwise it is rebuilt at the next load.
+
+version history:
+ver1 -26/10/17
+*/
+
+#ifndef KEY_SET_CPP
+#define KEY_SET_CPP
+
+//==================
+
+#include "KeySet.h"
+#include <fstream>
+
+//==================
+
+// header of a filter file, followed by the bits of the filter
+typedef struct
+{
+    int64_t keyCount; // number of keys added to the filter
+    int64_t bitCount; // number of bits in the filter
+}key_set_header;
+
+const int64_t MIN_KEY_SET_BITS = 1 << 12; // size of the filter of an empty database
+
+//==================
+
+KeySet::KeySet()
+{
+    keyCount = 0;
+    exact = 0;
+}
+
+//========
+
+bool KeySet::load(const char* filename, int64_t keyCount)
+{
+    clear();
+
+    std::ifstream filterFile(filename, std::ios::in | std::ios::binary);
+    if (!filterFile.is_open())
+    {
+        return 1;
+    }
+
+    key_set_header header;
+    filterFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (filterFile.fail())
+    {
+        return 1;
+    }
+
+    // the filter must hold every key of the database, be a legal size, and not be fuller than sized for
+    bool legalSize = (header.bitCount >= 64) && ((header.bitCount & (header.bitCount - 1)) == 0);
+    if ((header.keyCount != keyCount) || !legalSize || (header.keyCount * KEY_SET_BITS_PER_KEY > header.bitCount))
+    {
+        return 1;
+    }
+
+    bits.resize(header.bitCount / 64);
+    filterFile.read(reinterpret_cast<char*>(bits.data()), bits.size() * sizeof(uint64_t));
+    if (filterFile.fail())
+    {
+        bits.clear();
+        return 1;
+    }
+
+    this->keyCount = keyCount;
+    return 0;
+}
+
+//========
+
+bool KeySet::save(const char* filename)
+{
+    std::ofstream filterFile(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!filterFile.is_open())
+    {
+        return 1;
+    }
+
+    key_set_header header;
+    header.keyCount = keyCount;
+    header.bitCount = bits.size() * 64;
+    filterFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    filterFile.write(reinterpret_cast<const char*>(bits.data()), bits.size() * sizeof(uint64_t));
+    filterFile.close();
+
+    return filterFile.fail();
+}
+
+//========
+
+// sizes the filter for twice keyCount keys, so keys can be added until the next rebuild
+void KeySet::reset(int64_t keyCount)
+{
+    int64_t bitCount = MIN_KEY_SET_BITS;
+    while (bitCount < 2 * keyCount * KEY_SET_BITS_PER_KEY)
+    {
+        bitCount *= 2;
+    }
+
+    bits.assign(bitCount / 64, 0);
+    this->keyCount = 0;
+    positions.clear();
+    positions.reserve(keyCount);
+    exact = 1;
+}
+
+//========
+
+void KeySet::clear()
+{
+    std::vector<uint64_t>().swap(bits);
+    std::unordered_map<std::string, int64_t>().swap(positions);
+    keyCount = 0;
+    exact = 0;
+}
+
+//========
+
+void KeySet::add(const std::string& key, int64_t position)
+{
+    if (bits.empty())
+    {
+        return;
+    }
+
+    setBits(key);
+    keyCount++;
+
+    if (exact)
+    {
+        positions.insert(std::make_pair(key, position));
+
+        // a filter grown too full is resized from the keys in the hash map
+        if (keyCount * KEY_SET_BITS_PER_KEY > int64_t(bits.size() * 64))
+        {
+            bits.assign(bits.size() * 2, 0);
+            for (std::unordered_map<std::string, int64_t>::const_iterator held = positions.begin(); held != positions.end(); held++)
+            {
+                setBits(held->first);
+            }
+        }
+    }
+}
+
+//========
+
+bool KeySet::mayContain(const std::string& key) const
+{
+    // without a filter nothing can be ruled out
+    if (bits.empty())
+    {
+        return 1;
+    }
+
+    uint64_t keyHash = hash(key);
+    uint64_t step = (keyHash >> 32) | 1;
+    uint64_t mask = bits.size() * 64 - 1;
+    for (int i = 0; i < KEY_SET_HASHES; i++)
+    {
+        uint64_t bit = (keyHash + i * step) & mask;
+        if (!((bits[bit / 64] >> (bit % 64)) & 1))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//========
+
+bool KeySet::isExact() const
+{
+    return exact;
+}
+
+//========
+
+bool KeySet::find(const std::string& key, int64_t& position) const
+{
+    std::unordered_map<std::string, int64_t>::const_iterator found = positions.find(key);
+    if (found == positions.end())
+    {
+        return 1;
+    }
+    position = found->second;
+    return 0;
+}
+
+//========
+
+void KeySet::setBits(const std::string& key)
+{
+    uint64_t keyHash = hash(key);
+    uint64_t step = (keyHash >> 32) | 1;
+    uint64_t mask = bits.size() * 64 - 1;
+    for (int i = 0; i < KEY_SET_HASHES; i++)
+    {
+        uint64_t bit = (keyHash + i * step) & mask;
+        bits[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+//========
+
+uint64_t KeySet::hash(const std::string& key)
+{
+    uint64_t keyHash = 14695981039346656037ull;
+    for (size_t i = 0; i < key.size(); i++)
+    {
+        keyHash = (keyHash ^ static_cast<unsigned char>(key[i])) * 1099511628211ull;
+    }
+    return keyHash;
+}
+
+//========
+
+#endif
@@ -0,0 +1,135 @@
+/* KeySet.h
+description:
+This is the module for the sets of unique keys used by the database modules to check uniqueness.
+a KeySet is a Bloom filter over the keys of a database, backed by a hash map from each key to the
+position of the element holding it.
+
+the Bloom filter is small and stored in a file, so it is loaded at init without reading the database.
+it answers most checks alone, as a key it does not hold is certainly new. the hash map is only built,
+with one scan of the database by its module, the first time the filter may hold a key looked for.
+
+version history:
+ver1 -26/10/17
+*/
+
+#ifndef KEY_SET_H
+#define KEY_SET_H
+
+//==================
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//==================
+
+const int KEY_SET_BITS_PER_KEY = 16; // filter bits per key the filter is sized for, sizing leaves room for the keys to double
+const int KEY_SET_HASHES = 7; // bits set in the filter per key
+
+//==================
+
+// class managing the unique keys of one database
+// provides constant time checks of whether a key is held, and the position of the element holding it
+class KeySet
+{
+    public:
+    KeySet();
+
+    bool load(
+        /* name of the filter file
+        used as input */
+        const char* filename,
+        /* number of keys in the database
+        used as input */
+        int64_t keyCount
+    );
+    /* description:
+        loads the Bloom filter from its file.
+    postconditions:
+        on success the filter holds every key, and the hash map is not built.
+    returns:
+        return 0 on successful load, return 1 if the file is missing, does not hold keyCount keys,
+        or is too full to stay accurate. the KeySet must then be rebuilt through reset and add.
+    */
+
+    bool save(
+        /* name of the filter file
+        used as input */
+        const char* filename
+    );
+    /* description:
+        writes the Bloom filter to its file.
+    returns:
+        return 0 on successful write, return 1 on failure.
+    */
+
+    void reset(
+        /* number of keys about to be added
+        used as input */
+        int64_t keyCount
+    );
+    /* description:
+        empties the KeySet, sizing the filter for keyCount keys.
+    postconditions:
+        the hash map is built, and holds every key added from now on.
+    */
+
+    void clear();
+    /* description:
+        empties the KeySet and frees its memory.
+    */
+
+    void add(
+        /* new key
+        used as input */
+        const std::string& key,
+        /* position of the element holding the key
+        used as input */
+        int64_t position
+    );
+    /* description:
+        adds a key to the filter, and to the hash map if it is built.
+    */
+
+    bool mayContain(
+        /* key to check
+        used as input */
+        const std::string& key
+    ) const;
+    /* returns:
+        false if the key is certainly not held, true if it may be held.
+    */
+
+    bool isExact() const;
+    /* returns:
+        true if the hash map is built.
+    */
+
+    bool find(
+        /* key to find
+        used as input */
+        const std::string& key,
+        /* used to store the position of the element holding the key
+        used as output, mutates */
+        int64_t& position
+    ) const;
+    /* description:
+        looks a key up in the hash map.
+    preconditions:
+        the hash map is built.
+    returns:
+        return 0 if the key is held, return 1 if it is not.
+    */
+
+    private:
+    static uint64_t hash(const std::string& key); // FNV-1a hash of a key, giving the bits of the key in the filter
+    void setBits(const std::string& key); // sets the bits of a key in the filter
+
+    std::vector<uint64_t> bits; // Bloom filter, a power of two bits long
+    int64_t keyCount; // number of keys added to the filter
+    bool exact; // true if positions holds every key
+    std::unordered_map<std::string, int64_t> positions; // key to position of the element holding it
+};
+
+#endif
@@ -0,0 +1,88 @@
+/* Migrate.cpp
+description:
+program converting the database files of earlier versions, which hold raw copies of the record structs or
+records of an earlier packed format, to the current packed format. files already converted are left as they are.
+a log left behind by a crash is replayed first, as its writes are in the layout of the old files.
+run in the directory holding the database files. the databases also convert their file when opened,
+so running the program is only needed to convert the files ahead of time, or to check them.
+usage: Migrate
+version history:
+ver4 -26/10/17
+    -reports the first record that cannot be converted without losing a field
+ver3 -26/10/17
+    -change items converted by ChangeItemDatabase::migrate, moving their descriptions to ChangeDescription.dat
+ver2 -26/10/17
+    -change items and change requests converted with the shared dictionaries open
+ver1 -26/10/17
+*/
+
+#include "ChangeItem.h"
+#include "ChangeRequest.h"
+#include "Dictionary.h"
+#include "Product.h"
+#include "Release.h"
+#include "Requester.h"
+#include "WriteAheadLog.h"
+#include <iostream>
+using std::cout;
+using std::endl;
+
+//==================
+
+// converts one database file and reports the result, and the first record that cannot be converted, return 0 on success
+template <typename T, typename Traits>
+bool migrateFile(const char* filename)
+{
+    bool converted = !RecordStore<T, Traits>::migrate(filename, [filename](int64_t position, const T& element) -> bool
+    {
+        if (!Traits::packable(element))
+        {
+            cout << filename << ": record " << position + 1 << " holds a value the current format cannot store, such as a date not on the calendar" << endl;
+        }
+        return 0;
+    });
+    if (!converted)
+    {
+        cout << filename << ": could not be converted" << endl;
+        return 1;
+    }
+    cout << filename << ": current record format" << endl;
+    return 0;
+}
+
+//==================
+
+int main()
+{
+    // replay a log left behind by a crash into the old files
+    if (WriteAheadLog::init() || WriteAheadLog::uninit())
+    {
+        cout << "Journal.log: could not be replayed" << endl;
+        return 1;
+    }
+
+    bool failed = 0;
+    failed |= migrateFile<product, ProductTraits>("Product.dat");
+    failed |= migrateFile<release, ReleaseTraits>("Release.dat");
+
+    // change items and change requests encode their products and releases by the shared dictionaries
+    if (Dictionary::initShared())
+    {
+        cout << "ProductName.dict, ReleaseId.dict: could not be opened" << endl;
+        return 1;
+    }
+    // change items move their descriptions to the description file as they are converted
+    if (ChangeItemDatabase::migrate())
+    {
+        cout << "Change.dat: could not be converted" << endl;
+        failed = 1;
+    }
+    else
+    {
+        cout << "Change.dat: current record format" << endl;
+    }
+    failed |= migrateFile<change_request, ChangeRequestTraits>("Request.dat");
+    failed |= Dictionary::uninitShared();
+    failed |= migrateFile<requester, RequesterTraits>("Requester.dat");
+    return failed;
+}
@@ -2,6 +2,17 @@
 description:
 This module is for maintenance of products.
 version history:
+ver7 -26/10/17
+    -ProductTraits derives the defaults of the RecordStore hooks from RecordTraits
+ver6 -26/10/17
+    -products packed by ProductTraits, for the packed record format of RecordStore
+ver5 -26/10/17
+    -added findProduct, checking product names through a KeySet
+ver4 -26/10/17
+    -products stored in a RecordStore, filtering moved to ProductTraits
+ver3 -26/10/17
+    -file access through StorageFile, backend chosen at init
+    -added getNextBatch
 ver2 -24/07/14, proposed by Nicolao Baretto, rewrite by Allan Hu
     -full revision of product.h interface
 ver1 -24/07/02, original by Wah Paw Hser and Puja Shah
@@ -13,6 +24,9 @@ ver1 -24/07/02, original by Wah Paw Hser and Puja Shah
 #include <fstream>
 #include <stdint.h>
 #include "Constants.h"
+#include "KeySet.h"
+#include "RecordStore.h"
+#include "StorageFile.h"
 
 //==================
 
@@ -22,6 +36,49 @@ typedef struct
     char name[MAX_PRODUCT_NAME_SIZE] = "";  // name of product       
 }product;
 
+// packing and filtering of products for the RecordStore holding them
+struct ProductTraits : RecordTraits
+{
+    static constexpr char MAGIC[9] = "\211ITSPROD"; // names product files in their header
+    static const int RECORD_SIZE = MAX_PRODUCT_NAME_SIZE - 1; // bytes of a packed product
+
+    static void pack(
+        /* element to pack
+        used as input */
+        const product& element,
+        /* RECORD_SIZE bytes the element is packed into
+        used as output, mutates */
+        char* bytes
+    );
+    /* description:
+        packs the fields of the element in the order they are declared.
+    */
+
+    static void unpack(
+        /* RECORD_SIZE bytes of a packed element
+        used as input */
+        const char* bytes,
+        /* used to store the element unpacked
+        used as output, mutates */
+        product& element
+    );
+    /* description:
+        reads back the fields of an element packed by pack.
+    */
+
+    static bool matches(
+        /* element to check
+        used as input */
+        const product& element,
+        /* filter to check against
+        used as input */
+        const product& filter
+    );
+    /* returns:
+        true if the element matches every defined field of the filter.
+    */
+};
+
 //==================
 
 // class managing file interaction with change product database
@@ -29,7 +86,11 @@ typedef struct
 class Product {
 public:
     
-    static bool initProduct();
+    static bool initProduct(
+        /* way in which the database file is accessed
+        used as input */
+        StorageBackend backend = DEFAULT_STORAGE_BACKEND
+    );
     /* description:
         initializes the Product module
     precondition: 
@@ -120,6 +181,44 @@ public:
         return 0 on successful read, return 1 on failure.
     */
 
+    static int getNextBatch(
+        /* used to store the products read in by getNextBatch
+        used as output, mutates */
+        product* readInto,
+        /* maximum number of products to store in readInto
+        used as input */
+        int maxCount,
+        /* used to filter, getNextBatch will only get products matching the defined paramatres of the passed product
+        used as input, does not mutate*/
+        const product& filter
+    );
+    /* description:
+        saves up to maxCount of the next products matching the filter to the array "readInto".
+        the file is read BATCH_READ_SIZE elements at a time.
+    postconditions:
+        position in file will increase.
+        every product saved can be retrieved again by select.
+    returns:
+        the number of products saved, 0 when no more products match.
+    */
+
+    static bool findProduct(
+        /* used to store the product found by findProduct
+        used as output, mutates */
+        product& readInto,
+        /* name of the product to find
+        used as input */
+        const char* name
+    );
+    /* description:
+        saves the product with the given name to the product referenced by "readInto".
+        uses the product name KeySet, so no scan of the file is made.
+    postconditions:
+        position in file is unchanged.
+    returns:
+        return 0 on successful read, return 1 if no such product exists.
+    */
+
     static bool seekToBeginning();
     /* description:
         postiion in the file goes back to the beginning of the product file.
@@ -132,13 +231,12 @@ public:
     */
 
 private:
-    // utilities for select
-    static int64_t previouslyAccessed[20]; // records the indexes of the previous elements accessed, circular array
-    static int64_t previouslyAccessedPosition; // position in previously accessed
-
     // utilities for file interaction
     static const char* filename; // name of product file
-    static std::fstream productFile; // the file stream for the product file
-    static int64_t fileIndex; // currently viewed element in database file
-    static int64_t productCount; // this value is caculated at initialisation
+    static RecordStore<product, ProductTraits> products; // product elements, file access index and select cache
+
+    // utilities for the product name KeySet
+    static bool rebuildKeys(); // adds the name of every product to an emptied KeySet, return 0 on success
+    static const char* keysFilename; // name of the product name filter file
+    static KeySet names; // product names
 };
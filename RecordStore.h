@@ -0,0 +1,1051 @@
+/* RecordStore.h
+description:
+This is the module for storing fixed size records in a database file.
+a RecordStore is an instance holding its own file, read position and select cache, so several
+stores of the same record type can be open at once, each on its own path.
+the database modules are built on one RecordStore each, and add their own rules and indexes.
+
+the file begins with a header of RECORD_HEADER_SIZE bytes: an 8 byte magic naming the record type, the
+format version, the packed record size and the record count. record n follows at offset
+RECORD_HEADER_SIZE + n * Traits::RECORD_SIZE. records are packed field by field, integers least
+significant byte first and strings at their full width without the terminating character, so the file
+holds no compiler padding and does not depend on the layout of T.
+the Traits type provides the format and filtering of records, through
+    static constexpr char MAGIC[9]; naming the record type in the header
+    static const uint32_t FORMAT_VERSION; the version of the packed format written
+    static const int RECORD_SIZE; the size of a packed record
+    static const int FILTER_CODES; the number of codes encodeFilter gives
+    static void pack(const T& element, char* bytes); writing the RECORD_SIZE bytes of a record
+    static bool packable(const T& element); false if pack would lose the value of a field of the element
+    static void unpack(const char* bytes, T& element); reading a record back
+    static int formatSize(uint32_t version); the record size of an earlier format version, 0 if unknown
+    static void unpackFormat(uint32_t version, const char* bytes, T& element); reading a record of an earlier version
+    static void encodeFilter(const T& filter, int32_t* codes); giving the codes mayMatchBlock checks for a filter
+    static uint64_t mayMatchBlock(const char* bytes, int count, const int32_t* codes); checking the packed fields of a block
+    static bool matches(const T& element, const T& filter);
+RecordTraits gives defaults of the hooks of the Traits type.
+filtered reads check each block of up to BATCH_READ_SIZE packed records with mayMatchBlock, which gives bit n
+set for record n of the block unless it cannot match the filter. only the records it passes are unpacked,
+and matches then checks them fully.
+matches returns true if the element matches every defined field of the filter.
+
+files written before the header was introduced hold raw copies of T, element n at offset n * sizeof(T).
+a record type whose struct has changed since gives the size of its raw records as formatSize(0), and reads
+them with unpackFormat(0, ...), version 0 naming the raw records.
+migrate converts such a file, or a file of an earlier format version, to the current format, and open
+migrates the file it opens. the converted file is written beside the old one and synced before it replaces it,
+and a converted file left alone by a crash during the replacement takes the old file's place. a file holding an
+element that is not packable is left unconverted, as is a record that is not packable left unwritten by write. a record type whose current format no longer holds some fields migrates its file
+before opening it, handing each converted element to a function that moves those fields elsewhere.
+
+filtered reads may be given a skip function, called with the read position before each block is read and
+returning the first position from it that may hold a match, so a database keeping summaries of ranges of its
+records, such as zone maps, passes over the ranges that cannot match without reading them.
+
+version history:
+ver11 -26/10/17
+    -records that are not packable fail write and migrate, in place of losing a field
+ver10 -26/10/17
+    -migrate syncs the converted file before it replaces the old one, and recovers a converted file left alone by a crash
+ver9 -26/10/17
+    -raw records of a struct that has changed since read through formatSize(0) and unpackFormat(0, ...)
+ver8 -26/10/17
+    -added getNext and getNextBatch taking a skip function, passing over ranges of records that cannot match
+ver7 -26/10/17
+    -added migrate handing each converted element to a function, for fields moved out of the file
+ver6 -26/10/17
+    -filtered reads check a block of records at once through mayMatchBlock, in place of mayMatch per record
+ver5 -26/10/17
+    -records read through views of the file, checked and unpacked where the file was read into memory
+    -added getNextViews
+ver4 -26/10/17
+    -added getNextBatch screening the packed bytes of each record, for ranges a filter cannot hold
+ver3 -26/10/17
+    -format version given by the Traits, migrate also converts files of earlier format versions
+    -filtered reads check the packed fields of each record before unpacking it
+ver2 -26/10/17
+    -packed record format behind a versioned file header, records packed and unpacked by the Traits
+    -added migrate, converting files of raw records
+ver1 -26/10/17
+*/
+
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+//==================
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Constants.h"
+#include "StorageFile.h"
+#include "WriteAheadLog.h"
+
+//==================
+
+const int RECORD_MAGIC_SIZE = 8; // bytes of the magic at the start of the header
+const int RECORD_HEADER_SIZE = 24; // magic, version, record size and record count
+static_assert(BATCH_READ_SIZE <= 64, "the candidates of a block of records are one 64 bit mask");
+
+//==================
+// packing of record fields, each moving the cursor past the field
+
+// writes the lowest width bytes of an integer, least significant first
+inline void packInt(char*& bytes, int64_t value, int width)
+{
+    for (int i = 0; i < width; i++)
+    {
+        *bytes++ = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF);
+    }
+}
+
+// reads an integer of width bytes, least significant first, extending its sign
+inline int64_t unpackInt(const char*& bytes, int width)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < width; i++)
+    {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(*bytes++)) << (8 * i);
+    }
+    if ((width < 8) && ((value >> (8 * width - 1)) & 1))
+    {
+        value |= ~uint64_t(0) << (8 * width);
+    }
+    return static_cast<int64_t>(value);
+}
+
+// writes a string of a char[size] field in size - 1 bytes, padded with null characters
+inline void packString(char*& bytes, const char* value, int size)
+{
+    size_t length = strnlen(value, size - 1);
+    memcpy(bytes, value, length);
+    memset(bytes + length, 0, size - 1 - length);
+    bytes += size - 1;
+}
+
+// reads a string packed by packString into a char[size] field, terminating it
+inline void unpackString(const char*& bytes, char* value, int size)
+{
+    memcpy(value, bytes, size - 1);
+    value[size - 1] = '\0';
+    bytes += size - 1;
+}
+
+//==================
+
+// defaults of the Traits hooks, for record types in their first format version and without packed filtering
+// a Traits type derives from it and hides the hooks it provides itself
+struct RecordTraits
+{
+    static const uint32_t FORMAT_VERSION = 1; // first version of a packed format
+    static const int FILTER_CODES = 0; // no codes are given
+
+    // every element is packed whole
+    template <typename T>
+    static bool packable(const T& element)
+    {
+        return 1;
+    }
+
+    // no earlier version is known
+    static int formatSize(uint32_t version)
+    {
+        return 0;
+    }
+
+    template <typename T>
+    static void unpackFormat(uint32_t version, const char* bytes, T& element)
+    {
+    }
+
+    template <typename T>
+    static void encodeFilter(const T& filter, int32_t* codes)
+    {
+    }
+
+    // every record is left to matches
+    static uint64_t mayMatchBlock(const char* bytes, int count, const int32_t* codes)
+    {
+        return (count >= 64) ? ~uint64_t(0) : ((uint64_t(1) << count) - 1);
+    }
+};
+
+//==================
+
+// class managing one file of fixed size records
+// provides reads and writes of records by position, and filtered reads following a read position
+template <typename T, typename Traits>
+class RecordStore
+{
+    public:
+    RecordStore();
+
+    bool open(
+        /* path of the database file, the file is created if it does not exist
+        used as input */
+        const char* path,
+        /* way in which the database file is accessed
+        used as input */
+        StorageBackend backend = DEFAULT_STORAGE_BACKEND
+    );
+    /* description:
+        opens the database file and counts its records.
+    preconditions:
+        the RecordStore is not open.
+    postconditions:
+        the read position is at the first record.
+    returns:
+        return 0 on successful open, return 1 on failure.
+    */
+
+    bool close();
+    /* description:
+        closes the database file.
+    returns:
+        return 0 on successful close, return 1 on failure.
+    */
+
+    bool isOpen();
+    /* returns:
+        true if the database file is open.
+    */
+
+    static bool migrate(
+        /* path of the database file
+        used as input */
+        const char* path
+    );
+    /* description:
+        converts a file of raw records, written before the file header was introduced, or a file of an
+        earlier format version, to the current format.
+        a file already in the current format, and a missing or empty file, are left as they are.
+        a file holding an element that is not packable is left as it is, and the conversion fails.
+    preconditions:
+        the file is not open.
+    returns:
+        return 0 if the file is in the current format, return 1 if it could not be converted.
+    */
+
+    template <typename Converted>
+    static bool migrate(
+        /* path of the database file
+        used as input */
+        const char* path,
+        /* called as converted(position, element) with each element converted, in order of position,
+        returning true to abandon the conversion
+        used as input */
+        Converted converted
+    );
+    /* description:
+        converts the file as migrate does, handing each element converted to converted before it is packed.
+        converted is not called when the file is already in the current format, and is called with an element
+        that is not packable before the conversion fails, so it can report the element.
+    preconditions:
+        the file is not open.
+    returns:
+        return 0 if the file is in the current format, return 1 if it could not be converted.
+    */
+
+    const char* getPath();
+    /* returns:
+        the path of the database file.
+    */
+
+    int64_t getCount();
+    /* returns:
+        the number of records in the database file.
+    */
+
+    bool read(
+        /* position of the record
+        used as input */
+        int64_t position,
+        /* used to store the record read
+        used as output, mutates */
+        T& readInto
+    );
+    /* description:
+        reads the record at a position, without moving the read position or the select cache.
+    returns:
+        return 0 on successful read, return 1 on failure.
+    */
+
+    bool write(
+        /* position of the record, getCount() to append a record
+        used as input */
+        int64_t position,
+        /* record to write
+        used as input */
+        const T& readIn
+    );
+    /* description:
+        overwrites the record at a position, or appends a record.
+    postconditions:
+        the record count increments when appending.
+    returns:
+        return 0 on successful write, return 1 on failure or if the record is not packable.
+    */
+
+    bool getNext(
+        /* used to store the record read
+        used as output, mutates */
+        T& readInto
+    );
+    /* description:
+        reads the record at the read position.
+    postconditions:
+        the read position increments, and the record can be retrieved again by select.
+    returns:
+        return 0 on successful read, return 1 on failure.
+    */
+
+    bool getNext(
+        /* used to store the record read
+        used as output, mutates */
+        T& readInto,
+        /* only records matching the filter are read
+        used as input */
+        const T& filter
+    );
+    /* description:
+        reads the next record matching the filter, from the read position onward.
+    postconditions:
+        the read position moves past the record read, and the record can be retrieved again by select.
+    returns:
+        return 0 on successful read, return 1 if no more records match.
+    */
+
+    template <typename Skip>
+    bool getNext(
+        /* used to store the record read
+        used as output, mutates */
+        T& readInto,
+        /* only records matching the filter are read
+        used as input */
+        const T& filter,
+        /* called with the read position before each block is read, returns the first position from it
+        that may hold a match, count or more when none may
+        used as input */
+        Skip skip
+    );
+    /* description:
+        reads the next record matching the filter as getNext does, not reading the records skip passes over.
+    postconditions:
+        the read position moves past the record read, and the record can be retrieved again by select.
+    returns:
+        return 0 on successful read, return 1 if no more records match.
+    */
+
+    int getNextBatch(
+        /* used to store the records read
+        used as output, mutates */
+        T* readInto,
+        /* maximum number of records to store in readInto
+        used as input */
+        int maxCount,
+        /* only records matching the filter are read
+        used as input */
+        const T& filter
+    );
+    /* description:
+        reads up to maxCount of the next records matching the filter.
+        the file is read BATCH_READ_SIZE records at a time.
+    postconditions:
+        the read position moves past the last record read, and every record read can be retrieved again by select.
+    returns:
+        the number of records read, 0 when no more records match.
+    */
+
+    template <typename Screen>
+    int getNextBatch(
+        /* used to store the records read
+        used as output, mutates */
+        T* readInto,
+        /* maximum number of records to store in readInto
+        used as input */
+        int maxCount,
+        /* only records matching the filter are read
+        used as input */
+        const T& filter,
+        /* called with the RECORD_SIZE bytes of each record, only records it returns true for are read
+        used as input */
+        Screen screen
+    );
+    /* description:
+        reads up to maxCount of the next records matching the filter and passing screen, for conditions
+        a filter cannot hold, such as ranges of a field, checked on the packed field without unpacking.
+    postconditions:
+        the read position moves past the last record read, and every record read can be retrieved again by select.
+    returns:
+        the number of records read, 0 when no more records match.
+    */
+
+    template <typename Screen, typename Skip>
+    int getNextBatch(
+        /* used to store the records read
+        used as output, mutates */
+        T* readInto,
+        /* maximum number of records to store in readInto
+        used as input */
+        int maxCount,
+        /* only records matching the filter are read
+        used as input */
+        const T& filter,
+        /* called with the RECORD_SIZE bytes of each record, only records it returns true for are read
+        used as input */
+        Screen screen,
+        /* called with the read position before each block is read, returns the first position from it
+        that may hold a match, count or more when none may
+        used as input */
+        Skip skip
+    );
+    /* description:
+        reads up to maxCount of the next records matching the filter and passing screen, not reading the
+        records skip passes over.
+    postconditions:
+        the read position moves past the last record read, and every record read can be retrieved again by select.
+    returns:
+        the number of records read, 0 when no more records match.
+    */
+
+    int getNextViews(
+        /* used to store a pointer to the RECORD_SIZE packed bytes of each record viewed
+        used as output, mutates */
+        const char** views,
+        /* maximum number of records to view, at most BATCH_READ_SIZE are viewed at once
+        used as input */
+        int maxCount
+    );
+    /* description:
+        gives read only views of the next records, for scans reading a few fields of every record.
+        the views point where the file was read into memory, so no record is copied or unpacked.
+    postconditions:
+        the read position moves past the last record viewed, and every record viewed can be retrieved again by select.
+        the views stay valid until the next call to a function of the RecordStore.
+    returns:
+        the number of records viewed, 0 at the end of file or on failure.
+    */
+
+    bool select(
+        /* used to store the record read
+        used as output, mutates */
+        T& readInto,
+        /* selected index in the last menu printout
+        used as input */
+        int index,
+        /* number of records in the last menu printout
+        used as input */
+        int menuCount
+    );
+    /* description:
+        reads a record of the last menu printout again, using the cache of the positions read.
+    preconditions:
+        the last menuCount records read were printed in a menu, and 0 < index <= menuCount.
+    returns:
+        return 0 on successful read, return 1 on failure.
+    */
+
+    bool seekToBeginning();
+    /* description:
+        moves the read position to the first record.
+    returns:
+        return 0 on successful seek, return 1 on failure.
+    */
+
+    int64_t getPosition();
+    /* returns:
+        the read position.
+    */
+
+    void setPosition(
+        /* new read position
+        used as input */
+        int64_t position
+    );
+    /* description:
+        moves the read position, used by indexes that find the records to read themselves.
+    */
+
+    void remember(
+        /* position of a record delivered
+        used as input */
+        int64_t position
+    );
+    /* description:
+        adds a position to the select cache, used by indexes delivering records read through read.
+    */
+
+    private:
+    bool writeCount(); // writes the header holding the record count, return 0 on success
+    static void packHeader(char* header, int64_t count); // packs the RECORD_HEADER_SIZE bytes of a header holding count records
+
+    StorageFile file; // the database file
+    std::string path; // path of the database file
+    int64_t count; // number of records in the file
+    int64_t position; // position of the next record to read
+
+    // utilities for select
+    int64_t previouslyAccessed[SIZE_OF_ACCESSED_INDEX_CACHE]; // positions of the records last read, circular array
+    int previouslyAccessedPosition; // position in previouslyAccessed of the next position cached
+};
+
+//==================
+// implementation, in the header as RecordStore is a template
+
+template <typename T, typename Traits>
+RecordStore<T, Traits>::RecordStore()
+{
+    count = 0;
+    position = 0;
+    previouslyAccessedPosition = 0;
+    for (int i = 0; i < SIZE_OF_ACCESSED_INDEX_CACHE; i++)
+    {
+        previouslyAccessed[i] = 0;
+    }
+}
+
+//========
+
+// a new file is given its header, and the header of an existing file must match the record type and format
+// the count is limited to the records in the file, in case the header was written before a crash lost records
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::open(const char* path, StorageBackend backend)
+{
+    // convert a file of raw records, then open database file, file is created if not found
+    if (migrate(path) || file.open(path, backend))
+    {
+        return 1;
+    }
+
+    this->path = path;
+    count = 0;
+    position = 0;
+    previouslyAccessedPosition = 0;
+
+    if (file.getSize() == 0)
+    {
+        if (writeCount())
+        {
+            file.close();
+            return 1;
+        }
+        return 0;
+    }
+
+    char header[RECORD_HEADER_SIZE];
+    if ((file.getSize() < RECORD_HEADER_SIZE) || file.read(0, header, RECORD_HEADER_SIZE))
+    {
+        file.close();
+        return 1;
+    }
+    const char* field = header + RECORD_MAGIC_SIZE;
+    uint32_t version = static_cast<uint32_t>(unpackInt(field, 4));
+    uint32_t recordSize = static_cast<uint32_t>(unpackInt(field, 4));
+    int64_t headerCount = unpackInt(field, 8);
+    if (memcmp(header, Traits::MAGIC, RECORD_MAGIC_SIZE) || (version != Traits::FORMAT_VERSION) || (recordSize != Traits::RECORD_SIZE) || (headerCount < 0))
+    {
+        file.close();
+        return 1;
+    }
+
+    count = (file.getSize() - RECORD_HEADER_SIZE) / Traits::RECORD_SIZE;
+    if (headerCount < count)
+    {
+        count = headerCount;
+    }
+    return 0;
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::migrate(const char* path)
+{
+    return migrate(path, [](int64_t position, const T& element) -> bool { return 0; });
+}
+
+//========
+
+// the packed file is written beside the old one, then replaces it, so a failed conversion leaves the old file
+template <typename T, typename Traits>
+template <typename Converted>
+bool RecordStore<T, Traits>::migrate(const char* path, Converted converted)
+{
+    // a crash part way through replacing the old file may leave only the new one, which is whole as it was synced first
+    std::string newPath = std::string(path) + ".new";
+    if (!std::ifstream(path).is_open() && std::ifstream(newPath.c_str()).is_open() && std::rename(newPath.c_str(), path))
+    {
+        return 1;
+    }
+
+    std::ifstream oldFile(path, std::ios::in | std::ios::binary);
+    if (!oldFile.is_open())
+    {
+        return 0;
+    }
+    oldFile.seekg(0, std::ios::end);
+    int64_t size = oldFile.tellg();
+    oldFile.seekg(0, std::ios::beg);
+
+    // nothing to convert in an empty file
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    // find the layout of the old records, raw copies of T or of its earlier struct, or packed in an earlier format version
+    char header[RECORD_HEADER_SIZE];
+    bool raw = 1;
+    bool rawStruct = (Traits::formatSize(0) != 0); // raw records are of an earlier struct, read by unpackFormat
+    uint32_t version = 0;
+    int64_t oldRecordSize = rawStruct ? Traits::formatSize(0) : sizeof(T);
+    int64_t oldCount = size / oldRecordSize;
+    if ((size >= RECORD_HEADER_SIZE) && oldFile.read(header, RECORD_HEADER_SIZE) && !memcmp(header, Traits::MAGIC, RECORD_MAGIC_SIZE))
+    {
+        const char* field = header + RECORD_MAGIC_SIZE;
+        version = static_cast<uint32_t>(unpackInt(field, 4));
+        unpackInt(field, 4);
+        int64_t headerCount = unpackInt(field, 8);
+        if (version == Traits::FORMAT_VERSION)
+        {
+            return 0;
+        }
+        oldRecordSize = Traits::formatSize(version);
+        if ((oldRecordSize == 0) || (headerCount < 0))
+        {
+            return 1;
+        }
+        raw = 0;
+        oldCount = (size - RECORD_HEADER_SIZE) / oldRecordSize;
+        if (headerCount < oldCount)
+        {
+            oldCount = headerCount;
+        }
+    }
+    // a file of raw records holds a whole number of them
+    else if (size % oldRecordSize != 0)
+    {
+        return 1;
+    }
+    oldFile.clear();
+    oldFile.seekg(raw ? 0 : RECORD_HEADER_SIZE, std::ios::beg);
+
+    std::ofstream newFile(newPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!newFile.is_open())
+    {
+        return 1;
+    }
+
+    packHeader(header, oldCount);
+    newFile.write(header, RECORD_HEADER_SIZE);
+
+    // convert BATCH_READ_SIZE records at a time
+    std::vector<char> oldRecords(oldRecordSize * BATCH_READ_SIZE);
+    std::vector<char> packed(static_cast<size_t>(Traits::RECORD_SIZE) * BATCH_READ_SIZE);
+    T element;
+    int64_t remaining = oldCount;
+    int64_t position = 0;
+    while (remaining > 0)
+    {
+        int64_t blockCount = (remaining > BATCH_READ_SIZE) ? BATCH_READ_SIZE : remaining;
+        if (!oldFile.read(oldRecords.data(), oldRecordSize * blockCount))
+        {
+            newFile.close();
+            std::remove(newPath.c_str());
+            return 1;
+        }
+        for (int64_t i = 0; i < blockCount; i++)
+        {
+            if (raw && !rawStruct)
+            {
+                memcpy(static_cast<void*>(&element), oldRecords.data() + oldRecordSize * i, sizeof(T));
+            }
+            else
+            {
+                Traits::unpackFormat(version, oldRecords.data() + oldRecordSize * i, element);
+            }
+            if (converted(position, element) || !Traits::packable(element))
+            {
+                newFile.close();
+                std::remove(newPath.c_str());
+                return 1;
+            }
+            Traits::pack(element, packed.data() + Traits::RECORD_SIZE * i);
+            position++;
+        }
+        newFile.write(packed.data(), Traits::RECORD_SIZE * blockCount);
+        remaining -= blockCount;
+    }
+    oldFile.close();
+    newFile.close();
+
+    // packing and converted may have written to other files, such as dictionaries, which must be durable before the old file goes
+    if (newFile.fail() || (WriteAheadLog::isInitialized() && WriteAheadLog::commit()))
+    {
+        std::remove(newPath.c_str());
+        return 1;
+    }
+
+    // replace the old file once the new one is on disk
+    return StorageFile::replaceFile(newPath.c_str(), path);
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::close()
+{
+    count = 0;
+    position = 0;
+    return file.close();
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::isOpen()
+{
+    return file.isOpen();
+}
+
+//========
+
+template <typename T, typename Traits>
+const char* RecordStore<T, Traits>::getPath()
+{
+    return path.c_str();
+}
+
+//========
+
+template <typename T, typename Traits>
+int64_t RecordStore<T, Traits>::getCount()
+{
+    return count;
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::read(int64_t position, T& readInto)
+{
+    // fail if the record does not exist
+    if ((position < 0) || (position >= count))
+    {
+        return 1;
+    }
+
+    const char* packed = file.view(RECORD_HEADER_SIZE + Traits::RECORD_SIZE * position, Traits::RECORD_SIZE);
+    if (packed == nullptr)
+    {
+        return 1;
+    }
+    Traits::unpack(packed, readInto);
+    return 0;
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::write(int64_t position, const T& readIn)
+{
+    // fail if the write would leave a gap after the last record, or if the record would lose a field when packed
+    if ((position < 0) || (position > count) || !Traits::packable(readIn))
+    {
+        return 1;
+    }
+
+    char packed[Traits::RECORD_SIZE];
+    Traits::pack(readIn, packed);
+    if (position < count)
+    {
+        return file.write(RECORD_HEADER_SIZE + Traits::RECORD_SIZE * position, packed, Traits::RECORD_SIZE);
+    }
+
+    // count new record, the record and the header are written in the same log group
+    WriteAheadLog::holdCommit();
+    bool failed = file.write(RECORD_HEADER_SIZE + Traits::RECORD_SIZE * position, packed, Traits::RECORD_SIZE);
+    if (!failed)
+    {
+        count++;
+        failed = writeCount();
+    }
+    bool commitFailed = WriteAheadLog::releaseCommit();
+    return failed || commitFailed;
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::getNext(T& readInto)
+{
+    // fail if at end of file
+    if (position >= count)
+    {
+        return 1;
+    }
+
+    if (read(position, readInto))
+    {
+        return 1;
+    }
+    remember(position);
+    position++;
+    return 0;
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::getNext(T& readInto, const T& filter)
+{
+    return getNext(readInto, filter, [](int64_t position) { return position; });
+}
+
+//========
+
+// searches blocks of records linearly until finding a match or reaching end of file
+template <typename T, typename Traits>
+template <typename Skip>
+bool RecordStore<T, Traits>::getNext(T& readInto, const T& filter, Skip skip)
+{
+    int32_t codes[Traits::FILTER_CODES + 1];
+    Traits::encodeFilter(filter, codes);
+
+    while ((position = skip(position)) < count)
+    {
+        int64_t blockCount = count - position;
+        if (blockCount > BATCH_READ_SIZE)
+        {
+            blockCount = BATCH_READ_SIZE;
+        }
+
+        const char* packed = file.view(RECORD_HEADER_SIZE + Traits::RECORD_SIZE * position, Traits::RECORD_SIZE * blockCount);
+        if (packed == nullptr)
+        {
+            return 1;
+        }
+
+        // only records passing the checks on their packed fields are unpacked and matched, the first match ends the read
+        uint64_t candidates = Traits::mayMatchBlock(packed, static_cast<int>(blockCount), codes);
+        for (int64_t blockIndex = 0; (blockIndex < blockCount) && (candidates != 0); blockIndex++)
+        {
+            if (!((candidates >> blockIndex) & 1))
+            {
+                continue;
+            }
+            candidates &= ~(uint64_t(1) << blockIndex);
+            Traits::unpack(packed + Traits::RECORD_SIZE * blockIndex, readInto);
+            if (Traits::matches(readInto, filter))
+            {
+                remember(position + blockIndex);
+                position += blockIndex + 1;
+                return 0;
+            }
+        }
+        position += blockCount;
+    }
+    position = count;
+    return 1;
+}
+
+//========
+
+// reads blocks of BATCH_READ_SIZE records and filters each block in memory
+template <typename T, typename Traits>
+int RecordStore<T, Traits>::getNextBatch(T* readInto, int maxCount, const T& filter)
+{
+    return getNextBatch(readInto, maxCount, filter, [](const char*) { return true; });
+}
+
+//========
+
+template <typename T, typename Traits>
+template <typename Screen>
+int RecordStore<T, Traits>::getNextBatch(T* readInto, int maxCount, const T& filter, Screen screen)
+{
+    return getNextBatch(readInto, maxCount, filter, screen, [](int64_t position) { return position; });
+}
+
+//========
+
+template <typename T, typename Traits>
+template <typename Screen, typename Skip>
+int RecordStore<T, Traits>::getNextBatch(T* readInto, int maxCount, const T& filter, Screen screen, Skip skip)
+{
+    int found = 0;
+    int32_t codes[Traits::FILTER_CODES + 1];
+    Traits::encodeFilter(filter, codes);
+
+    // read blocks until enough matches are found or until end of file is reached
+    while (found < maxCount)
+    {
+        position = skip(position);
+        if (position >= count)
+        {
+            position = count;
+            break;
+        }
+
+        int64_t blockCount = count - position;
+        if (blockCount > BATCH_READ_SIZE)
+        {
+            blockCount = BATCH_READ_SIZE;
+        }
+
+        // view the block where it was read into memory
+        const char* packed = file.view(RECORD_HEADER_SIZE + Traits::RECORD_SIZE * position, Traits::RECORD_SIZE * blockCount);
+        if (packed == nullptr)
+        {
+            return found;
+        }
+
+        // deliver matches, stopping at the record after the last one delivered when full
+        // only records passing the checks on their packed fields are unpacked and matched
+        uint64_t candidates = Traits::mayMatchBlock(packed, static_cast<int>(blockCount), codes);
+        int64_t blockIndex = 0;
+        while ((blockIndex < blockCount) && (found < maxCount))
+        {
+            const char* record = packed + Traits::RECORD_SIZE * blockIndex;
+            if (((candidates >> blockIndex) & 1) && screen(record))
+            {
+                Traits::unpack(record, readInto[found]);
+                if (Traits::matches(readInto[found], filter))
+                {
+                    found++;
+                    remember(position + blockIndex);
+                }
+            }
+            blockIndex++;
+        }
+        position += blockIndex;
+    }
+    return found;
+}
+
+//========
+
+template <typename T, typename Traits>
+int RecordStore<T, Traits>::getNextViews(const char** views, int maxCount)
+{
+    int64_t blockCount = count - position;
+    if (blockCount > maxCount)
+    {
+        blockCount = maxCount;
+    }
+    if (blockCount > BATCH_READ_SIZE)
+    {
+        blockCount = BATCH_READ_SIZE;
+    }
+    if (blockCount <= 0)
+    {
+        return 0;
+    }
+
+    // one view of the block, so the views of its records are valid together
+    const char* packed = file.view(RECORD_HEADER_SIZE + Traits::RECORD_SIZE * position, Traits::RECORD_SIZE * blockCount);
+    if (packed == nullptr)
+    {
+        return 0;
+    }
+    for (int64_t i = 0; i < blockCount; i++)
+    {
+        views[i] = packed + Traits::RECORD_SIZE * i;
+        remember(position + i);
+    }
+    position += blockCount;
+    return static_cast<int>(blockCount);
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::select(T& readInto, int index, int menuCount)
+{
+    // error check the index, return 1 if not legal
+    if ((index <= 0) || (index > menuCount) || (index > SIZE_OF_ACCESSED_INDEX_CACHE))
+    {
+        return 1;
+    }
+
+    // algebraically find the position in the circular array of the desired record
+    // using the number of options in a menu printout: menuCount
+    // and using the selected index in that menu printout: index
+    int desiredIndex = (previouslyAccessedPosition - 1 + index - menuCount) % SIZE_OF_ACCESSED_INDEX_CACHE;
+
+    // wrap around for negative indexes
+    if (desiredIndex < 0)
+    {
+        desiredIndex = SIZE_OF_ACCESSED_INDEX_CACHE + desiredIndex;
+    }
+
+    return read(previouslyAccessed[desiredIndex], readInto);
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::seekToBeginning()
+{
+    // fail if not open
+    if (!file.isOpen())
+    {
+        return 1;
+    }
+    position = 0;
+    return 0;
+}
+
+//========
+
+template <typename T, typename Traits>
+int64_t RecordStore<T, Traits>::getPosition()
+{
+    return position;
+}
+
+//========
+
+template <typename T, typename Traits>
+void RecordStore<T, Traits>::setPosition(int64_t position)
+{
+    this->position = position;
+}
+
+//========
+
+template <typename T, typename Traits>
+bool RecordStore<T, Traits>::writeCount()
+{
+    char header[RECORD_HEADER_SIZE];
+    packHeader(header, count);
+    return file.write(0, header, RECORD_HEADER_SIZE);
+}
+
+//========
+
+template <typename T, typename Traits>
+void RecordStore<T, Traits>::packHeader(char* header, int64_t count)
+{
+    memcpy(header, Traits::MAGIC, RECORD_MAGIC_SIZE);
+    header += RECORD_MAGIC_SIZE;
+    packInt(header, Traits::FORMAT_VERSION, 4);
+    packInt(header, Traits::RECORD_SIZE, 4);
+    packInt(header, count, 8);
+}
+
+//========
+
+template <typename T, typename Traits>
+void RecordStore<T, Traits>::remember(int64_t position)
+{
+    previouslyAccessed[previouslyAccessedPosition] = position;
+    previouslyAccessedPosition = (previouslyAccessedPosition + 1) % SIZE_OF_ACCESSED_INDEX_CACHE;
+}
+
+//========
+
+#endif
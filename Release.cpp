@@ -2,6 +2,22 @@
 description:
 This is the implementation of the Release module
 version history:
+ver8 -26/10/17
+     -release dates not on the calendar are refused by write and migrate instead of stored as the empty date
+ver7 -26/10/17
+     -release dates packed as days since 1970-01-01, version 1 files converted when opened
+     -added getNextReleasedBefore, comparing the packed dates of the releases
+ver6 -26/10/17
+     -added ReleaseTraits pack and unpack, the database file is in the packed record format
+ver5 -26/10/17
+     -product name and releaseId pairs kept in a KeySet, its filter saved in ReleaseKey.bloom at uninit
+     -added findRelease
+ver4 -26/10/17
+     -releases stored in a RecordStore, which holds the file access index and select cache
+ver3 -26/10/17
+     -file access through StorageFile, so the file may be memory mapped
+     -select wraps negative cache positions
+     -added getNextBatch, reading BATCH_READ_SIZE releases per file access
 ver2 -24/07/28, select function and filtered getnext fix by Nicolao Barreto
 ver1 -24/07/14, original by Allan Hu
 */
@@ -13,52 +29,49 @@ ver1 -24/07/14, original by Allan Hu
 #include <cstring>
 #include "Release.h"
 #include "Constants.h"
+#include "Date.h"
 
 //==================
 
 //release utility variables
-int64_t Release::previouslyAccessed[20] = {0};  // records the indexes of the previous elements accessed, curcular array
-int64_t Release::previouslyAccessedPosition = 0;  // position in previously accessed
-
 const char* Release::filename = "Release.dat";
-std::fstream Release::releaseFile;  // release elements
-int64_t Release::fileIndex = 0;   // currently viewed element in release file
-int64_t Release::releaseCount = 0;  // amount of releases
+RecordStore<release, ReleaseTraits> Release::releases; // release elements, file access index and select cache
+
+//product release utility variables
+const char* Release::keysFilename = "ReleaseKey.bloom";
+KeySet Release::productReleases; // product name and releaseId of each release
 
 //==================
 
-bool Release::initRelease()
+// key of a release in the product release KeySet, the product name and the releaseId separated by a null character
+std::string releaseKey(const char* productName, const char* releaseId)
 {
-    // open release file 
-    releaseFile.open(filename, std::ios::in | std::ios::out | std::ios::binary);
+    std::string key(productName, strnlen(productName, MAX_PRODUCT_NAME_SIZE));
+    key += '\0';
+    key.append(releaseId, strnlen(releaseId, MAX_RELEASE_ID_SIZE));
+    return key;
+}
+
+//==================
 
-    // if file not found create file
-    if (!releaseFile.is_open()) 
+//creates release file if needed
+//opens release file to allow reads and writes
+bool Release::initRelease(StorageBackend backend)
+{
+    // open release file, file is created if not found
+    // if file cannot be opened fail to initialise
+    // the store counts the releases and resets the file access index and select cache
+    if (releases.open(filename, backend))
     {
-        releaseFile.clear();
-        std::ofstream createFile(filename, std::ios::out | std::ios::binary);
-        createFile.close();
-        releaseFile.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        return 1;
     }
 
-    // if file still cannot be opened fail to initialise
-    if (!releaseFile.is_open()) 
+    // load the product release filter, rebuilding the keys if it does not match the file
+    if (productReleases.load(keysFilename, releases.getCount()) && rebuildKeys())
     {
+        releases.close();
         return 1;
     }
-
-    // initialize releaseCount
-    releaseFile.seekg(0, std::ios::end);
-    releaseCount = releaseFile.tellg()/sizeof(release);
-    releaseFile.seekg(0, std::ios::beg);
-
-    // initialize fileIndex to 0
-    fileIndex = 0; 
-    //initialize previouslyAccessedPosition to 0
-    previouslyAccessedPosition = 0; 
-    // initialize previouslyAccessed to 0
-    memset(previouslyAccessed, 0, sizeof(previouslyAccessed));  
-
     return 0;
 }
 
@@ -66,11 +79,13 @@ bool Release::initRelease()
 
 bool Release::uninitRelease()
 {
-    //check that the release file is open and close it if so
-    if (releaseFile.is_open()) 
+    // check the release file is open and if so close it 
+    if (releases.isOpen())
     {
-        releaseFile.close();
-        return 0;
+        // save the product release filter, so the next init does not scan the file
+        productReleases.save(keysFilename);
+        productReleases.clear();
+        return releases.close();
     }
     else
     {
@@ -82,19 +97,16 @@ bool Release::uninitRelease()
 
 bool Release::writeRelease( release& readIn)
 {
-    // go to end of file
-    releaseFile.seekp(0, std::ios::end); 
-    // add new release to the end of the file
-    releaseFile.write(reinterpret_cast<char*>(&readIn), sizeof(release)); 
-
+    // add new release to end of file
     //return 1 if unable to write to release file
-    if(releaseFile.fail())
+    int64_t position = releases.getCount();
+    if (releases.write(position, readIn))
     {
         return 1;
     }
 
-    // increment releaseCount if added successfully
-    releaseCount++; 
+    // add the key of the new release
+    productReleases.add(releaseKey(readIn.name, readIn.releaseId), position);
     return 0;
 }
 
@@ -102,87 +114,142 @@ bool Release::writeRelease( release& readIn)
 
 bool Release::getNext(release& readInto)
 {
-    // return 1 if the requester file is not open, or there are no more requesters to read into
-    if (!releaseFile.is_open() || fileIndex >= releaseCount) 
-    {
-        return 1;
-    }
-        // read next release from file
-        releaseFile.seekg(fileIndex * sizeof(release), std::ios::beg);
-        releaseFile.read(reinterpret_cast<char*>(&readInto), sizeof(release));
-
-        // return 1 if data cannot be read
-        if (releaseFile.fail()) 
-        {
-            return 1;
-        }
-        // update file access indexes
-        previouslyAccessed[previouslyAccessedPosition] = fileIndex;
-        previouslyAccessedPosition = (previouslyAccessedPosition + 1) % 20;
-        fileIndex++;
-        return 0;
+    // return 1 if there are no more releases to read
+    return releases.getNext(readInto);
 }
 
 //==================
 
 bool Release::getNext(release& readInto, release& filter )
 {
-    while (fileIndex < releaseCount) 
+    // return 1 if there are no more releases matching the filter
+    return releases.getNext(readInto, filter);
+}
+
+//==================
+
+int Release::getNextBatch(release* readInto, int maxCount, const release& filter)
+{
+    // read blocks of releases until enough matches are found or the file ends
+    return releases.getNextBatch(readInto, maxCount, filter);
+}
+
+//==================
+
+int Release::getNextReleasedBefore(release* readInto, int maxCount, const char* date, const release& filter)
+{
+    int32_t before = dateToDays(date);
+    if (before == NO_DATE)
     {
-        // read next release from file
-        releaseFile.seekg(fileIndex * sizeof(release), std::ios::beg);
-        releaseFile.read(reinterpret_cast<char*>(&readInto), sizeof(release));
+        return 0;
+    }
 
-        // return 1 if data cannot be read
-        if (releaseFile.fail()) 
-        {
-           return 1;
-        }
+    // releases without a date hold NO_DATE, the least date, so the range starts after it
+    return releases.getNextBatch(readInto, maxCount, filter, [before](const char* bytes)
+    {
+        const char* field = bytes + ReleaseTraits::DATE_OFFSET;
+        int32_t days = static_cast<int32_t>(unpackInt(field, 4));
+        return (days != NO_DATE) && (days < before);
+    });
+}
 
-        // check if the current release record matches the filter
-        if (((strlen(filter.name) == 0 || (strcmp(readInto.name, filter.name) == 0))) &&
-           ((strlen(filter.date) == 0 || (strcmp(readInto.date, filter.date) == 0))) &&
-           ((strlen(filter.releaseId) == 0) || !strncmp(filter.releaseId, readInto.releaseId, MAX_RELEASE_ID_SIZE)))
-        {
-           
-           // update file access indexes
-           previouslyAccessed[previouslyAccessedPosition] = fileIndex;
-           previouslyAccessedPosition = (previouslyAccessedPosition + 1) % 20;
-           fileIndex++;
-           return 0;
-        }
+// pack a release field by field, strings without the terminating character
+void ReleaseTraits::pack(const release& element, char* bytes)
+{
+    packString(bytes, element.name, MAX_PRODUCT_NAME_SIZE);
+    packInt(bytes, dateToDays(element.date), 4);
+    packString(bytes, element.releaseId, ID_DIGITS);
+}
 
-        // if no match, increment index and continue while loop
-        fileIndex++;
+bool ReleaseTraits::packable(const release& element)
+{
+    return (element.date[0] == '\0') || (dateToDays(element.date) != NO_DATE);
+}
+
+void ReleaseTraits::unpack(const char* bytes, release& element)
+{
+    unpackString(bytes, element.name, MAX_PRODUCT_NAME_SIZE);
+    daysToDate(static_cast<int32_t>(unpackInt(bytes, 4)), element.date);
+    unpackString(bytes, element.releaseId, ID_DIGITS);
+}
+
+int ReleaseTraits::formatSize(uint32_t version)
+{
+    if (version == 1)
+    {
+        return (MAX_PRODUCT_NAME_SIZE - 1) + (RELEASE_DATE_SIZE - 1) + (ID_DIGITS - 1);
+    }
+    return 0;
+}
+
+void ReleaseTraits::unpackFormat(uint32_t version, const char* bytes, release& element)
+{
+    if (version == 1)
+    {
+        unpackString(bytes, element.name, MAX_PRODUCT_NAME_SIZE);
+        unpackString(bytes, element.date, RELEASE_DATE_SIZE);
+        unpackString(bytes, element.releaseId, ID_DIGITS);
     }
-    return 1;
+}
+
+// check if a release matches the filter
+bool ReleaseTraits::matches(const release& element, const release& filter)
+{
+    return ((strlen(filter.name) == 0 || (strcmp(element.name, filter.name) == 0))) &&
+           ((strlen(filter.date) == 0 || (strcmp(element.date, filter.date) == 0))) &&
+           ((strlen(filter.releaseId) == 0) || !strncmp(filter.releaseId, element.releaseId, MAX_RELEASE_ID_SIZE));
 }
 
 //==================
 
-bool Release::select(release& readInto,int index, int menuCount)
+bool Release::select(release& readInto, int index, int menuCount)
 {
-    // error check the index, return 1 if not legal
-    if (index <= 0 || index > menuCount || index > 20) 
+    // return 1 if the index is not legal or the release cannot be read
+    return releases.select(readInto, index, menuCount);
+}
+
+//==================
+
+bool Release::findRelease(release& readInto, const char* productName, const char* releaseId)
+{
+    // return 1 if release file is not open
+    if (!releases.isOpen())
     {
         return 1;
     }
 
-    // return 1 if release file not open
-    if (releaseFile.fail()) 
+    // a key the filter does not hold is certainly new
+    std::string key = releaseKey(productName, releaseId);
+    if (!productReleases.mayContain(key))
     {
-        std::cout << "fails here";
         return 1;
     }
 
-    // find the index of the selected in the circular array
-    int64_t position = (previouslyAccessedPosition -1 + index - menuCount) % SIZE_OF_ACCESSED_INDEX_CACHE;
+    // otherwise look the key up, building the hash map on the first lookup
+    int64_t position;
+    if ((!productReleases.isExact() && rebuildKeys()) || productReleases.find(key, position))
+    {
+        return 1;
+    }
+    return releases.read(position, readInto);
+}
 
-    // seek and read the release
-    releaseFile.seekg(previouslyAccessed[position] * sizeof(release), std::ios::beg);
-    releaseFile.read(reinterpret_cast<char*>(&readInto), sizeof(release));
+//==================
 
-    previouslyAccessedPosition = 0;
+bool Release::rebuildKeys()
+{
+    release element;
+    productReleases.reset(releases.getCount());
+    for (int64_t i = 0; i < releases.getCount(); i++)
+    {
+        // return 1 if a release cannot be read
+        if (releases.read(i, element))
+        {
+            productReleases.clear();
+            return 1;
+        }
+        productReleases.add(releaseKey(element.name, element.releaseId), i);
+    }
     return 0;
 }
 
@@ -190,16 +257,7 @@ bool Release::select(release& readInto,int index, int menuCount)
 
 bool Release::seekToBeginning()
 {
+    // go to the beginning of the release file
     //return 1 if release file is not open
-    if (!releaseFile.is_open())
-    {
-        return 1;
-    }
-
-    // go to the beggining of the release file
-    releaseFile.clear();
-    releaseFile.seekg(0, std::ios::beg); 
-    // update fileIndex to 0
-    fileIndex = 0; 
-    return 0;
-}
\ No newline at end of file
+    return releases.seekToBeginning();
+}
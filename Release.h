@@ -2,6 +2,22 @@
 description:
 This module is for maintenance of product releases.
 version history:
+ver9 -26/10/17
+    -added ReleaseTraits::packable, refusing release dates not on the calendar
+ver8 -26/10/17
+    -release dates stored as integer dates, format version 2
+    -added getNextReleasedBefore
+ver7 -26/10/17
+    -ReleaseTraits derives the defaults of the RecordStore hooks from RecordTraits
+ver6 -26/10/17
+    -releases packed by ReleaseTraits, for the packed record format of RecordStore
+ver5 -26/10/17
+    -added findRelease, checking product releases through a KeySet
+ver4 -26/10/17
+    -releases stored in a RecordStore, filtering moved to ReleaseTraits
+ver3 -26/10/17
+    -file access through StorageFile, backend chosen at init
+    -added getNextBatch
 ver2 -24/07/14, proposed by Nicolao Baretto, rewrite by Allan Hu
     -full revision of product.h interface
 ver1 -24/07/02, original by Wah Paw Hser and Puja Shah
@@ -13,6 +29,9 @@ ver1 -24/07/02, original by Wah Paw Hser and Puja Shah
 #include <fstream>
 #include <stdint.h>
 #include "Constants.h"
+#include "KeySet.h"
+#include "RecordStore.h"
+#include "StorageFile.h"
 
 //struct for a release
 typedef struct 
@@ -22,12 +41,94 @@ typedef struct
     char releaseId[ID_DIGITS] = "";         // release id
 }release;
 
+// packing and filtering of releases for the RecordStore holding them
+struct ReleaseTraits : RecordTraits
+{
+    static constexpr char MAGIC[9] = "\211ITSRELS"; // names release files in their header
+    static const uint32_t FORMAT_VERSION = 2; // version 2 stores the date as days since 1970-01-01
+    static const int RECORD_SIZE = (MAX_PRODUCT_NAME_SIZE - 1) + 4 + (ID_DIGITS - 1); // bytes of a packed release
+    static const int DATE_OFFSET = MAX_PRODUCT_NAME_SIZE - 1; // offset of the date in a packed release
+
+    static void pack(
+        /* element to pack
+        used as input */
+        const release& element,
+        /* RECORD_SIZE bytes the element is packed into
+        used as output, mutates */
+        char* bytes
+    );
+    /* description:
+        packs the fields of the element in the order they are declared, the date as an integer date.
+    */
+
+    static bool packable(
+        /* element to check
+        used as input */
+        const release& element
+    );
+    /* returns:
+        true unless the date is neither empty nor a date of the calendar, which pack would store as the empty date.
+    */
+
+    static void unpack(
+        /* RECORD_SIZE bytes of a packed element
+        used as input */
+        const char* bytes,
+        /* used to store the element unpacked
+        used as output, mutates */
+        release& element
+    );
+    /* description:
+        reads back the fields of an element packed by pack.
+    */
+
+    static int formatSize(
+        /* earlier format version
+        used as input */
+        uint32_t version
+    );
+    /* returns:
+        the size of a record packed in the version, 0 if the version is unknown.
+    */
+
+    static void unpackFormat(
+        /* earlier format version
+        used as input */
+        uint32_t version,
+        /* bytes of an element packed in the version
+        used as input */
+        const char* bytes,
+        /* used to store the element unpacked
+        used as output, mutates */
+        release& element
+    );
+    /* description:
+        reads back an element packed in an earlier version, version 1 holding the date as a string.
+    */
+
+    static bool matches(
+        /* element to check
+        used as input */
+        const release& element,
+        /* filter to check against
+        used as input */
+        const release& filter
+    );
+    /* returns:
+        true if the element matches every defined field of the filter.
+    */
+};
+
 // class managing file interaction with release database
 // provides high level read and write with release objects
 class Release {
 public:
 
-    static bool initRelease();
+    static bool initRelease(
+        /* way in which the database file is accessed
+        used as input */
+        StorageBackend backend = DEFAULT_STORAGE_BACKEND
+    );
     /* description:
         initializes the release module
     precondition: 
@@ -96,6 +197,51 @@ public:
         return 0 on successful read, return 1 on failure.
     */
 
+    static int getNextBatch(
+        /* used to store the releases read in by getNextBatch
+        used as output, mutates */
+        release* readInto,
+        /* maximum number of releases to store in readInto
+        used as input */
+        int maxCount,
+        /* used to filter, getNextBatch will only get releases matching the defined paramatres of the passed release
+        used as input, does not mutate*/
+        const release& filter
+    );
+    /* description:
+        saves up to maxCount of the next releases matching the filter to the array "readInto".
+        the file is read BATCH_READ_SIZE elements at a time.
+    postconditions:
+        position in file will increase.
+        every release saved can be retrieved again by select.
+    returns:
+        the number of releases saved, 0 when no more releases match.
+    */
+
+    static int getNextReleasedBefore(
+        /* used to store the releases read in by getNextReleasedBefore
+        used as output, mutates */
+        release* readInto,
+        /* maximum number of releases to store in readInto
+        used as input */
+        int maxCount,
+        /* YYYY-MM-DD date the releases are dated before
+        used as input */
+        const char* date,
+        /* used to filter, only releases matching the defined paramatres of the passed release are read
+        used as input, does not mutate*/
+        const release& filter
+    );
+    /* description:
+        saves up to maxCount of the next releases dated before date and matching the filter to the array "readInto".
+        the dates are compared as integers in the packed releases, and releases without a date are not read.
+    postconditions:
+        position in file will increase.
+        every release saved can be retrieved again by select.
+    returns:
+        the number of releases saved, 0 when no more releases match or the date is not a date of the calendar.
+    */
+
     static bool select(
         /* used to store the release read in by select
         used as output, mutates */
@@ -118,6 +264,26 @@ public:
         return 0 on successful select, return 1 on failure.
     */    
 
+    static bool findRelease(
+        /* used to store the release found by findRelease
+        used as output, mutates */
+        release& readInto,
+        /* name of the product of the release
+        used as input */
+        const char* productName,
+        /* releaseId of the release
+        used as input */
+        const char* releaseId
+    );
+    /* description:
+        saves the release of the product with the given releaseId to the release referenced by "readInto".
+        uses the product release KeySet, so no scan of the file is made.
+    postconditions:
+        position in file is unchanged.
+    returns:
+        return 0 on successful read, return 1 if no such release exists.
+    */
+
     static bool seekToBeginning();
     /* description:
         postion in the file goes back to the beginning of the release file.
@@ -130,12 +296,13 @@ public:
     */
     
 private:
-    static int64_t previouslyAccessed[20]; // records the indexes of the previous elements accessed, circular array
-    static int64_t previouslyAccessedPosition; // position in previously accessed
-
-    static std::fstream releaseFile; // the file stream for the release file
+    // utilities for file interaction
     static const char* filename; // name of release file
-    static int64_t fileIndex; // currently viewed element in database file
-    static int64_t releaseCount; // this value is caculated at initialisation
+    static RecordStore<release, ReleaseTraits> releases; // release elements, file access index and select cache
+
+    // utilities for the product release KeySet
+    static bool rebuildKeys(); // adds the key of every release to an emptied KeySet, return 0 on success
+    static const char* keysFilename; // name of the product release filter file
+    static KeySet productReleases; // product name and releaseId of each release
 };
 
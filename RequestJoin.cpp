@@ -0,0 +1,118 @@
+/* RequestJoin.cpp
+description:
+Module implementing the join of change requests to their requesters.
+
+the requesters are the built side, as every request refers to one of them. the change requests are read
+BATCH_READ_SIZE at a time and probed against the table, and requests left over when a page fills are kept
+for the next page. the changeItemId and requesterId of each row given are remembered, so a requester who
+made several requests for the same change item is listed once.
+
+version history:
+ver1 -26/10/17
+*/
+
+#ifndef REQUEST_JOIN_CPP
+#define REQUEST_JOIN_CPP
+
+//==================
+
+#include "RequestJoin.h"
+
+//==================
+
+// define static join state
+std::unordered_map<int32_t, requester> RequestJoin::requesters;
+std::unordered_set<int64_t> RequestJoin::joined;
+change_request RequestJoin::filter;
+change_request RequestJoin::pending[BATCH_READ_SIZE];
+int RequestJoin::pendingCount = 0;
+int RequestJoin::pendingNext = 0;
+
+//==================
+
+bool RequestJoin::begin(const change_request& filter)
+{
+    end();
+    RequestJoin::filter = filter;
+
+    // build the hash table with one scan of the requester file
+    requester block[BATCH_READ_SIZE];
+    requester everything; // filter matching every requester
+    int64_t loaded = 0;
+    int entries;
+    RequesterDatabase::seekToBeginning();
+    requesters.reserve(RequesterDatabase::getRequesterCount());
+    while ((entries = RequesterDatabase::getNextBatch(block, BATCH_READ_SIZE, everything)) > 0)
+    {
+        for (int i = 0; i < entries; i++)
+        {
+            requesters[block[i].requesterId] = block[i];
+        }
+        loaded += entries;
+    }
+    RequesterDatabase::seekToBeginning();
+
+    // fail if a requester could not be read
+    if (loaded != RequesterDatabase::getRequesterCount())
+    {
+        end();
+        return 1;
+    }
+
+    ChangeRequestDatabase::seekToBeginning();
+    return 0;
+}
+
+//========
+
+int RequestJoin::getNextBatch(request_join_row* readInto, int maxCount)
+{
+    int found = 0;
+    while (found < maxCount)
+    {
+        // read the next block of change requests once the last is joined
+        if (pendingNext == pendingCount)
+        {
+            pendingCount = ChangeRequestDatabase::getNextBatch(pending, BATCH_READ_SIZE, filter);
+            pendingNext = 0;
+            if (pendingCount == 0)
+            {
+                break;
+            }
+        }
+
+        const change_request& request = pending[pendingNext];
+        pendingNext++;
+
+        // probe the hash table, skipping missing and already given requesters
+        std::unordered_map<int32_t, requester>::const_iterator match = requesters.find(request.requesterId);
+        if (match == requesters.end())
+        {
+            continue;
+        }
+        int64_t pair = (int64_t(request.changeItemId) << 32) | uint32_t(request.requesterId);
+        if (!joined.insert(pair).second)
+        {
+            continue;
+        }
+
+        readInto[found].request = request;
+        readInto[found].requestedBy = match->second;
+        found++;
+    }
+    return found;
+}
+
+//========
+
+void RequestJoin::end()
+{
+    std::unordered_map<int32_t, requester>().swap(requesters);
+    std::unordered_set<int64_t>().swap(joined);
+    pendingCount = 0;
+    pendingNext = 0;
+}
+
+//========
+
+#endif
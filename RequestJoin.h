@@ -0,0 +1,88 @@
+/* RequestJoin.h
+description:
+This is the module joining change requests to their requesters, for the reports listing the requesters
+of change requests. the requesters are loaded into a hash table by requesterId with one scan of the
+requester file, then the matching change requests are streamed through it, so a report reads each file
+once rather than looking up a requester for every request.
+version history:
+ver1 -26/10/17
+*/
+
+#ifndef REQUEST_JOIN_H
+#define REQUEST_JOIN_H
+
+//==================
+
+#include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include "ChangeRequest.h"
+#include "Constants.h"
+#include "Requester.h"
+
+//==================
+
+// a change request together with its requester
+typedef struct
+{
+    change_request request; // the change request
+    requester requestedBy; // requester of the change request
+}request_join_row;
+
+//==================
+
+// class joining the change requests matching a filter to their requesters
+// provides the joined rows a page at a time, each requester given once per change item
+class RequestJoin
+{
+    public:
+    static bool begin(
+        /* used to filter, only the change requests matching the defined paramatres of the passed change request are joined
+        used as input, does not mutate */
+        const change_request& filter
+    );
+    /* description:
+        loads every requester into the hash table, and starts streaming the change requests matching the filter
+        from the beginning of the change request file.
+    preconditions:
+        the requester and change request databases are initialized.
+    postconditions:
+        the requester file is positioned at its beginning.
+    returns:
+        return 0 on success, return 1 if the requester file could not be read.
+    */
+
+    static int getNextBatch(
+        /* used to store the rows joined by getNextBatch
+        used as output, mutates */
+        request_join_row* readInto,
+        /* maximum number of rows to store in readInto
+        used as input */
+        int maxCount
+    );
+    /* description:
+        saves up to maxCount of the next joined rows to the array "readInto", in the order of the change requests.
+        a requester already given for a change item since begin is skipped, as is a change request whose requester does not exist.
+    preconditions:
+        begin was called.
+    postconditions:
+        position in the change request file will increase.
+    returns:
+        the number of rows saved, 0 when no more change requests match.
+    */
+
+    static void end();
+    /* description:
+        frees the hash table and the requesters already given.
+    */
+
+    private:
+    static std::unordered_map<int32_t, requester> requesters; // every requester by requesterId, the built side of the join
+    static std::unordered_set<int64_t> joined; // changeItemId and requesterId of each row already given
+    static change_request filter; // filter of the streamed change requests
+    static change_request pending[BATCH_READ_SIZE]; // change requests read but not yet joined
+    static int pendingCount; // number of change requests in pending
+    static int pendingNext; // next change request of pending to join
+};
+
+#endif
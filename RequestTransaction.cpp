@@ -0,0 +1,184 @@
+/* RequestTransaction.cpp
+description:
+Module implementing change request transactions.
+
+the keys linking the records are checked before any record is written, so no database refuses a
+write part way through a commit. a write that still fails aborts the log transaction, discarding
+the records written before it, and the databases are reinitialized to drop them from memory. a
+reinitialization that fails is tried again by the next commit, before it writes anything. the
+records stay staged, so a retried commit writes all of them again, and only flushes the log again
+when all records were written but the flush failed. without a log the records written before the
+failed write are kept, and unstaged as before.
+
+version history:
+ver3 -26/10/17
+    -reload closes all databases before opening any, so the shared dictionaries are reloaded, and reports a failed init
+ver2 -26/10/17
+    -failed writes abort the log transaction instead of committing the records written before them
+ver1 -26/10/17
+*/
+
+#ifndef REQUEST_TRANSACTION_CPP
+#define REQUEST_TRANSACTION_CPP
+
+//==================
+
+#include "RequestTransaction.h"
+#include "WriteAheadLog.h"
+
+//==================
+
+// define static staged records
+requester RequestTransaction::stagedRequester;
+change_item RequestTransaction::stagedItem;
+change_request RequestTransaction::stagedRequest;
+bool RequestTransaction::requesterStaged = 0;
+bool RequestTransaction::itemStaged = 0;
+bool RequestTransaction::requestStaged = 0;
+bool RequestTransaction::commitFailed = 0;
+bool RequestTransaction::reloadFailed = 0;
+
+//==================
+
+void RequestTransaction::begin()
+{
+    requesterStaged = 0;
+    itemStaged = 0;
+    requestStaged = 0;
+    commitFailed = 0;
+}
+
+//========
+
+void RequestTransaction::stageRequester(const requester& newRequester)
+{
+    stagedRequester = newRequester;
+    requesterStaged = 1;
+}
+
+//========
+
+void RequestTransaction::stageItem(const change_item& newItem)
+{
+    stagedItem = newItem;
+    itemStaged = 1;
+}
+
+//========
+
+void RequestTransaction::stageRequest(const change_request& newRequest)
+{
+    stagedRequest = newRequest;
+    requestStaged = 1;
+}
+
+//========
+
+bool RequestTransaction::commit()
+{
+    // databases left closed by a failed reload are opened again before anything is written
+    if (reloadFailed && reload())
+    {
+        return 1;
+    }
+
+    // records written by a commit whose flush failed only need the flush retried
+    if (!requestStaged && commitFailed)
+    {
+        WriteAheadLog::beginTransaction();
+        commitFailed = WriteAheadLog::commitTransaction();
+        return commitFailed;
+    }
+
+    // fail if the request is not staged, or if it would be missing its requester or change item
+    if (!requestStaged)
+    {
+        return 1;
+    }
+    if ((!requesterStaged && (stagedRequest.requesterId == -1)) || (!itemStaged && (stagedRequest.changeItemId == -1)))
+    {
+        return 1;
+    }
+
+    WriteAheadLog::beginTransaction();
+    change_request request = stagedRequest; // the staged request, given the ids of the new requester and change item
+    requester newRequester = stagedRequester;
+    change_item newItem = stagedItem;
+    bool failed = 0;
+    bool requesterWritten = 0;
+    bool itemWritten = 0;
+
+    if (requesterStaged)
+    {
+        newRequester.requesterId = RequesterDatabase::getRequesterCount() + 1;
+        failed = RequesterDatabase::writeElement(newRequester);
+        requesterWritten = !failed;
+        request.requesterId = newRequester.requesterId;
+    }
+
+    if (!failed && itemStaged)
+    {
+        newItem.id = -1; // create new
+        failed = ChangeItemDatabase::writeElement(newItem);
+        itemWritten = !failed;
+        request.changeItemId = newItem.id;
+    }
+
+    if (!failed)
+    {
+        failed = ChangeRequestDatabase::writeElement(request);
+    }
+
+    // a failed write discards the records written before it, so they are written again by a retried commit
+    if (failed)
+    {
+        if (!WriteAheadLog::abortTransaction())
+        {
+            reload();
+            return 1;
+        }
+
+        // without a log the records written reached the files, so they are unstaged
+        if (requesterWritten)
+        {
+            stagedRequest.requesterId = newRequester.requesterId;
+            requesterStaged = 0;
+        }
+        if (itemWritten)
+        {
+            stagedRequest.changeItemId = newItem.id;
+            itemStaged = 0;
+        }
+        return 1;
+    }
+    requesterStaged = 0;
+    itemStaged = 0;
+    requestStaged = 0;
+
+    // the written records are committed with one flush
+    commitFailed = WriteAheadLog::commitTransaction();
+    return commitFailed;
+}
+
+//========
+
+// reinitializes the databases, so their state in memory drops the records discarded by an aborted transaction
+// every database is closed before any is opened, so the shared dictionaries are closed too and reloaded from their
+// files, dropping the strings added by the aborted transaction along with their entries
+bool RequestTransaction::reload()
+{
+    // a database left closed by an earlier failed reload fails its uninit, which is not an error here
+    RequesterDatabase::uninit();
+    ChangeItemDatabase::uninit();
+    ChangeRequestDatabase::uninit();
+
+    bool failed = RequesterDatabase::init();
+    failed = ChangeItemDatabase::init() || failed;
+    failed = ChangeRequestDatabase::init() || failed;
+    reloadFailed = failed;
+    return failed;
+}
+
+//========
+
+#endif
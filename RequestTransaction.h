@@ -0,0 +1,95 @@
+/* RequestTransaction.h
+description:
+This is the module for adding a change request together with the requester and change item it
+may create. the records are staged while the request is built, and written to the requester, change
+item and change request databases at commit inside one write ahead log transaction, so they become
+durable through one flush and a crash leaves either all of them or none of them.
+version history:
+ver3 -26/10/17
+    -an aborted commit closes every database before reopening them, and a failed reopen is retried by the next commit
+ver2 -26/10/17
+    -a failed write aborts the commit, leaving every record staged
+ver1 -26/10/17
+*/
+
+#ifndef REQUEST_TRANSACTION_H
+#define REQUEST_TRANSACTION_H
+
+//==================
+
+#include "ChangeItem.h"
+#include "ChangeRequest.h"
+#include "Requester.h"
+
+//==================
+
+// class staging the records of one change request and committing them together
+class RequestTransaction
+{
+    public:
+    static void begin();
+    /* description:
+        starts a new transaction, discarding any records staged before.
+    postconditions:
+        no records are staged.
+    */
+
+    static void stageRequester(
+        /* the new requester
+        used as input */
+        const requester& newRequester
+    );
+    /* description:
+        stages a new requester. its requesterId is assigned at commit, and also given to the staged request.
+    */
+
+    static void stageItem(
+        /* the new change item
+        used as input */
+        const change_item& newItem
+    );
+    /* description:
+        stages a new change item. its id is assigned at commit, and also given to the staged request.
+    */
+
+    static void stageRequest(
+        /* the new change request
+        used as input */
+        const change_request& newRequest
+    );
+    /* description:
+        stages the change request.
+    */
+
+    static bool commit();
+    /* description:
+        writes the staged requester, change item and change request, in that order, and commits them
+        together with one flush of the write ahead log.
+    preconditions:
+        a change request is staged. the requester, change item and change request databases are initialized,
+        and no other module holds the shared dictionaries, so an aborted commit reloads them from their files.
+    postconditions:
+        on success no records are staged. when a write fails, the log transaction is aborted so none of
+        the records is written, and they all stay staged. when the flush fails, the records are written
+        and only the flush is retried. either way commit can be retried without staging again and
+        without writing a record twice. databases that could not be reinitialized after an aborted commit
+        are reinitialized by the retried commit.
+    returns:
+        return 0 on successful commit, return 1 on failure.
+    */
+
+    private:
+    static requester stagedRequester;
+    static change_item stagedItem;
+    static change_request stagedRequest;
+    static bool requesterStaged;
+    static bool itemStaged;
+    static bool requestStaged;
+    static bool commitFailed; // true if the last commit wrote its records but failed to flush them
+
+    static bool reloadFailed; // true if the databases could not all be reinitialized after an aborted commit
+
+    static bool reload(); // reinitializes the databases after an aborted commit, return 0 on success
+};
+
+#endif
@@ -2,6 +2,26 @@
 description:
 This is the implementation of the Requester module
 version history:
+ver11 -26/10/17
+    -uninit fails when the name index or the email filter cannot be saved
+ver10 -26/10/17
+    -the requesterId index file is a StorageFile written in the log group of the requester, writeElement failing when the entry cannot be written
+ver9 -26/10/17
+    -added RequesterTraits pack and unpack, the database file is in the packed record format
+ver8 -26/10/17
+    -requester emails kept in a KeySet, its filter saved in RequesterEmail.bloom at uninit
+    -added findByEmail
+ver7 -26/10/17
+    -added name index with prefix search, kept sorted in RequesterName.idx
+    -the index file is written whole at uninit, and rebuilt at init when its entry count does not match the database
+ver6 -26/10/17
+    -requesters stored in a RecordStore, which holds the file access index and select cache
+ver5 -26/10/17
+    -added requesterId index and findById
+    -index is kept in Requester.idx, one entry appended per written requester
+    -file access through StorageFile, so the file may be memory mapped
+    -select reads the cached element position directly and wraps negative cache positions
+    -added getNextBatch, reading BATCH_READ_SIZE requesters per file access
 ver4 -24/07/25, update by Nicolao Barreto
      -select function fix
 ver3 -24/07/25, updated by Wah Paw Hser
@@ -14,20 +34,69 @@ ver1 -24/07/14, original by Wah Paw Hser
 //==================
 
 #include "Requester.h"
+#include "WriteAheadLog.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
 #include <iostream>
 #include <cstring>
 
 //==================
 
-// define static utilities for select
-int64_t RequesterDatabase::previouslyAccessed[20] = {0};
-int64_t RequesterDatabase::previouslyAccessedPosition = 0;
-
 // define static utilities for file interaction
 const char* RequesterDatabase::filename = "Requester.dat";
-std::fstream RequesterDatabase::requesterData;
-int64_t RequesterDatabase::fileIndex = 0;
-int64_t RequesterDatabase::requesterCount = 0;
+RecordStore<requester, RequesterTraits> RequesterDatabase::requesters;
+
+// define static utilities for the requesterId index
+const char* RequesterDatabase::indexFilename = "Requester.idx";
+StorageFile RequesterDatabase::indexFile;
+std::unordered_map<int32_t, int64_t> RequesterDatabase::idIndex;
+
+// define static utilities for the name index
+const char* RequesterDatabase::nameIndexFilename = "RequesterName.idx";
+std::multimap<std::string, int64_t> RequesterDatabase::nameIndex;
+std::multimap<std::string, int64_t>::const_iterator RequesterDatabase::nameCursor = RequesterDatabase::nameIndex.end();
+std::string RequesterDatabase::namePrefix;
+
+// define static utilities for the email KeySet
+const char* RequesterDatabase::emailsFilename = "RequesterEmail.bloom";
+KeySet RequesterDatabase::emails;
+
+// entry of the requesterId index file
+typedef struct
+{
+    int32_t requesterId;
+    int64_t position; // element position in requester file
+}requester_index_entry;
+
+// entry of the name index file, entries are stored in alphabetical order
+typedef struct
+{
+    char name[MAX_REQUESTER_NAME_SIZE]; // lower cased name, the key of the entry
+    int64_t position; // element position in requester file
+}requester_name_entry;
+
+//==================
+
+/* function emailKey:
+    this function is implemented to give the key of an email in the email KeySet, the email in lower case.
+*/
+std::string emailKey(const char* email) {
+    std::string key(email, strnlen(email, MAX_EMAIL_SIZE));
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return key;
+}
+
+//==================
+
+/* function nameKey:
+    this function is implemented to give the key of a name in the name index, the name in lower case.
+*/
+std::string nameKey(const char* name) {
+    std::string key(name, strnlen(name, MAX_REQUESTER_NAME_SIZE));
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return key;
+}
 
 //==================
 
@@ -37,68 +106,217 @@ int64_t RequesterDatabase::requesterCount = 0;
     database, and intitialize the utility variables to 0. Returns 0 on successfuly initiazation,
     returns 1 elsewise. 
 */
-bool RequesterDatabase::init() {
-    // open requester file
-    requesterData.open(filename, std::ios::in | std::ios::out | std::ios::binary);
+bool RequesterDatabase::init(StorageBackend backend) {
+    // open requester file, creating it if it doesn't already exist
+    // return 1 if the file does not open, the store counts the requesters and resets its utilities
+    if (requesters.open(filename, backend)) {
+        return 1;
+    }
 
-    // create file if it doesn't already exist
-    if (!requesterData.is_open()) {
-        requesterData.clear();
-        std::ofstream createFile(filename, std::ios::out | std::ios::binary);
-        createFile.close();
-        requesterData.open(filename, std::ios::in | std::ios::out | std::ios::binary);
+    // load the requesterId and name indexes
+    if (loadIndex(backend) || loadNameIndex()) {
+        return 1;
     }
 
-    // return 1 if the file does not open
-    if (!requesterData.is_open()) {
+    // load the email filter, rebuilding the emails if it does not match the database
+    if (emails.load(emailsFilename, requesters.getCount()) && rebuildEmails()) {
         return 1;
     }
+    return 0;
+}
 
-    // calculate requesterCount
-    requesterData.seekg(0, std::ios::end);
-    requesterCount = requesterData.tellg()/sizeof(requester);
-    requesterData.seekg(0, std::ios::beg);
+//==================
 
-    // initialize utilites to 0
-    fileIndex = 0;
-    previouslyAccessedPosition = 0;
-    memset(previouslyAccessed, 0, sizeof(previouslyAccessed)); 
+/* function loadIndex:
+    this function is implemented to open the requesterId index file and load its entries into
+    the in memory hash index. if the index file does not hold exactly one entry per requester
+    it is out of date, so it is rebuilt from a single scan of the requester file.
+*/
+bool RequesterDatabase::loadIndex(StorageBackend backend) {
+    // open index file, creating it if it doesn't already exist
+    // return 1 if the index file does not open
+    if (indexFile.open(indexFilename, backend)) {
+        return 1;
+    }
 
+    idIndex.clear();
+    idIndex.reserve(requesters.getCount());
+
+    int64_t entryCount = requesters.getCount();
+    int64_t position = 0;
+    requester_index_entry block[BATCH_READ_SIZE];
+
+    // index matches the database, load it BATCH_READ_SIZE entries at a time
+    if (indexFile.getSize() == static_cast<int64_t>(sizeof(requester_index_entry)) * entryCount) {
+        while (position < entryCount) {
+            int64_t blockCount = std::min<int64_t>(entryCount - position, BATCH_READ_SIZE);
+            if (indexFile.read(sizeof(requester_index_entry) * position, block, sizeof(requester_index_entry) * blockCount)) {
+                return 1;
+            }
+            for (int64_t i = 0; i < blockCount; i++) {
+                idIndex[block[i].requesterId] = block[i].position;
+            }
+            position += blockCount;
+        }
+        return 0;
+    }
+
+    // index is out of date, rebuild it from the requester file
+    indexFile.close();
+    std::remove(indexFilename);
+    if (indexFile.open(indexFilename, backend)) {
+        return 1;
+    }
+
+    requester element;
+    requester_index_entry entry;
+    for (; position < entryCount; position++) {
+        if (requesters.read(position, element)) {
+            return 1;
+        }
+        entry.requesterId = element.requesterId;
+        entry.position = position;
+        if (indexFile.write(sizeof(requester_index_entry) * position, &entry, sizeof(requester_index_entry))) {
+            return 1;
+        }
+        idIndex[entry.requesterId] = entry.position;
+    }
     return 0;
 }
 
 //==================
 
+/* function loadNameIndex:
+    this function is implemented to load the name index from its file. the file holds the entries in
+    alphabetical order, so each is added at the end of the index. if the file does not hold exactly one
+    entry per requester, requesters were added since it was written, so the index is rebuilt from a
+    single scan of the requester file.
+*/
+bool RequesterDatabase::loadNameIndex() {
+    nameIndex.clear();
+    nameCursor = nameIndex.end();
+    namePrefix.clear();
+
+    std::ifstream nameData(nameIndexFilename, std::ios::in | std::ios::binary);
+    if (nameData.is_open()) {
+        nameData.seekg(0, std::ios::end);
+        int64_t entryCount = nameData.tellg()/sizeof(requester_name_entry);
+        nameData.seekg(0, std::ios::beg);
+
+        // index matches the database, load it
+        if (entryCount == requesters.getCount()) {
+            requester_name_entry entry;
+            for (int64_t i = 0; i < entryCount; i++) {
+                nameData.read(reinterpret_cast<char*>(&entry), sizeof(requester_name_entry));
+                if (nameData.fail()) {
+                    return 1;
+                }
+                entry.name[MAX_REQUESTER_NAME_SIZE - 1] = '\0';
+                nameIndex.emplace_hint(nameIndex.end(), entry.name, entry.position);
+            }
+            nameCursor = nameIndex.end();
+            return 0;
+        }
+    }
+
+    // index is missing or out of date, rebuild it from the requester file
+    requester element;
+    for (int64_t i = 0; i < requesters.getCount(); i++) {
+        if (requesters.read(i, element)) {
+            return 1;
+        }
+        nameIndex.emplace(nameKey(element.name), i);
+    }
+    nameCursor = nameIndex.end();
+
+    // store the rebuilt index, so the next init loads it
+    return saveNameIndex();
+}
+
+//==================
+
+/* function saveNameIndex:
+    this function is implemented to write every entry of the name index to its file, in alphabetical order.
+*/
+bool RequesterDatabase::saveNameIndex() {
+    std::ofstream nameData(nameIndexFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!nameData.is_open()) {
+        return 1;
+    }
+
+    requester_name_entry entry;
+    for (std::multimap<std::string, int64_t>::const_iterator indexed = nameIndex.begin(); indexed != nameIndex.end(); indexed++) {
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.name, indexed->first.c_str(), MAX_REQUESTER_NAME_SIZE - 1);
+        entry.position = indexed->second;
+        nameData.write(reinterpret_cast<char*>(&entry), sizeof(requester_name_entry));
+    }
+    nameData.close();
+
+    return nameData.fail();
+}
+
+//==================
+
 /* function uninit:
     this function is implemented to uninitialize the requester database by closing the file,
-    if it is open.
+    if it is open. the name index and the email filter are saved first, and uninit fails if
+    either cannot be saved.
 */
 bool RequesterDatabase::uninit() {
-    if (requesterData.is_open()) {
-        requesterData.close();
-        return 0;
+    // save the name index and the emails while the database is open
+    bool opened = requesters.isOpen();
+    bool failed = !opened;
+    if (opened) {
+        failed = saveNameIndex();
+        failed = emails.save(emailsFilename) || failed;
     }
-    return 1;
+
+    // close the indexes along with the database
+    if (indexFile.isOpen()) {
+        failed = indexFile.close() || failed;
+    }
+    idIndex.clear();
+    nameIndex.clear();
+    emails.clear();
+    nameCursor = nameIndex.end();
+
+    if (opened) {
+        failed = requesters.close() || failed;
+    }
+    return failed;
 }
 
 //==================
 
 /* function writeElement:
     this function is implemented to write a new requester to the end of the requester file and
-    update the requester count if the requester is successfully written.
+    update the requester count if the requester is successfully written. the requester is also
+    added to the requesterId index, its entry written in the same log group as the requester so a
+    failed write of either fails the requester before any index in memory is changed.
 */
 bool RequesterDatabase::writeElement(requester& readIn) {
-    // write new element to the end of the file
-    requesterData.seekp(0, std::ios::end);
-    requesterData.write(reinterpret_cast<char*>(&readIn), sizeof(requester));
-
-    // return 1 if writing the element is not successful
-    if (requesterData.fail()) {
+    // write new element to the end of the file, and its requesterId index entry in the same log group
+    // return 1 if writing either is not successful, the transaction writing the requester aborts the group
+    int64_t position = requesters.getCount();
+    requester_index_entry entry;
+    entry.requesterId = readIn.requesterId;
+    entry.position = position;
+    WriteAheadLog::holdCommit();
+    bool failed = requesters.write(position, readIn)
+        || indexFile.write(sizeof(requester_index_entry) * position, &entry, sizeof(requester_index_entry));
+    bool commitFailed = WriteAheadLog::releaseCommit();
+    if (failed) {
         return 1;
     }
-    
-    requesterCount++;
-    return 0;
+
+    // record the new requester's position in the requesterId index
+    idIndex[entry.requesterId] = entry.position;
+
+    // add the new requester to the name index and the emails, their files are written at uninit
+    nameIndex.emplace(nameKey(readIn.name), position);
+    emails.add(emailKey(readIn.email), position);
+    return commitFailed;
 }
 
 //==================
@@ -109,25 +327,7 @@ bool RequesterDatabase::writeElement(requester& readIn) {
 */
 bool RequesterDatabase::getNext(requester& readInto) {
     // return 1 if the requester file is not open, or there are no more requesters to read into
-    if (!requesterData.is_open() || fileIndex >= requesterCount) {
-        return 1;
-    }
-
-    // read next requester from file
-    requesterData.seekg(fileIndex * sizeof(requester), std::ios::beg);
-    requesterData.read(reinterpret_cast<char*>(&readInto), sizeof(requester));
-
-    // return 1 if the data cannot be read
-    if (requesterData.fail()) {
-        return 1;
-    }
-
-    // update file access indexes
-    previouslyAccessed[previouslyAccessedPosition] = fileIndex;
-    previouslyAccessedPosition = (previouslyAccessedPosition + 1) % 20;
-    fileIndex++;
-
-    return 0;
+    return requesters.getNext(readInto);
 }
 
 //==================
@@ -138,50 +338,71 @@ bool RequesterDatabase::getNext(requester& readInto) {
     update the file access pointers.
 */
 bool RequesterDatabase::getNext(requester& readInto, requester& filter) {
+    // return 1 if the whole file has been read and there are no more reqeusters matching the filter
+    return requesters.getNext(readInto, filter);
+}
 
-    // while there are still requesters to read into, read the current requester and check if the 
-    // filter matches
-    while (fileIndex < requesterCount) {
-        // read next requester from file
-        requesterData.seekg(fileIndex * sizeof(requester), std::ios::beg);
-        requesterData.read(reinterpret_cast<char*>(&readInto), sizeof(requester));
+//==================
 
-        // return 1 if data cannot be read
-        if (requesterData.fail()) {
-            return 1;
-        }
+/* function getNextBatch:
+    this function is implemented to read the requesters after the file access index in blocks of 
+    BATCH_READ_SIZE, and copy up to maxCount requesters matching the filter into readInto. every
+    requester copied updates the file access pointers, as getNext does.
+*/
+int RequesterDatabase::getNextBatch(requester* readInto, int maxCount, const requester& filter) {
+    // return the number of requesters copied, 0 if the requester file is not open
+    return requesters.getNextBatch(readInto, maxCount, filter);
+}
 
-        // check if the current requester record matches the filter
-        bool match = true;
-        if (strlen(filter.name) != 0 && strcmp(readInto.name, filter.name) != 0) {
-            match = false;
-        }
-        if (strlen(filter.phone) != 0 && strcmp(readInto.phone, filter.phone) != 0) {
-            match = false;
-        }
-        if (strlen(filter.email) != 0 && strcmp(readInto.email, filter.email) != 0) {
-            match = false;
-        }
-        if (strlen(filter.department) != 0 && strcmp(readInto.department, filter.department) != 0) {
-            match = false;
-        }
-        if (filter.requesterId != -1 && readInto.requesterId != filter.requesterId) {
-            match = false;
-        }
+//==================
 
-        // if the filter matches the current requester record, update the file access variables and return 0
-        if (match) {
-            previouslyAccessed[previouslyAccessedPosition] = fileIndex;
-            previouslyAccessedPosition = (previouslyAccessedPosition + 1) % 20;
-            fileIndex++;
-            return 0;
-        }
+/* function pack:
+    this function is implemented to pack the fields of a requester in the order they are declared,
+    without the padding of the requester struct.
+*/
+void RequesterTraits::pack(const requester& element, char* bytes) {
+    packString(bytes, element.name, MAX_REQUESTER_NAME_SIZE);
+    packString(bytes, element.phone, PHONE_NUMBER_SIZE);
+    packString(bytes, element.email, MAX_EMAIL_SIZE);
+    packString(bytes, element.department, MAX_DEPARTMENT_SIZE);
+    packInt(bytes, element.requesterId, 4);
+}
 
-        // if no match, increment index and continue while loop
-        fileIndex++;
+//==================
+
+/* function unpack:
+    this function is implemented to read back the fields of a requester packed by pack.
+*/
+void RequesterTraits::unpack(const char* bytes, requester& element) {
+    unpackString(bytes, element.name, MAX_REQUESTER_NAME_SIZE);
+    unpackString(bytes, element.phone, PHONE_NUMBER_SIZE);
+    unpackString(bytes, element.email, MAX_EMAIL_SIZE);
+    unpackString(bytes, element.department, MAX_DEPARTMENT_SIZE);
+    element.requesterId = static_cast<int32_t>(unpackInt(bytes, 4));
+}
+
+//==================
+
+/* function matches:
+    this function is implemented to check a requester against every field set in the filter.
+*/
+bool RequesterTraits::matches(const requester& element, const requester& filter) {
+    if (strlen(filter.name) != 0 && strcmp(element.name, filter.name) != 0) {
+        return false;
     }
-    // return 1 if the whole file has been read and there are no more reqeusters to read from
-    return 1;
+    if (strlen(filter.phone) != 0 && strcmp(element.phone, filter.phone) != 0) {
+        return false;
+    }
+    if (strlen(filter.email) != 0 && strcmp(element.email, filter.email) != 0) {
+        return false;
+    }
+    if (strlen(filter.department) != 0 && strcmp(element.department, filter.department) != 0) {
+        return false;
+    }
+    if (filter.requesterId != -1 && element.requesterId != filter.requesterId) {
+        return false;
+    }
+    return true;
 }
 
 //==================
@@ -191,45 +412,145 @@ bool RequesterDatabase::getNext(requester& readInto, requester& filter) {
     the previously accessed ones based on the provided index using circular array calculations.
 */
 bool RequesterDatabase::select(requester& readInto, int index, int menuCount) {
-    // error check the index, return 1 if not legal
-    if (index <= 0 || index > menuCount || index > 20) {
+    // return 1 if the index is not legal or the requester could not be read
+    return requesters.select(readInto, index, menuCount);
+}
+
+//==================
+
+/* function seekToBeginning:
+    this function is implemented to seek to the beginning of the file and reset the file
+    access index.
+*/
+bool RequesterDatabase::seekToBeginning() {
+    // return position in the file to the beginning
+    return requesters.seekToBeginning();
+}
+
+//==================
+
+/* function findById:
+    this function is implemented to look up the position of a requester in the requesterId index
+    and read that requester directly, without scanning the file or moving the file access index.
+*/
+bool RequesterDatabase::findById(requester& readInto, int32_t requesterId) {
+    // return 1 if the requester file is not open
+    if (!requesters.isOpen()) {
         return 1;
     }
 
-    // find the index of the selected in the circular array
-    int64_t position = previouslyAccessed[(previouslyAccessedPosition - 1 + index - menuCount) % 20];
+    // return 1 if the requesterId is not in the index
+    std::unordered_map<int32_t, int64_t>::const_iterator found = idIndex.find(requesterId);
+    if (found == idIndex.end()) {
+        return 1;
+    }
 
-    // seek and read the requester
-    requesterData.seekg(previouslyAccessed[position] * sizeof(requester), std::ios::beg);
-    requesterData.read(reinterpret_cast<char*>(&readInto), sizeof(requester));
+    // read the requester
+    // return 1 if data could not be read
+    if (requesters.read(found->second, readInto)) {
+        return 1;
+    }
 
+    return readInto.requesterId != requesterId;
+}
+
+//==================
+
+/* function findByEmail:
+    this function is implemented to check the email filter for the email, which rules out most new
+    emails, and otherwise look the email up in the email hash map and read that requester directly.
+    the hash map is built by the first lookup the filter does not rule out.
+*/
+bool RequesterDatabase::findByEmail(requester& readInto, const char* email) {
+    // return 1 if the requester file is not open
+    if (!requesters.isOpen()) {
+        return 1;
+    }
+
+    // return 1 if the email is certainly new
+    std::string key = emailKey(email);
+    if (!emails.mayContain(key)) {
+        return 1;
+    }
+
+    // return 1 if the email is not in the hash map
+    int64_t position;
+    if ((!emails.isExact() && rebuildEmails()) || emails.find(key, position)) {
+        return 1;
+    }
+
+    // read the requester
     // return 1 if data could not be read
-    if (requesterData.fail()) {
+    return requesters.read(position, readInto);
+}
+
+//==================
+
+/* function rebuildEmails:
+    this function is implemented to empty the email KeySet and add the email of every requester to it,
+    from a single scan of the requester file.
+*/
+bool RequesterDatabase::rebuildEmails() {
+    requester element;
+    emails.reset(requesters.getCount());
+    for (int64_t i = 0; i < requesters.getCount(); i++) {
+        if (requesters.read(i, element)) {
+            emails.clear();
+            return 1;
+        }
+        emails.add(emailKey(element.email), i);
+    }
+    return 0;
+}
+
+//==================
+
+/* function seekToName:
+    this function is implemented to find the first name not before the prefix in the name index.
+    the names starting with the prefix follow it in alphabetical order.
+*/
+bool RequesterDatabase::seekToName(const char* prefix) {
+    // return 1 if the requester file is not open
+    if (!requesters.isOpen()) {
         return 1;
     }
 
+    namePrefix = nameKey(prefix);
+    nameCursor = nameIndex.lower_bound(namePrefix);
     return 0;
 }
 
 //==================
 
-/* function seekToBeginning:
-    this function is implemented to seek to the beginning of the file and reset the file
-    access index.
+/* function getNextByName:
+    this function is implemented to read the requester at the alphabetical position, if its name starts
+    with the prefix, and move the alphabetical position to the next requester. the requester's position
+    is cached for select.
 */
-bool RequesterDatabase::seekToBeginning() {
-    // return position in the file to the beginning
-    requesterData.clear();
-    requesterData.seekg(0, std::ios::beg);
-    fileIndex = 0;
+bool RequesterDatabase::getNextByName(requester& readInto) {
+    // return 1 if the requester file is not open, or no more names start with the prefix
+    if (!requesters.isOpen() || (nameCursor == nameIndex.end())) {
+        return 1;
+    }
+    if (nameCursor->first.compare(0, namePrefix.size(), namePrefix) != 0) {
+        return 1;
+    }
+
+    // read the requester
+    // return 1 if data could not be read
+    if (requesters.read(nameCursor->second, readInto)) {
+        return 1;
+    }
+    requesters.remember(nameCursor->second);
+    nameCursor++;
     return 0;
 }
 
 //==================
 
 /* function getRequesterCount:
-    this function is implemented to return the requesterCount variable in the RequesterDatabase class
+    this function is implemented to return the number of requesters in the RequesterDatabase class
 */
 int64_t RequesterDatabase::getRequesterCount() {
-    return requesterCount;
+    return requesters.getCount();
 }
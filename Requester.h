@@ -3,6 +3,23 @@ description:
 This is the module for interface of maintenance of requester objects in the requester 
 database. 
 version history:
+ver10 -26/10/17
+    -the requesterId index file is a StorageFile, loaded by the backend chosen at init
+ver9 -26/10/17
+    -RequesterTraits derives the defaults of the RecordStore hooks from RecordTraits
+ver8 -26/10/17
+    -requesters packed by RequesterTraits, for the packed record format of RecordStore
+ver7 -26/10/17
+    -added findByEmail, checking requester emails through a KeySet
+ver6 -26/10/17
+    -added seekToName and getNextByName, reading requesters in alphabetical order from a persistent name index
+ver5 -26/10/17
+    -added include guard
+    -requesters stored in a RecordStore, filtering moved to RequesterTraits
+ver4 -26/10/17
+    -added findById, backed by a persistent requesterId hash index
+    -file access through StorageFile, backend chosen at init
+    -added getNextBatch
 ver3 -24/07/15, updated by Wah Paw Hser
     -declared the getRequesterCount() method
 ver2 -24/07/14, proposed by Nicolao Baretto, rewrite by Wah Paw Hser
@@ -11,11 +28,20 @@ ver1 -24/07/02, original by Wah Paw Hser and Puja Shah
 
 */
 
+#ifndef REQUESTER_H
+#define REQUESTER_H
+
 //==================
 
 #include <stdint.h>
 #include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
 #include "Constants.h"
+#include "KeySet.h"
+#include "RecordStore.h"
+#include "StorageFile.h"
 
 //==================
 
@@ -28,12 +54,59 @@ typedef struct
     int32_t requesterId = -1;         
 }requester;
 
+// packing and filtering of requesters for the RecordStore holding them
+struct RequesterTraits : RecordTraits
+{
+    static constexpr char MAGIC[9] = "\211ITSRQTR"; // names requester files in their header
+    static const int RECORD_SIZE = (MAX_REQUESTER_NAME_SIZE - 1) + (PHONE_NUMBER_SIZE - 1) + (MAX_EMAIL_SIZE - 1) + (MAX_DEPARTMENT_SIZE - 1) + 4; // bytes of a packed requester
+
+    static void pack(
+        /* element to pack
+        used as input */
+        const requester& element,
+        /* RECORD_SIZE bytes the element is packed into
+        used as output, mutates */
+        char* bytes
+    );
+    /* description:
+        packs the fields of the element in the order they are declared.
+    */
+
+    static void unpack(
+        /* RECORD_SIZE bytes of a packed element
+        used as input */
+        const char* bytes,
+        /* used to store the element unpacked
+        used as output, mutates */
+        requester& element
+    );
+    /* description:
+        reads back the fields of an element packed by pack.
+    */
+
+    static bool matches(
+        /* element to check
+        used as input */
+        const requester& element,
+        /* filter to check against
+        used as input */
+        const requester& filter
+    );
+    /* returns:
+        true if the element matches every defined field of the filter.
+    */
+};
+
 // class managing file interaction with requester database
 // provides high level read and write with requester objects
 class RequesterDatabase
 {
     public:
-    static bool init();
+    static bool init(
+        /* way in which the database file is accessed
+        used as input */
+        StorageBackend backend = DEFAULT_STORAGE_BACKEND
+    );
     /* description:
         initializes the requester database for interaction
     preconditions:
@@ -47,13 +120,14 @@ class RequesterDatabase
 
     static bool uninit();
     /* description:
-        uninitializes the requester database and cleans up
+        uninitializes the requester database and cleans up, saving the name index and the email filter
     preconditions:
         the RequesterDatabase must be currently initialized.
     postconditions:
         the user will not have access to the database.
     returns:
-        return 0 on successful uninitialization, return 1 on failure.
+        return 0 on successful uninitialization, return 1 on failure, including a failure to save
+        the name index or the email filter.
     */
 
     static bool writeElement(
@@ -102,6 +176,27 @@ class RequesterDatabase
         return 0 on successful read, return 1 on failure.
     */
 
+    static int getNextBatch(
+        /* used to store the requesters read in by getNextBatch
+        used as output, mutates */
+        requester* readInto,
+        /* maximum number of requesters to store in readInto
+        used as input */
+        int maxCount,
+        /* used to filter, getNextBatch will only get requesters matching the defined paramatres of the passed requester
+        used as input, does not mutate*/
+        const requester& filter
+    );
+    /* description:
+        saves up to maxCount of the next requesters matching the filter to the array "readInto".
+        the file is read BATCH_READ_SIZE elements at a time.
+    postconditions:
+        position in file will increase.
+        every requester saved can be retrieved again by select.
+    returns:
+        the number of requesters saved, 0 when no more requesters match.
+    */
+
     static bool select(
         /* used to store the requester read in by select
         used as output, mutates */
@@ -131,6 +226,72 @@ class RequesterDatabase
         return 0 on successful seek, return 1 on failure.
     */
 
+    static bool findById(
+        /* used to store the requester found by findById
+        used as output, mutates */
+        requester& readInto,
+        /* requesterId of the requester to find
+        used as input */
+        int32_t requesterId
+    );
+    /* description:
+        saves the requester with the given requesterId to the requester referenced by "readInto".
+        uses the requesterId index, so no scan of the file is made.
+    postconditions:
+        position in file is unchanged.
+    returns:
+        return 0 on successful read, return 1 if no such requester exists.
+    */
+
+    static bool findByEmail(
+        /* used to store the requester found by findByEmail
+        used as output, mutates */
+        requester& readInto,
+        /* email of the requester to find, letter case is ignored
+        used as input */
+        const char* email
+    );
+    /* description:
+        saves the requester with the given email to the requester referenced by "readInto".
+        uses the email KeySet, so no scan of the file is made.
+    postconditions:
+        position in file is unchanged.
+    returns:
+        return 0 on successful read, return 1 if no such requester exists.
+    */
+
+    static bool seekToName(
+        /* start of the names of the requesters to read, "" for every requester
+        used as input */
+        const char* prefix
+    );
+    /* description:
+        moves the alphabetical position to the first requester whose name starts with prefix.
+        names are ordered and compared ignoring letter case, and requesters of the same name by when they were added.
+        uses the name index, so no scan of the file is made.
+    postconditions:
+        getNextByName reads the requesters whose name starts with prefix, in alphabetical order.
+    returns:
+        return 0 on successful seek, return 1 on failure.
+    */
+
+    static bool getNextByName(
+        /* used to store the requester read in by getNextByName
+        used as output, mutates */
+        requester& readInto
+    );
+    /* description:
+        saves the requester at the alphabetical position to the requester referenced by "readInto".
+    preconditions:
+        seekToName has been called since init.
+    postconditions:
+        the alphabetical position moves to the next requester.
+        the requester can be retrieved again by select.
+        position in file is unchanged.
+    returns:
+        return 0 on successful read, return 1 when no more requesters start with the prefix.
+    */
+
     static int64_t getRequesterCount();
     /* description:
         returns the number of requesters in the database.
@@ -139,13 +300,28 @@ class RequesterDatabase
     */
 
     private:
-    // utilities for select
-    static int64_t previouslyAccessed[20]; // records the indexes of the previous elements accessed, circular array
-    static int64_t previouslyAccessedPosition; // position in previously accessed
-
     // utilities for file interaction
     static const char* filename; // name of requester file
-    static std::fstream requesterData; // database elements
-    static int64_t fileIndex; // currently viewed element in database file
-    static int64_t requesterCount; // this value is caculated at initialisation
+    static RecordStore<requester, RequesterTraits> requesters; // database elements, file access index and select cache
+
+    // utilities for the requesterId index
+    static bool loadIndex(StorageBackend backend); // loads the index file, rebuilding it if it does not match the database
+    static const char* indexFilename; // name of requesterId index file
+    static StorageFile indexFile; // index entries, one per requester
+    static std::unordered_map<int32_t, int64_t> idIndex; // requesterId to element position in database file
+
+    // utilities for the name index
+    static bool loadNameIndex(); // loads the name index file, rebuilding the index if it does not match the database
+    static bool saveNameIndex(); // writes the name index to its file in alphabetical order
+    static const char* nameIndexFilename; // name of name index file
+    static std::multimap<std::string, int64_t> nameIndex; // lower cased name to element position in database file, in alphabetical order
+    static std::multimap<std::string, int64_t>::const_iterator nameCursor; // alphabetical position of getNextByName
+    static std::string namePrefix; // lower cased prefix of the names read by getNextByName
+
+    // utilities for the email KeySet
+    static bool rebuildEmails(); // adds the email of every requester to an emptied KeySet, return 0 on success
+    static const char* emailsFilename; // name of email filter file
+    static KeySet emails; // lower cased requester emails
 };
+
+#endif
@@ -5,6 +5,35 @@ provides the logical control of movement between menus
 provides input checking and delivery to lower level modules
 guides the user through the process of completing a main menu selection
 version history:
+ver20 -26/10/17
+    - added generateReportRequestsByDate, listing the change requests of a range of dates through the request date index
+ver19 -26/10/17
+    - selectItem can find a change item by ID, archived change items included
+ver18 -26/10/17
+    - request and release dates must be dates of the calendar, as they are stored as days
+ver17 -26/10/17
+    - listOfRequesters joins the requests to their requesters through RequestJoin, listing each requester once
+ver16 -26/10/17
+    - listItems pages through the product's list of unresolved change items when listing them
+ver15 -26/10/17
+    - added generateReportSummary, counting the change items of each product from the change item tallies
+ver14 -26/10/17
+    - product, release and requester uniqueness checks look the key up instead of scanning the file
+    - a requester is a duplicate if its email is already used, ignoring letter case
+ver13 -26/10/17
+    - selectItem can search the change items by description
+    - addRequestControl can search the requesters by the start of their name, listed in alphabetical order
+    - addRequestControl first lists the change items of the product similar to the new request's description
+ver12 -26/10/17
+    - addRequestControl stages its requester, change item and change request and commits them together
+    - choosing an existing requester at the uniqueness check keeps its requesterId for the request
+ver11 -26/10/17
+    - database writes go through the write ahead log, initialized before and uninitialized after the databases
+    - added commitControl
+ver10 -26/10/17
+    - listOfRequesters looks requesters up by id instead of rescanning the requester file per request
+    - item and requester list menus read a page at a time with getNextBatch
+    - selected items are taken from the page read instead of being read again through select
 ver9 -24/07/31 by Puja Shah and Nicolao Barreto
     - fixed print formatting and error in report type 2.
 ver8 -24/07/31 by Puja Shah and Nicolao Barreto
@@ -30,6 +59,7 @@ ver1 -24/07/15 implementation by Puja Shah, and Nicolao Barreto
 
 #include "ScenarioControl.h"
 #include "Constants.h"
+#include "Date.h"
 #include <string>
 #include <iostream>
 #include <iomanip>
@@ -48,6 +78,7 @@ const char *OPTION_NOT_AVAILABLE = "The option that you have entered does not ex
 const char *EXCEEDS_BOUNDS = "The value that you have entered exceeds the bounds set by the data format requirements.\n\nEnter Y to try again. Enter N to return to the Main Menu.\n";
 const char *BELOW_BOUNDS = "The value that you have entered is below the bounds set by the data format requirements.\n\nEnter Y to try again. Enter N to return to the Main Menu.\n";
 const char *INCORRECT_CHARACTER_TYPE = "The value that you have entered does not meet the character type requirements for the given field.\n\nEnter Y to try again. Enter N to return to the Main Menu.\n";
+const char *DATE_NOT_IN_CALENDAR = "The date that you have entered is not a date of the calendar.\n\nEnter Y to try again. Enter N to return to the Main Menu.\n";
 const char *CHANGE_ITEM_STATUS_ERROR = "The change item's status cannot be changed out of its status.\n\nEnter N to return to the Main Menu.\n";
 const char *REQEUSTER_UNIQUENESS_ERROR = "The requester already exists.\n\nEnter Y to continue creating a change request. Enter N to return to the main menu.\n";
 const char *PRODUCT_UNIQUENESS_ERROR = "The product already exists.\n\nEnter Y to try again. Enter N to return to the main menu.\n";
@@ -65,6 +96,8 @@ Description: Initializes the Scenario Control module by initializing each of the
 void initControl()
 {
     // initializes all lower level modules
+    // the log is initialized first, so it is replayed before the databases are read and logs their writes
+    WriteAheadLog::init();
     Product::initProduct();
     Release::initRelease();
     RequesterDatabase::init();
@@ -88,11 +121,22 @@ void uninitControl()
     RequesterDatabase::uninit();
     ChangeItemDatabase::uninit();
     ChangeRequestDatabase::uninit();
+    WriteAheadLog::uninit();
 
     // set initialize to false
     initialized = false;
 }
 
+//========
+
+/*
+Makes the writes of the completed processes durable by committing them in the write ahead log
+*/
+void commitControl()
+{
+    WriteAheadLog::commit();
+}
+
 //==================
 // implementation of helper functions for updateChangeItemControl and reports
 
@@ -275,6 +319,7 @@ void selectItem(change_item& readInto, change_item &filter, bool a)
     int reqSelection = 0;
     int entries = 0;
     bool continues = false;
+    change_item page[MAX_PRINTS]; // items of the menu page being shown
 
     // loop that runs until a selection has been made.
     while (!selected)
@@ -294,7 +339,8 @@ void selectItem(change_item& readInto, change_item &filter, bool a)
         }
 
 
-        while (!ChangeItemDatabase::getNext(readInto, filter))
+        // read a page of up to 16 items, until the file ends
+        while ((entries = ChangeItemDatabase::getNextBatch(page, MAX_PRINTS, filter)) > 0)
         {
             if(continues){
                 cout << endl << endl;
@@ -309,18 +355,13 @@ void selectItem(change_item& readInto, change_item &filter, bool a)
                     std::cout << "     ID       Description                   Status      Release" << std::endl;
                 }
             }
-            entries = 0;
-            itemReportShow(entries+1, readInto);
-            entries++;
-
             // populate menu
-            while (!ChangeItemDatabase::getNext(readInto, filter) && entries < MAX_PRINTS)
+            for (int i = 0; i < entries; i++)
             {
-                itemReportShow(entries+1, readInto);
-                entries++;
+                itemReportShow(i+1, page[i]);
             }
 
-            std::cout << "[0]  Back    [00] Back to Main Menu    ";
+            std::cout << "[0]  Back    [00] Back to Main Menu    [S]  Search    [I]  Find by ID    ";
             // if it stops printing but has not reached 16 values yet, the file has ended.
             if (entries < MAX_PRINTS){
                 lastPage = true;
@@ -343,6 +384,29 @@ void selectItem(change_item& readInto, change_item &filter, bool a)
                 if (selection == "00") {
                     readInto.id = -1;
                     return; // back to the main menu;
+                } else if ((selection == "S") || (selection == "s")) {
+                    // replace the page with the items most similar to the search text
+                    std::cout << "Enter Search Text:" << std::endl;
+                    std::getline(std::cin, selection);
+                    entries = ChangeItemDatabase::search(page, MAX_PRINTS, selection.c_str(), filter);
+                    lastPage = true;
+
+                    cout << endl << endl;
+                    std::cout << "Search Results:" << std::endl;
+                    std::cout << "     ID       Description                   Status      Release" << std::endl;
+                    for (int i = 0; i < entries; i++)
+                    {
+                        itemReportShow(i+1, page[i]);
+                    }
+                    if (entries == 0) {
+                        std::cout << "No Similar Change Items Found." << std::endl;
+                    }
+                    std::cout << "[0]  Back    [00] Back to Main Menu    [S]  Search    [I]  Find by ID" << std::endl;
+                } else if ((selection == "I") || (selection == "i")) {
+                    // read the change item of an ID, which may be archived and so in no page
+                    if (findItemById(readInto)) {
+                        return;
+                    }
                 } else {
                     std::string input(selection);
 
@@ -355,8 +419,7 @@ void selectItem(change_item& readInto, change_item &filter, bool a)
                         } else if (reqSelection > 0 && reqSelection <= entries) { // if user entered a value between 0 and entries
                             selected = true;
                             responseProcessed = false;
-                            ChangeItemDatabase::seekToBeginning();
-                            ChangeItemDatabase::select(readInto, reqSelection, entries);
+                            readInto = page[reqSelection - 1];
                             return;
                         } else { // if user enters a different number
                             responseProcessed = true;
@@ -375,9 +438,9 @@ void selectItem(change_item& readInto, change_item &filter, bool a)
             }
         }
 
-            // if the loop never runs, the database is empty
+            // if the loop never runs, the database is empty, though it may have archived items
             readInto.id = 0;
-            std::cout << "[0]  Back    [00] Back to Main Menu" << std::endl;
+            std::cout << "[0]  Back    [00] Back to Main Menu    [I]  Find by ID" << std::endl;
             while(true){
             //std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // clearing up the stream
             std::getline(std::cin, selection);
@@ -390,6 +453,11 @@ void selectItem(change_item& readInto, change_item &filter, bool a)
                 readInto.id = -1;
                 return;
             }
+            else if((selection == "I") || (selection == "i")){
+                if(findItemById(readInto)){
+                    return;
+                }
+            }
             else{
                 std::cout << OPTION_NOT_AVAILABLE << std::endl;
             }
@@ -402,6 +470,28 @@ void selectItem(change_item& readInto, change_item &filter, bool a)
 
 //========
 
+/*
+function that prompts for a change item ID and reads that change item, from the archive if it has been archived
+returns true with the change item stored in readInto, or false if no change item has the ID
+*/
+bool findItemById(change_item& readInto)
+{
+    std::string selection;
+    std::cout << "Enter Change Item ID:" << std::endl;
+    std::getline(std::cin, selection);
+
+    change_item found;
+    if (isValidNumber(selection) && (ChangeItemDatabase::readElement(found, std::stoi(selection)) == 0))
+    {
+        readInto = found;
+        return true;
+    }
+    std::cout << "Change Item Not Found." << std::endl;
+    return false;
+}
+
+//========
+
 /*
 function that takes in a filter item and allows user to choose products from a list of all products that match the filter
 takes in a change_item that holds the selection and a filter to show relevant change items by
@@ -425,6 +515,7 @@ void selectItemUpdate(change_item& readInto, change_item &filter)
     int reqSelection = 0;
     int entries = 0;
     bool continues = false;
+    change_item page[MAX_PRINTS]; // items of the menu page being shown
 
     // loop that runs until a selection has been made.
     while (!selected)
@@ -436,7 +527,8 @@ void selectItemUpdate(change_item& readInto, change_item &filter)
         std::cout << "Select Items to Update:" << std::endl;
         std::cout << "     ID      Description                     Status       Product Name" << std::endl;
 
-        while (!ChangeItemDatabase::getNext(readInto, filter))
+        // read a page of up to 16 items, until the file ends
+        while ((entries = ChangeItemDatabase::getNextBatch(page, MAX_PRINTS, filter)) > 0)
         {
             if(continues){
                 cout << endl << endl;
@@ -444,15 +536,10 @@ void selectItemUpdate(change_item& readInto, change_item &filter)
                 std::cout << "Select Items to Update:" << std::endl;
                 std::cout << "     ID      Description                     Status       Product Name" << std::endl;
             }
-            entries = 0;
-            itemReportPrint(entries+1, readInto);
-            entries++;
-
             // populate menu
-            while (!ChangeItemDatabase::getNext(readInto, filter) && entries < MAX_PRINTS)
+            for (int i = 0; i < entries; i++)
             {
-                itemReportPrint(entries+1, readInto);
-                entries++;
+                itemReportPrint(i+1, page[i]);
             }
 
             std::cout << "[0]  Back    [00] Back to Main Menu    ";
@@ -489,8 +576,7 @@ void selectItemUpdate(change_item& readInto, change_item &filter)
                         } else if (reqSelection > 0 && reqSelection <= entries) { // if user entered a value between 0 and entries
                             selected = true;
                             responseProcessed = false;
-                            ChangeItemDatabase::seekToBeginning();
-                            ChangeItemDatabase::select(readInto, reqSelection, entries);
+                            readInto = page[reqSelection - 1];
                             return;
                         } else { // if user enters a different number
                             std::cout << OPTION_NOT_AVAILABLE << std::endl;
@@ -536,13 +622,17 @@ returns 0 for back and -1 for back to main menu
 int listOfRequesters(change_request &filterId)
 {
     // create a requester
-    change_request aRequest;
+    request_join_row page[MAX_PRINTS]; // requests and their requesters of the page being shown
     bool fileEnded = false;
     std::string selection;
     int count = 0;
     bool continues = false;
-    ChangeRequestDatabase::seekToBeginning();
-    RequesterDatabase::seekToBeginning();
+    // requesters are loaded once into the join's hash table, and the requests streamed through it
+    // if the requesters cannot be read, the list is shown empty
+    if (RequestJoin::begin(filterId))
+    {
+        fileEnded = true;
+    }
     // repeat process until user provides viable input or file is exhausted
     while (!fileEnded)
     {
@@ -550,31 +640,18 @@ int listOfRequesters(change_request &filterId)
         // print up to 16 reports:
         cout << endl << endl;
         std::cout << "Requester Name                Phone            Email" << std::endl;
-        while (!ChangeRequestDatabase::getNext(aRequest, filterId))
+        // read a page of up to 16 requests, until the file ends
+        while ((count = RequestJoin::getNextBatch(page, MAX_PRINTS)) > 0)
         {
             if(continues) {
                 cout << endl << endl;
                 std::cout << "Requester Name                Phone            Email" << std::endl;
             }
-            requester a;
-            requester afil;
-            afil.requesterId = aRequest.requesterId;
-            RequesterDatabase::getNext(a, afil);
-            count = 0;
-            requesterReportShow(count + 1, a);
-            RequesterDatabase::seekToBeginning();
-            count++;
 
-            // print 15 more times or until eof is reached
-            while (count < 16 && !ChangeRequestDatabase::getNext(aRequest, filterId))
+            // print the requester of each request
+            for (int i = 0; i < count; i++)
             {
-                requester a;
-                requester afil;
-                afil.requesterId = aRequest.requesterId;
-                RequesterDatabase::getNext(a, afil);
-                RequesterDatabase::seekToBeginning();
-                requesterReportShow(count + 1, a);
-                count++;
+                requesterReportShow(i + 1, page[i].requestedBy);
             }
 
             std::cout << "[0]  Back    [00] Back to Main Menu    ";
@@ -601,10 +678,12 @@ int listOfRequesters(change_request &filterId)
                 if (selection == "00")
                 {
                     // back to the main menu
+                    RequestJoin::end();
                     return -1;
                 }
                 else if(isValidNumber(selection)){
                     if(selection == "0"){
+                        RequestJoin::end();
                         return 0;
                     }else{
                         std::cout << OPTION_NOT_AVAILABLE << std::endl;
@@ -621,6 +700,7 @@ int listOfRequesters(change_request &filterId)
         }
         fileEnded = true;
     }
+    RequestJoin::end();
     // if the database was empty, back to the main menu  (cannot generate a report for requesters if there are no requesters)
     std::cout << "[0]  Back    [00] Back to Main Menu" << std::endl;
     
@@ -1649,30 +1729,28 @@ function that prints out all relevant items in a list , based on the filter
 */
 
 int listItems(change_item& filter){
-    change_item readInto;
+    change_item page[MAX_PRINTS]; // items of the page being shown
     std::string selected;
     int entries = 0;
     bool fileEnded = false;
     bool processing = true;
     bool continues = false;
+    // unresolved change items of a product are read from the product's list of them instead of filtering the file
+    bool unresolved = (filter.status == (unreviewed | reviewed | inProgress)) && (filter.priority == -1) && !strcmp(filter.release, "") && strcmp(filter.product, "");
     ChangeItemDatabase::seekToBeginning();
     while(true){
     cout << endl << endl;
     std::cout << "Product: " << filter.product << std::endl;
     std::cout << "ID      Description                     Status       Priority  Release" << std::endl;
-    while(!ChangeItemDatabase::getNext(readInto, filter)){
+    // read a page of up to 16 items, until the file ends
+    while((entries = (unresolved ? ChangeItemDatabase::getNextUnresolved(page, MAX_PRINTS, filter.product) : ChangeItemDatabase::getNextBatch(page, MAX_PRINTS, filter))) > 0){
         if(continues){
         cout << endl << endl;
         std::cout << "Product: " << filter.product << std::endl;
         std::cout << "ID      Description                     Status       Priority  Release" << std::endl;
         }
-        entries = 0;
-        itemReportPrint(-1, readInto);
-        entries++;
-
-        while(!ChangeItemDatabase::getNext(readInto, filter) && entries < MAX_PRINTS){
-            itemReportPrint(-1, readInto);
-            entries++;
+        for(int i = 0; i < entries; i++){
+            itemReportPrint(-1, page[i]);
         }
 
         std::cout << "[0]  Back    [00] Back to Main Menu    " ;
@@ -1684,6 +1762,7 @@ int listItems(change_item& filter){
             std::cout << "[C]  Next Page" << std::endl;
         }
 
+        processing = true;
         while(processing){
             //std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // clearing up the stream
             std::getline(std::cin, selected);
@@ -1898,6 +1977,190 @@ bool generateReportItems()
 }
 
 
+/*
+function that prints the number of change items of each product by status and priority
+only the product file and the change item tallies are read, so it does not slow as change items are added
+*/
+bool generateReportSummary()
+{
+    // only runs if the module has been initialized
+    if (!initialized)
+    {
+        return true;
+    }
+
+    const char* priorities[] = {"Lowest", "Low", "Middle", "High", "Highest"};
+
+    cout << endl << endl;
+    cout << "Change Item Summary:" << endl;
+    cout << "Open change items (unreviewed, reviewed or in progress) by priority, and closed change items" << endl;
+    cout << endl;
+    cout << std::left << std::setw(MAX_PRODUCT_NAME_SIZE + 1) << "Product";
+    for (int priority = lowest; priority <= highest; priority++)
+    {
+        cout << std::right << std::setw(9) << priorities[priority];
+    }
+    cout << std::setw(9) << "Open" << std::setw(9) << "Done" << std::setw(11) << "Cancelled" << endl;
+
+    // one row per product
+    product currentProduct;
+    change_item filter;
+    int64_t totals[highest + 4] = {}; // each priority, then open, done and cancelled, over every product
+    Product::seekToBeginning();
+    while (Product::getNext(currentProduct) == 0)
+    {
+        strncpy(filter.product, currentProduct.name, MAX_PRODUCT_NAME_SIZE);
+        int64_t counts[highest + 4];
+        filter.status = (unreviewed | reviewed | inProgress);
+        for (int priority = lowest; priority <= highest; priority++)
+        {
+            filter.priority = priority;
+            counts[priority] = ChangeItemDatabase::countItems(filter);
+        }
+        filter.priority = -1;
+        counts[highest + 1] = ChangeItemDatabase::countItems(filter);
+        filter.status = done;
+        counts[highest + 2] = ChangeItemDatabase::countItems(filter);
+        filter.status = cancelled;
+        counts[highest + 3] = ChangeItemDatabase::countItems(filter);
+
+        cout << std::left << std::setw(MAX_PRODUCT_NAME_SIZE + 1) << currentProduct.name << std::right;
+        for (int i = 0; i < highest + 4; i++)
+        {
+            cout << std::setw(i == highest + 3 ? 11 : 9) << counts[i];
+            totals[i] += counts[i];
+        }
+        cout << endl;
+    }
+    Product::seekToBeginning();
+
+    cout << std::left << std::setw(MAX_PRODUCT_NAME_SIZE + 1) << "Total" << std::right;
+    for (int i = 0; i < highest + 4; i++)
+    {
+        cout << std::setw(i == highest + 3 ? 11 : 9) << totals[i];
+    }
+    cout << std::left << endl;
+
+    // wait for the user to go back
+    while (1)
+    {
+        cout << endl;
+        cout << "[0]  Back" << endl;
+        if (makeSelection() == '0')
+        {
+            return false;
+        }
+        cout << OPTION_NOT_AVAILABLE << endl;
+    }
+}
+
+
+/*
+function that prints the change requests dated from a first to a last day, in order of date
+the requests are read through the request date index, so only the requests of the range are read
+*/
+bool generateReportRequestsByDate()
+{
+    // only runs if the module has been initialized
+    if (!initialized)
+    {
+        return true;
+    }
+
+    // get the first and last day of the range
+    char days[2][DATE_SIZE];
+    const char* prompts[2] = {"Enter First Date:", "Enter Last Date:"};
+    for (int i = 0; i < 2; i++)
+    {
+        while (1)
+        {
+            cout << endl << endl;
+            cout << "Change Requests by Date:" << endl;
+            cout << "[0]  Back" << endl;
+            cout << endl;
+            cout << "Field Requirements:" << endl;
+            cout << "(YYYY-MM-DD: Y, M, D, are numeric characters, include dashes)" << endl;
+            cout << prompts[i] << endl;
+
+            int returnFlag = getDateInput(days[i]);
+            if (returnFlag == -1) // user selected back
+            {
+                return false;
+            }
+            if (returnFlag == 1) // if input is good
+            {
+                break;
+            }
+            while (1) // handle errors
+            {
+                returnFlag = getYNInput(); // prompt for y/n repsonse
+                if (returnFlag == 0) // if n return to main menu
+                {
+                    return true;
+                }
+                if (returnFlag == 1) // if y repeat current step
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    // one page of requests at a time, until the range ends
+    change_request page[MAX_PRINTS];
+    char release[MAX_RELEASE_ID_SIZE];
+    ChangeRequestDatabase::seekToBeginning();
+    while (1)
+    {
+        int entries = ChangeRequestDatabase::getNextByDate(page, MAX_PRINTS, days[0], days[1]);
+        cout << endl << endl;
+        cout << "Change Requests from " << days[0] << " to " << days[1] << ":" << endl;
+        cout << "Date         Item ID  Requester ID  Release" << endl;
+        for (int i = 0; i < entries; i++)
+        {
+            strncpy(release, page[i].release, MAX_RELEASE_ID_SIZE - 1);
+            release[MAX_RELEASE_ID_SIZE - 1] = '\0';
+            cout << std::left << std::setw(DATE_SIZE + 2) << page[i].requestDate
+                << std::right << std::setw(7) << page[i].changeItemId << std::setw(14) << page[i].requesterId
+                << std::left << "  " << release << endl;
+        }
+        if (entries == 0)
+        {
+            cout << "No more change requests in the range." << endl;
+        }
+
+        // a full page may be followed by more requests
+        bool fileEnded = (entries < MAX_PRINTS);
+        cout << "[0]  Back    [00] Back to Main Menu    ";
+        if (!fileEnded)
+        {
+            cout << "[C]  Next Page";
+        }
+        cout << endl;
+
+        string selected;
+        while (1)
+        {
+            getline(cin, selected);
+            if (selected == "00")
+            {
+                ChangeRequestDatabase::seekToBeginning();
+                return true;
+            }
+            if (selected == "0")
+            {
+                ChangeRequestDatabase::seekToBeginning();
+                return false;
+            }
+            if (((selected == "C") || (selected == "c")) && !fileEnded)
+            {
+                break;
+            }
+            cout << OPTION_NOT_AVAILABLE << endl;
+        }
+    }
+}
+
 /*
 function that displays all change items and allow user to query any that they wish to
 returns true if they want to go back to main menu and false if they want to go back
@@ -1991,7 +2254,7 @@ bool addProductControl()
 
             // check for uniqueness
             strncpy(newProduct.name, productName, MAX_PRODUCT_NAME_SIZE);
-            if (Product::getNext(tempProduct, newProduct) == 0) // if we find an element with same key in database
+            if (Product::findProduct(tempProduct, productName) == 0) // if we find an element with same key in database
             {
                 if (strlen(productName) != 0)
                 {
@@ -2190,7 +2453,7 @@ bool addReleaseControl()
  
             // check uniqueness
             strncpy(newRelease.releaseId, releaseID, MAX_RELEASE_ID_SIZE);
-            if (Release::getNext(tempRelease, newRelease) == 0) // if we find an element with same name in database
+            if (Release::findRelease(tempRelease, newRelease.name, releaseID) == 0) // if we find an element with same name in database
             {
                 if (strlen(releaseID) != 0)
                 {
@@ -2259,6 +2522,12 @@ bool addReleaseControl()
                         }
                     }
                 }
+                // assert the date is a date of the calendar, as dates are stored as days
+                if ((returnFlag != 0) && (dateToDays(releaseDate) == NO_DATE))
+                {
+                    cout << DATE_NOT_IN_CALENDAR << endl;
+                    returnFlag = 0;
+                }
             }
             if (returnFlag == 0) // if error encountered
             {
@@ -2344,6 +2613,7 @@ carries out the process to add a new request
 */
 bool addRequestControl()
 {
+    RequestTransaction::begin();
     RequesterDatabase::seekToBeginning();
     ChangeItemDatabase::seekToBeginning();
     ChangeRequestDatabase::seekToBeginning();
@@ -2357,6 +2627,9 @@ bool addRequestControl()
     int menuIndex;
     int returnFlag;
     bool nextPageLegal;
+    bool showSimilar = 1; // true while the change items similar to the description are listed
+    bool searchingRequesters = 0; // true while the requesters whose name starts with requesterPrefix are listed
+    char requesterPrefix[MAX_REQUESTER_NAME_SIZE] = "";
 
     // containers for user input and menu items
     int userSelection;
@@ -2371,8 +2644,6 @@ bool addRequestControl()
     change_item newItem;
     change_item pairedItem;
     change_item tempItem;
-    bool savedItem = false;
-    bool savedRequest = false;
 
     // input collection to save to new objects
     char requesterName[MAX_REQUESTER_NAME_SIZE];
@@ -2395,12 +2666,18 @@ bool addRequestControl()
             cout << endl << endl;
             cout << "Handle Change Request:" << endl;
             cout << "Select Requester:" << endl;
+            if (searchingRequesters)
+            {
+                cout << "Names Starting With \"" << requesterPrefix << "\":" << endl;
+            }
             cout << "     NAME                            Phone            Email" << endl;
             // prints list menu
             while (1)
             {
-                // print list of requesters. on failure to print, or filling a page, get user input
-                if (RequesterDatabase::getNext(tempRequester) == 0)
+                // print list of requesters, in alphabetical order when searching
+                // on failure to print, or filling a page, get user input
+                returnFlag = searchingRequesters ? RequesterDatabase::getNextByName(tempRequester) : RequesterDatabase::getNext(tempRequester);
+                if (returnFlag == 0)
                 {
                     menuIndex++;
                     printIndex(menuIndex);
@@ -2410,12 +2687,12 @@ bool addRequestControl()
                 }
                 else // failed to get an element
                 {
-                    cout << "[0]  Back    [N]  Create New Requester" << endl;
+                    cout << "[0]  Back    [N]  Create New Requester    [S]  Search by Name" << endl;
                     break;
                 }
                 if (menuIndex == 16) // page is full
                 {
-                    cout << "[0]  Back    [C]  Next Page    [N] Create New Requester" << endl;
+                    cout << "[0]  Back    [C]  Next Page    [N] Create New Requester    [S]  Search by Name" << endl;
                     nextPageLegal = 1; // next page is a legal menu option for user selection
                     break;
                 }
@@ -2429,15 +2706,24 @@ bool addRequestControl()
                 RequesterDatabase::seekToBeginning();
                 RequesterDatabase::select(relatedRequester, userSelection, menuIndex);
                 newRequest.requesterId = relatedRequester.requesterId; // save foreign key linking product and release
+                RequestTransaction::begin(); // drop a new requester staged before going back
                 step = ChooseProduct;
+                searchingRequesters = 0;
                 RequesterDatabase::seekToBeginning(); // clean up for future calls
                 break;
             }
             else if (userSelection < 1) // special cases
             {
-                if (userSelection == -1) // user selected back return to previous menu
+                if (userSelection == -1) // user selected back
                 {
                     RequesterDatabase::seekToBeginning(); // clean up for future calls
+                    // leaving a search returns to the list of all requesters
+                    if (searchingRequesters)
+                    {
+                        searchingRequesters = 0;
+                        break;
+                    }
+                    // return to previous menu
                     return 0;
                 }
                 if ((userSelection == -3) && nextPageLegal)
@@ -2448,13 +2734,34 @@ bool addRequestControl()
                 if (userSelection == -4)
                 {
                     // user selected create new 
+                    searchingRequesters = 0;
                     step = InputRequesterName;
                 }
+                if (userSelection == -5)
+                {
+                    // user selected search, list the requesters whose name starts with the text entered
+                    cout << "Enter Start of Requester's Name:" << endl;
+                    if (getStringInput(MAX_REQUESTER_NAME_SIZE, requesterPrefix) == 1)
+                    {
+                        searchingRequesters = 1;
+                        RequesterDatabase::seekToName(requesterPrefix);
+                    }
+                    else
+                    {
+                        searchingRequesters = 0;
+                        RequesterDatabase::seekToBeginning();
+                    }
+                    break;
+                }
             }
 
             // if invalid input, reset menu
             cout << OPTION_NOT_AVAILABLE << endl;
             RequesterDatabase::seekToBeginning();
+            if (searchingRequesters)
+            {
+                RequesterDatabase::seekToName(requesterPrefix);
+            }
             break;
 
         case (InputRequesterName):
@@ -2682,8 +2989,7 @@ bool addRequestControl()
                 if (returnFlag == 1) // user confirms creation
                 {
                     // check uniqueness
-                    returnFlag = RequesterDatabase::getNext(tempRequester, relatedRequester);
-                    RequesterDatabase::seekToBeginning();
+                    returnFlag = RequesterDatabase::findByEmail(tempRequester, relatedRequester.email);
                     if (returnFlag == 0) // requester already exists
                     {
                         cout << REQEUSTER_UNIQUENESS_ERROR << endl; // encounter error
@@ -2692,7 +2998,8 @@ bool addRequestControl()
                             returnFlag = getYNInput(); // prompt for y/n repsonse
                             if (returnFlag == 1) // if y continue to next step with existing requester
                             {
-                                newRequest.requesterId = tempRequester.requesterId; // get requesterId from existing element
+                                relatedRequester = tempRequester; // get requesterId from existing element
+                                RequestTransaction::begin(); // drop a new requester staged before going back
                                 step = ChooseProduct;
                                 break;
                             }
@@ -2706,33 +3013,11 @@ bool addRequestControl()
                     }
                     else if (returnFlag == 1) // requester is new
                     {
-                        // get Id number
+                        // get Id number, the requester is saved with the request
                         relatedRequester.requesterId = RequesterDatabase::getRequesterCount() + 1;
-                        newRequest.requesterId = relatedRequester.requesterId;
-                        // save requester
-                        returnFlag = RequesterDatabase::writeElement(relatedRequester);
-                        if (returnFlag == 1) // if write failed
-                        {
-                            cout << SAVE_ERROR << endl;
-                            while (1) // handle error
-                            {
-                                returnFlag = getYNInput(); // prompt for y/n repsonse
-                                if (returnFlag == 1) // if y retry
-                                {
-                                    break;
-                                }
-                                else if (returnFlag == 0) // if n return to main menu
-                                {
-                                    step = Complete;
-                                    break;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            cout << "Requester Added" << endl;
-                            step = ChooseProduct;
-                        }
+                        RequestTransaction::stageRequester(relatedRequester);
+                        cout << "Requester Added" << endl;
+                        step = ChooseProduct;
                     }
                 }
                 else if (returnFlag == 0)// if user denies creation of requester
@@ -2912,6 +3197,12 @@ bool addRequestControl()
                         }
                     }
                 }
+                // assert the date is a date of the calendar, as dates are stored as days
+                if ((returnFlag != 0) && (dateToDays(requestDate) == NO_DATE))
+                {
+                    cout << DATE_NOT_IN_CALENDAR << endl;
+                    returnFlag = 0;
+                }
             }
             if (returnFlag == 0) // if encountered errors
             {
@@ -2972,6 +3263,7 @@ bool addRequestControl()
             else // if input is good
             {
                 strncpy(newItem.description, requestDescription, MAX_DESCRIPTION_SIZE); // save data
+                showSimilar = 1; // start with the change items similar to the description
                 step = ChooseChangeItem; // continue to next step
             }
             break;
@@ -2984,8 +3276,31 @@ bool addRequestControl()
 
             nextPageLegal = 0;
             menuIndex = 0;
+            // prints the change items of the product most similar to the description first
+            // so an existing change item is found without paging through the product
+            if (showSimilar)
+            {
+                change_item filter;
+                strncpy(filter.product, relatedProduct.name, MAX_PRODUCT_NAME_SIZE);
+                change_item similar[MAX_PRINTS];
+                menuIndex = ChangeItemDatabase::search(similar, MAX_PRINTS, requestDescription, filter);
+                for (int i = 0; i < menuIndex; i++)
+                {
+                    printIndex(i + 1);
+                    printf("%-*s  %*i\n", MAX_DESCRIPTION_SIZE-1, similar[i].description, 6, similar[i].id);
+                }
+                if (menuIndex > 0)
+                {
+                    cout << "[0]  Back    [C]  All Change Items of Product    [N]  Create New Change Item" << endl;
+                    nextPageLegal = 1; // listing all change items is a legal menu option for user selection
+                }
+                else // nothing similar, list all change items of the product
+                {
+                    showSimilar = 0;
+                }
+            }
             // prints menu
-            while (1)
+            while (!showSimilar)
             {
                 change_item filter;
                 strncpy(filter.product, relatedProduct.name, MAX_PRODUCT_NAME_SIZE);
@@ -3035,32 +3350,13 @@ bool addRequestControl()
                 }
                 ChangeRequestDatabase::seekToBeginning();
 
-
-                if (ChangeRequestDatabase::writeElement(newRequest) == 1) // save element
-                {
-                    // if write fails
-                    cout << SAVE_ERROR << endl; // encounter error
-                    while (1) // handle error
-                    {
-                        returnFlag = getYNInput(); // prompt for y/n repsonse
-                        if (returnFlag == 1) // if y repeat current step
-                        {
-                            ChangeItemDatabase::seekToBeginning();
-                            break; 
-                        }
-                        else if (returnFlag == 0)// if n return to main menu
-                        {
-                            step = Complete;
-                            break;
-                        }
-                    }
-                    break;
-                }
-                else
+                // save request, and the requester if it is new
+                RequestTransaction::stageRequest(newRequest);
+                if (commitRequest() == 0)
                 {
                     cout << "Change Request Added" << endl;
-                    step = Complete;
                 }
+                step = Complete;
                 break;
             }
             else if (userSelection < 1) // special cases
@@ -3074,6 +3370,12 @@ bool addRequestControl()
                 }
                 if ((userSelection == -3) && nextPageLegal) 
                 {
+                    // after the similar change items, list all change items of the product from the beginning
+                    if (showSimilar)
+                    {
+                        showSimilar = 0;
+                        ChangeItemDatabase::seekToBeginning();
+                    }
                     // restart this step printing a new page of the menu
                     break;
                 }
@@ -3136,66 +3438,16 @@ bool addRequestControl()
 
             if (returnFlag == 0) // try to save the new change item and request
             {
-                if (!savedItem)
+                // save item and request together, and the requester if it is new
+                // the request gets the id of the new item at commit
+                RequestTransaction::stageItem(newItem);
+                RequestTransaction::stageRequest(newRequest);
+                if (commitRequest() == 0)
                 {
-                    if (ChangeItemDatabase::writeElement(newItem) == 1) // save element
-                    {
-                        // if write fails
-                        cout << SAVE_ERROR << endl; // encounter error
-                        while (1) // handle error
-                        {
-                            returnFlag = getYNInput(); // prompt for y/n repsonse
-                            if (returnFlag == 1) // if y repeat current step
-                            {
-                                break; 
-                            }
-                            else if (returnFlag == 0)// if n return to main menu
-                            {
-                                step = Complete;
-                                break;
-                            }
-                        }
-                    }
-                    else
-                    {
-                        cout << "Change Item Added" << endl;
-                        savedItem = true;
-                    }
-                }
-
-                if (savedItem && ! savedRequest)
-                {
-                    newRequest.changeItemId = ChangeItemDatabase::getChangeItemCount();
-                    if (ChangeRequestDatabase::writeElement(newRequest) == 1) // save element
-                    {
-                        // if write fails
-                        cout << SAVE_ERROR << endl; // encounter error
-                        while (1) // handle error
-                        {
-                            returnFlag = getYNInput(); // prompt for y/n repsonse
-                            if (returnFlag == 1) // if y repeat current step
-                            {
-                                break; 
-                            }
-                            else if (returnFlag == 0)// if n return to main menu
-                            {
-                                step = Complete;
-                                break;
-                            }
-                        }
-                    }
-                    else
-                    {
-                        cout << "Change Request Added" << endl;
-                        savedRequest = true;
-                    }
-                }
-
-                if (savedItem && savedRequest)
-                {
-                    // completed successfully
-                    step = Complete;
+                    cout << "Change Item Added" << endl;
+                    cout << "Change Request Added" << endl;
                 }
+                step = Complete;
             }
             break;
 
@@ -3217,6 +3469,29 @@ bool addRequestControl()
 //==================
 // implementation of helper functions for product management and handling a request
 
+// commits the staged request transaction, retrying on failure until it succeeds or the user gives up
+// the staged records are only staged once, so a retry never writes a record twice
+int commitRequest()
+{
+    while (RequestTransaction::commit() == 1)
+    {
+        cout << SAVE_ERROR << endl; // encounter error
+        while (1) // handle error
+        {
+            int returnFlag = getYNInput(); // prompt for y/n repsonse
+            if (returnFlag == 1) // if y retry the commit
+            {
+                break;
+            }
+            else if (returnFlag == 0) // if n return to main menu
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
 // prints the index formatted as "[#]  " or "[##] " based on numbr of characters needed to print number
 void printIndex(int index)
 {
@@ -3306,6 +3581,10 @@ int getIndexInput(int menuCount)
         {
             return -4;
         }
+        else if ((firstChar == 'S') || (firstChar == 's'))
+        {
+            return -5;
+        }
     }
 
     // check validity of input
@@ -3385,3 +3664,21 @@ int getStringInput(const int MAX_SIZE, char* readInto)
     strncpy(readInto, line.c_str(), MAX_SIZE);
     return 1;
 }
+
+// function to collect a date of the calendar
+// implemented by getting string input and converting it to days
+int getDateInput(char* readInto)
+{
+    int returnFlag = getStringInput(DATE_SIZE, readInto);
+    if (returnFlag != 1)
+    {
+        return returnFlag;
+    }
+    // dates are stored as days, so only a date of the calendar can be ranged over
+    if (dateToDays(readInto) == NO_DATE)
+    {
+        cout << DATE_NOT_IN_CALENDAR << endl;
+        return 0;
+    }
+    return 1;
+}
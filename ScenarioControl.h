@@ -3,6 +3,19 @@ description:
 The scenario control module is the module that prompts the user for input and calls the
 functions from the other modules.
 version history:
+ver11 -26/10/17
+    -added generateReportRequestsByDate and getDateInput
+ver10 -26/10/17
+    -added findItemById
+ver9 -26/10/17
+    -includes RequestJoin
+ver8 -26/10/17
+    -added generateReportSummary
+ver7 -26/10/17
+    -getIndexInput returns -5 for 'search'
+ver6 -26/10/17
+    -added commitControl
+    -includes RequestTransaction, added commitRequest
 ver5 - 24/07/31, updated by Puja Shah, Wah Paw Hse, and Nicaolao Barreto
 ver4 - 24/07/31, updated by Puja Shah, Wah Paw Hse, and Nicolao Barreto
 ver3 - 24/07/30, update by Puja Shah, Wah Paw Hse, and Nicolao Barreto
@@ -20,6 +33,9 @@ ver1 -24/07/02, original by Wah Paw Hser
 #include "Product.h"
 #include "Release.h"
 #include "Requester.h"
+#include "RequestJoin.h"
+#include "RequestTransaction.h"
+#include "WriteAheadLog.h"
 #include "Constants.h"
 #include <stdint.h>
 
@@ -40,6 +56,13 @@ postcondition: the Scenario Control module is uninitialized.
 exceptions raised: none.
 */
 
+void commitControl();
+/* makes every write made so far durable.
+precondition: the Scenario Control module must already be initialized.
+postcondition: the writes are committed in the write ahead log.
+exceptions raised: none.
+*/
+
 //==================
 // database management processes
 
@@ -99,6 +122,25 @@ exceptions raised: throws an exception if the user enters an option that does no
 during the input collection process.
 */
 
+bool generateReportSummary();
+/* this is a function that generates a report of the number of change items of each product,
+open change items by priority and closed change items by status.
+it reads only the product file and the change item tallies, never the change item file.
+precondition: none.
+postcondition: none.
+exceptions raised: throws an exception if the user enters an option that does not exist
+during the input collection process.
+*/
+
+bool generateReportRequestsByDate();
+/* this is a function that generates a report of the change requests dated from a first to a last day,
+in order of date, a page at a time. the requests are found through the request date index.
+precondition: none.
+postcondition: none.
+exceptions raised: throws an exception if the user enters an option that does not exist or a date
+that is not a date of the calendar during the input collection process.
+*/
+
 bool queryItemControl();
 /*this is a function that allows the user to choose a change item and view all details for it.
 preconditions: none
@@ -126,6 +168,14 @@ postcondition: the database remains unchanged
 exceptions raised: options does not exist and character type invalid
 */
 
+bool findItemById(change_item& readInto);
+/* this function prompts the user for a change item ID and reads the change item of that ID, archived change items included
+returns true if the change item was found and stored in readInto, false otherwise
+precondition: none
+postcondition: the database remains unchanged
+exceptions raised: change item not found
+*/
+
 void selectItemUpdate(change_item& readInto, change_item &filter);
 
 int listOfRequesters(change_request &filterId);
@@ -223,6 +273,14 @@ exceptions raised: none
 */
 
 
+int commitRequest();
+/* commits the records staged in RequestTransaction, asking the user whether to retry on failure
+preconditions: a change request is staged
+postconditions: the staged records are saved, unless the user chose not to retry
+returns 0 if the records were saved, 1 otherwise
+exceptions raised: none
+*/
+
 int listItems(change_item& filter);
 /* generates a report of change items filtered by the user. Allows users to go to the next page, if there is one
 preconditions: none
@@ -272,6 +330,7 @@ returns:
     -2 for 'back to menu'
     -3 for 'next page'
     -4 for 'new element'
+    -5 for 'search'
     0 on failure
 */
 
@@ -300,4 +359,17 @@ returns:
     1 on good input
 */
 
+int getDateInput(
+    /* variable to read the YYYY-MM-DD date to, a char array of DATE_SIZE characters
+    used as output mutates */
+    char* readIn
+);
+/* description:
+    UI collection for date input, the date must be a date of the calendar
+returns:
+    -1 on 'back'
+    0 on failure
+    1 on good input
+*/
+
 #endif
@@ -0,0 +1,792 @@
+/* StorageFile.cpp
+description:
+Module implementing database file access.
+
+the stream backend reads and writes through a file stream, and only seeks when the requested
+offset is not where the stream is already positioned.
+reads are served from a read ahead buffer, which is refilled with one large read of the bytes
+following a requested range that it does not hold. sequential scans therefore only access the
+file once per buffer, and only seek when jumping to another part of the file.
+writes are copied into the buffer when they overlap it, so it never holds stale bytes.
+
+the mapped backend maps the whole file into memory and copies directly to and from the mapped pages.
+views point into the mapped pages or the read ahead buffer, so a scan can check records where they
+were read into memory, without copying them.
+the mapping is reserved larger than the file, so appends only need to extend the file, and the
+mapping is only remade when an append passes the end of the reserved length.
+
+files opened while the write ahead log is initialized are logged. their writes are appended to
+the log and merged into a map of held writes instead of being written to the file. reads copy the
+stored part of a range from the file and then overlay the held writes. a checkpoint writes the held
+writes to the file in offset order, so appends held since the last checkpoint reach the file as one write.
+
+version history:
+ver6 -26/10/17
+        -syncFile and replaceFile, syncing the directory after the rename on POSIX systems
+ver5 -26/10/17
+        -held writes saved at the first write after saveHeldWrites, and restored by restoreHeldWrites
+ver4 -26/10/17
+        -views of ranges, in place where the range is mapped or buffered
+ver3 -26/10/17
+        -logged files and checkpoints
+ver2 -26/10/17
+        -read ahead buffer for the stream backend
+ver1 -26/10/17
+        -stream and memory mapped backends
+*/
+
+#ifndef STORAGE_FILE_CPP
+#define STORAGE_FILE_CPP
+
+//==================
+
+#include "StorageFile.h"
+#include "WriteAheadLog.h"
+#include <cstdio>
+#include <fstream>
+#include <cstring>
+#include <iterator>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//==================
+
+const int64_t MINIMUM_MAPPING_LENGTH = 1 << 20; // smallest length reserved for a mapping
+
+//==================
+
+StorageFile::StorageFile()
+{
+    backend = streamBackend;
+    size = 0;
+    fileSize = 0;
+    opened = 0;
+    logged = 0;
+    savePending = 0;
+    saved = 0;
+    savedSize = 0;
+    streamPosition = -1;
+    readAhead = nullptr;
+    readAheadCapacity = 0;
+    readAheadOffset = 0;
+    readAheadLength = 0;
+    descriptor = -1;
+    mapping = nullptr;
+    mappingLength = 0;
+
+    setReadAheadSize(DEFAULT_READ_AHEAD_SIZE);
+}
+
+//========
+
+StorageFile::~StorageFile()
+{
+    if (opened)
+    {
+        close();
+    }
+    delete[] readAhead;
+}
+
+//========
+
+// opens the file with the chosen backend, creating the file when none exists
+bool StorageFile::open(const char* filename, StorageBackend newBackend)
+{
+    // fail if already open
+    if (opened)
+    {
+        return 1;
+    }
+
+#ifdef _WIN32
+    // no memory mapped backend, use stream
+    newBackend = streamBackend;
+#endif
+
+    backend = newBackend;
+
+    if (backend == streamBackend)
+    {
+        stream.open(filename, std::ios::in | std::ios::out | std::ios::binary);
+        if (!stream.is_open()) // if file not found create the file
+        {
+            stream.clear();
+            std::ofstream createFile(filename, std::ios::out | std::ios::binary);
+            createFile.close();
+            stream.open(filename, std::ios::in | std::ios::out | std::ios::binary);
+        }
+
+        if (!stream.is_open()) // cannot create file
+        {
+            return 1;
+        }
+
+        stream.seekg(0, std::ios::end);
+        fileSize = stream.tellg();
+        streamPosition = -1;
+        readAheadLength = 0;
+    }
+#ifndef _WIN32
+    else
+    {
+        descriptor = ::open(filename, O_RDWR | O_CREAT, 0644);
+        if (descriptor < 0)
+        {
+            return 1;
+        }
+
+        struct stat fileStatus;
+        if (fstat(descriptor, &fileStatus))
+        {
+            ::close(descriptor);
+            descriptor = -1;
+            return 1;
+        }
+        fileSize = fileStatus.st_size;
+
+        mapping = nullptr;
+        mappingLength = 0;
+        if (remap(fileSize))
+        {
+            ::close(descriptor);
+            descriptor = -1;
+            return 1;
+        }
+    }
+#endif
+
+    this->filename = filename;
+    size = fileSize;
+    opened = 1;
+
+    // log writes when the write ahead log is in use
+    logged = WriteAheadLog::isInitialized();
+    if (logged)
+    {
+        WriteAheadLog::addFile(this);
+    }
+    return 0;
+}
+
+//========
+
+// releases the stream or the mapping
+bool StorageFile::close()
+{
+    // fail if not open
+    if (!opened)
+    {
+        return 1;
+    }
+
+    // changes held in memory must reach the file before it is closed
+    if (logged)
+    {
+        if (!heldWrites.empty())
+        {
+            WriteAheadLog::checkpoint();
+        }
+        WriteAheadLog::removeFile(this);
+        discardSavedWrites();
+        logged = 0;
+    }
+
+    if (backend == streamBackend)
+    {
+        stream.close();
+    }
+#ifndef _WIN32
+    else
+    {
+        munmap(mapping, mappingLength);
+        ::close(descriptor);
+        mapping = nullptr;
+        mappingLength = 0;
+        descriptor = -1;
+    }
+#endif
+
+    opened = 0;
+    size = 0;
+    fileSize = 0;
+    return 0;
+}
+
+//========
+
+bool StorageFile::isOpen()
+{
+    return opened;
+}
+
+//========
+
+int64_t StorageFile::getSize()
+{
+    return size;
+}
+
+//========
+
+// copies a range of the file into readInto, including changes held in memory
+bool StorageFile::read(int64_t offset, void* readInto, int64_t length)
+{
+    // fail if not open or if range is outside of file
+    if (!opened || (offset < 0) || (offset + length > size))
+    {
+        return 1;
+    }
+
+    if (heldWrites.empty())
+    {
+        return readFile(offset, readInto, length);
+    }
+
+    // read the part of the range already stored in the file
+    int64_t storedLength = fileSize - offset;
+    if (storedLength > length)
+    {
+        storedLength = length;
+    }
+    if ((storedLength > 0) && readFile(offset, readInto, storedLength))
+    {
+        return 1;
+    }
+
+    // overlay every held write overlapping the range, starting from the last one at or before offset
+    std::map<int64_t, std::vector<char>>::iterator held = heldWrites.upper_bound(offset);
+    if (held != heldWrites.begin())
+    {
+        held--;
+    }
+    for (; (held != heldWrites.end()) && (held->first < offset + length); held++)
+    {
+        int64_t heldEnd = held->first + static_cast<int64_t>(held->second.size());
+        int64_t overlapStart = (offset > held->first) ? offset : held->first;
+        int64_t overlapEnd = (offset + length < heldEnd) ? offset + length : heldEnd;
+        if (overlapStart < overlapEnd)
+        {
+            memcpy(static_cast<char*>(readInto) + (overlapStart - offset), held->second.data() + (overlapStart - held->first), overlapEnd - overlapStart);
+        }
+    }
+    return 0;
+}
+
+//========
+
+// views the range in place unless it is not yet in the file, or a held write overlaps it
+const char* StorageFile::view(int64_t offset, int64_t length)
+{
+    // fail if not open or if range is outside of file
+    if (!opened || (offset < 0) || (length <= 0) || (offset + length > size))
+    {
+        return nullptr;
+    }
+
+    bool inPlace = (offset + length <= fileSize);
+    if (inPlace && !heldWrites.empty())
+    {
+        // the held write starting last at or before offset, and the first one after it
+        std::map<int64_t, std::vector<char>>::const_iterator held = heldWrites.upper_bound(offset);
+        if ((held != heldWrites.end()) && (held->first < offset + length))
+        {
+            inPlace = 0;
+        }
+        if (held != heldWrites.begin())
+        {
+            held--;
+            if (held->first + static_cast<int64_t>(held->second.size()) > offset)
+            {
+                inPlace = 0;
+            }
+        }
+    }
+
+    if (inPlace)
+    {
+        const char* stored = storedView(offset, length);
+        if (stored != nullptr)
+        {
+            return stored;
+        }
+    }
+
+    // copy ranges that cannot be viewed in place
+    viewCopy.resize(length);
+    if (read(offset, viewCopy.data(), length))
+    {
+        return nullptr;
+    }
+    return viewCopy.data();
+}
+
+//========
+
+// copies a range stored in the file into readInto
+bool StorageFile::readFile(int64_t offset, void* readInto, int64_t length)
+{
+    // ranges larger than the buffer are read directly
+    bool buffered = (offset >= readAheadOffset) && (offset + length <= readAheadOffset + readAheadLength);
+    if ((backend == streamBackend) && !buffered && (length >= readAheadCapacity))
+    {
+        // only seek when not already positioned at offset
+        if (streamPosition != offset)
+        {
+            stream.seekg(offset);
+        }
+        stream.read(static_cast<char*>(readInto), length);
+        if (!stream.good())
+        {
+            stream.clear();
+            streamPosition = -1;
+            return 1;
+        }
+        streamPosition = offset + length;
+        return 0;
+    }
+
+    const char* stored = storedView(offset, length);
+    if (stored == nullptr)
+    {
+        return 1;
+    }
+    memcpy(readInto, stored, length);
+    return 0;
+}
+
+//========
+
+// points into the mapping, or into the read ahead buffer after refilling it with the range if needed
+// nullptr if the range is larger than the buffer or cannot be read
+const char* StorageFile::storedView(int64_t offset, int64_t length)
+{
+    if (backend == mappedBackend)
+    {
+        return mapping + offset;
+    }
+
+    // serve read from read ahead buffer when it holds the range
+    if ((offset >= readAheadOffset) && (offset + length <= readAheadOffset + readAheadLength))
+    {
+        return readAhead + (offset - readAheadOffset);
+    }
+
+    if (length >= readAheadCapacity)
+    {
+        return nullptr;
+    }
+
+    // only seek when not already positioned at offset
+    if (streamPosition != offset)
+    {
+        stream.seekg(offset);
+    }
+
+    // refill buffer with the range and the bytes following it
+    int64_t fillLength = fileSize - offset;
+    if (fillLength > readAheadCapacity)
+    {
+        fillLength = readAheadCapacity;
+    }
+    stream.read(readAhead, fillLength);
+
+    // assert the read succeeded
+    if (!stream.good())
+    {
+        stream.clear();
+        streamPosition = -1;
+        readAheadLength = 0;
+        return nullptr;
+    }
+
+    streamPosition = offset + fillLength;
+    readAheadOffset = offset;
+    readAheadLength = fillLength;
+    return readAhead;
+}
+
+//========
+
+// copies readIn into a range of the file, growing the file when writing past its end
+bool StorageFile::write(int64_t offset, const void* readIn, int64_t length)
+{
+    // fail if not open or if range would leave a gap after the end of file
+    if (!opened || (offset < 0) || (offset > size))
+    {
+        return 1;
+    }
+
+    if (!logged)
+    {
+        if (writeFile(offset, readIn, length))
+        {
+            return 1;
+        }
+        size = fileSize;
+        return 0;
+    }
+
+    // keep the held writes as they were when saved, before the first write changing them
+    if (savePending)
+    {
+        savedWrites = heldWrites;
+        savedSize = size;
+        savePending = 0;
+        saved = 1;
+    }
+
+    // hold the write before logging it, as logging may start a checkpoint
+    holdWrite(offset, readIn, length);
+    if (offset + length > size)
+    {
+        size = offset + length;
+    }
+    return WriteAheadLog::append(filename.c_str(), offset, readIn, length);
+}
+
+//========
+
+// copies readIn into a range stored in the file
+bool StorageFile::writeFile(int64_t offset, const void* readIn, int64_t length)
+{
+#ifndef _WIN32
+    if (backend == mappedBackend)
+    {
+        if (offset + length > fileSize)
+        {
+            // extend mapping when the write passes the reserved length
+            if ((offset + length > mappingLength) && remap(offset + length))
+            {
+                return 1;
+            }
+            // extend file to cover the write
+            if (ftruncate(descriptor, offset + length))
+            {
+                return 1;
+            }
+            fileSize = offset + length;
+        }
+        memcpy(mapping + offset, readIn, length);
+        return 0;
+    }
+#endif
+
+    stream.seekp(offset);
+    stream.write(static_cast<const char*>(readIn), length);
+
+    // a read after a write must seek
+    streamPosition = -1;
+
+    if (!stream.good())
+    {
+        stream.clear();
+        readAheadLength = 0;
+        return 1;
+    }
+
+    // keep overlapping part of the read ahead buffer up to date
+    int64_t overlapStart = (offset > readAheadOffset) ? offset : readAheadOffset;
+    int64_t overlapEnd = (offset + length < readAheadOffset + readAheadLength) ? offset + length : readAheadOffset + readAheadLength;
+    if (overlapStart < overlapEnd)
+    {
+        memcpy(readAhead + (overlapStart - readAheadOffset), static_cast<const char*>(readIn) + (overlapStart - offset), overlapEnd - overlapStart);
+    }
+
+    if (offset + length > fileSize)
+    {
+        fileSize = offset + length;
+    }
+    return 0;
+}
+
+//========
+
+// merges a write into the held writes, joining it with every held write it overlaps or touches
+void StorageFile::holdWrite(int64_t offset, const void* readIn, int64_t length)
+{
+    const char* bytes = static_cast<const char*>(readIn);
+    int64_t end = offset + length;
+
+    // first held write that could overlap or touch the range
+    std::map<int64_t, std::vector<char>>::iterator first = heldWrites.upper_bound(offset);
+    if (first != heldWrites.begin())
+    {
+        std::map<int64_t, std::vector<char>>::iterator previous = first;
+        previous--;
+        if (previous->first + static_cast<int64_t>(previous->second.size()) >= offset)
+        {
+            first = previous;
+        }
+    }
+
+    // one past the last held write that overlaps or touches the range
+    std::map<int64_t, std::vector<char>>::iterator last = first;
+    int64_t mergedStart = offset;
+    int64_t mergedEnd = end;
+    while ((last != heldWrites.end()) && (last->first <= end))
+    {
+        int64_t heldEnd = last->first + static_cast<int64_t>(last->second.size());
+        if (last->first < mergedStart)
+        {
+            mergedStart = last->first;
+        }
+        if (heldEnd > mergedEnd)
+        {
+            mergedEnd = heldEnd;
+        }
+        last++;
+    }
+
+    // common cases of extending or overwriting a single held write in place
+    if ((first != last) && (first->first == mergedStart) && (std::next(first) == last))
+    {
+        std::vector<char>& held = first->second;
+        held.resize(mergedEnd - mergedStart);
+        memcpy(held.data() + (offset - mergedStart), bytes, length);
+        return;
+    }
+
+    // otherwise build one write covering the range and all held writes it joins
+    std::vector<char> merged(mergedEnd - mergedStart);
+    for (std::map<int64_t, std::vector<char>>::iterator held = first; held != last; held++)
+    {
+        memcpy(merged.data() + (held->first - mergedStart), held->second.data(), held->second.size());
+    }
+    memcpy(merged.data() + (offset - mergedStart), bytes, length);
+    heldWrites.erase(first, last);
+    heldWrites[mergedStart].swap(merged);
+}
+
+//========
+
+bool StorageFile::flush()
+{
+    // fail if not open
+    if (!opened)
+    {
+        return 1;
+    }
+
+    if (backend == streamBackend)
+    {
+        stream.flush();
+        return !stream.good();
+    }
+#ifndef _WIN32
+    if (fileSize > 0)
+    {
+        return msync(mapping, fileSize, MS_ASYNC) != 0;
+    }
+#endif
+    return 0;
+}
+
+//========
+
+bool StorageFile::sync()
+{
+    // fail if not open
+    if (!opened)
+    {
+        return 1;
+    }
+
+#ifndef _WIN32
+    if (backend == mappedBackend)
+    {
+        if ((fileSize > 0) && msync(mapping, fileSize, MS_SYNC))
+        {
+            return 1;
+        }
+        return fsync(descriptor) != 0;
+    }
+#endif
+
+    if (flush())
+    {
+        return 1;
+    }
+
+    // a file stream gives no access to its descriptor, syncing any descriptor of the file syncs its data
+    return syncFile(filename.c_str());
+}
+
+//========
+
+bool StorageFile::syncFile(const char* filename)
+{
+#ifdef _WIN32
+    int syncDescriptor = _open(filename, _O_RDWR | _O_BINARY);
+    if (syncDescriptor < 0)
+    {
+        return 1;
+    }
+    bool failed = _commit(syncDescriptor) != 0;
+    _close(syncDescriptor);
+#else
+    int syncDescriptor = ::open(filename, O_RDONLY);
+    if (syncDescriptor < 0)
+    {
+        return 1;
+    }
+    bool failed = fsync(syncDescriptor) != 0;
+    ::close(syncDescriptor);
+#endif
+    return failed;
+}
+
+//========
+
+// the replacement is on disk before the rename, so a crash leaves either file whole
+bool StorageFile::replaceFile(const char* replacement, const char* replaced)
+{
+    if (syncFile(replacement))
+    {
+        return 1;
+    }
+
+#ifdef _WIN32
+    // rename does not replace files on windows
+    std::remove(replaced);
+    return std::rename(replacement, replaced) != 0;
+#else
+    if (std::rename(replacement, replaced))
+    {
+        return 1;
+    }
+
+    // the rename is stored with the directory holding the file
+    std::string directory(replaced);
+    size_t separator = directory.find_last_of('/');
+    directory = (separator == std::string::npos) ? std::string(".") : directory.substr(0, separator + 1);
+    int directoryDescriptor = ::open(directory.c_str(), O_RDONLY);
+    if (directoryDescriptor < 0)
+    {
+        return 1;
+    }
+    bool failed = fsync(directoryDescriptor) != 0;
+    ::close(directoryDescriptor);
+    return failed;
+#endif
+}
+
+//========
+
+// writes the held writes to the file in offset order
+bool StorageFile::checkpoint()
+{
+    // fail if not open
+    if (!opened)
+    {
+        return 1;
+    }
+
+    if (heldWrites.empty())
+    {
+        return 0;
+    }
+
+    for (std::map<int64_t, std::vector<char>>::iterator held = heldWrites.begin(); held != heldWrites.end(); held++)
+    {
+        if (writeFile(held->first, held->second.data(), held->second.size()))
+        {
+            return 1;
+        }
+    }
+    heldWrites.clear();
+    return sync();
+}
+
+//========
+
+void StorageFile::saveHeldWrites()
+{
+    savePending = 1;
+    saved = 0;
+    savedWrites.clear();
+}
+
+//========
+
+// returns to the held writes saved, nothing to return to if the file was not written since
+void StorageFile::restoreHeldWrites()
+{
+    if (saved)
+    {
+        heldWrites.swap(savedWrites);
+        size = savedSize;
+    }
+    discardSavedWrites();
+}
+
+//========
+
+void StorageFile::discardSavedWrites()
+{
+    savePending = 0;
+    saved = 0;
+    savedWrites.clear();
+}
+
+//========
+
+// replaces the read ahead buffer with an empty one of the new size
+void StorageFile::setReadAheadSize(int64_t readAheadSize)
+{
+    delete[] readAhead;
+    readAhead = nullptr;
+    if (readAheadSize > 0)
+    {
+        readAhead = new char[readAheadSize];
+    }
+    readAheadCapacity = readAheadSize;
+    readAheadOffset = 0;
+    readAheadLength = 0;
+}
+
+//========
+
+// replaces the mapping with one reserving at least twice the requested length
+bool StorageFile::remap(int64_t minimumLength)
+{
+#ifdef _WIN32
+    (void)minimumLength;
+    return 1;
+#else
+    int64_t newLength = MINIMUM_MAPPING_LENGTH;
+    while (newLength < minimumLength * 2)
+    {
+        newLength *= 2;
+    }
+
+    // pages past the end of the file are reserved but never touched until the file is extended
+    void* newMapping = mmap(nullptr, newLength, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    if (newMapping == MAP_FAILED)
+    {
+        return 1;
+    }
+
+    if (mapping != nullptr)
+    {
+        munmap(mapping, mappingLength);
+    }
+    mapping = static_cast<char*>(newMapping);
+    mappingLength = newLength;
+    return 0;
+#endif
+}
+
+//========
+
+#endif
@@ -0,0 +1,268 @@
+/* StorageFile.h
+description:
+This is the module for file access by the database modules.
+a database file can be accessed through a file stream, or through a memory mapping of the file.
+version history:
+ver6 -26/10/17
+        -added syncFile and replaceFile, replacing a file durably
+ver5 -26/10/17
+        -held writes saved and restored, so a write ahead log transaction can be aborted
+ver4 -26/10/17
+        -added view, giving read only access to a range in place of copying it
+ver3 -26/10/17
+        -writes can be logged to the write ahead log and held in memory until a checkpoint
+ver2 -26/10/17
+        -read ahead buffer for the stream backend
+ver1 -26/10/17
+        -stream and memory mapped backends
+*/
+
+#ifndef STORAGE_FILE_H
+#define STORAGE_FILE_H
+
+//==================
+
+#include <stdint.h>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+//==================
+
+enum StorageBackend{streamBackend, mappedBackend}; // possible ways of accessing a database file
+
+const StorageBackend DEFAULT_STORAGE_BACKEND = streamBackend; // backend used by the program's databases
+const int64_t DEFAULT_READ_AHEAD_SIZE = 1 << 16; // bytes read from file at once by the stream backend
+
+//==================
+
+// class managing access to one database file
+// provides reads and writes of byte ranges at given offsets in the file
+class StorageFile
+{
+    public:
+    StorageFile();
+    ~StorageFile();
+
+    bool open(
+        /* name of the file to open, the file is created if it does not exist
+        used as input */
+        const char* filename,
+        /* way in which the file is accessed
+        used as input */
+        StorageBackend backend
+    );
+    /* description:
+        opens a file for reading and writing.
+        the memory mapped backend is only available on POSIX systems, elsewhere the stream backend is used.
+    preconditions:
+        the StorageFile is not open.
+    postconditions:
+        the file exists and is open.
+    returns:
+        return 0 on successful open, return 1 on failure.
+    */
+
+    bool close();
+    /* description:
+        closes the file.
+    preconditions:
+        the StorageFile is open.
+    returns:
+        return 0 on successful close, return 1 on failure.
+    */
+
+    bool isOpen();
+    /* returns:
+        true if the file is open.
+    */
+
+    int64_t getSize();
+    /* returns:
+        the size of the file in bytes.
+    */
+
+    bool read(
+        /* offset in the file of the first byte to read
+        used as input */
+        int64_t offset,
+        /* used to store the bytes read
+        used as output, mutates */
+        void* readInto,
+        /* number of bytes to read
+        used as input */
+        int64_t length
+    );
+    /* description:
+        reads a range of bytes from the file.
+    preconditions:
+        the range is within the file.
+    returns:
+        return 0 on successful read, return 1 on failure.
+    */
+
+    const char* view(
+        /* offset in the file of the first byte to view
+        used as input */
+        int64_t offset,
+        /* number of bytes to view
+        used as input */
+        int64_t length
+    );
+    /* description:
+        gives read only access to a range of bytes of the file without copying it, pointing into the
+        mapped pages or the read ahead buffer. a range the read ahead buffer cannot hold, or holding
+        logged changes not yet checkpointed, is copied into a buffer of the StorageFile instead.
+    preconditions:
+        the range is within the file.
+    postconditions:
+        the bytes stay valid until the next call to a function of the StorageFile.
+    returns:
+        the first byte of the range, nullptr on failure.
+    */
+
+    bool write(
+        /* offset in the file of the first byte to write
+        used as input */
+        int64_t offset,
+        /* bytes to write
+        used as input */
+        const void* readIn,
+        /* number of bytes to write
+        used as input */
+        int64_t length
+    );
+    /* description:
+        writes a range of bytes to the file.
+        the file grows if the range ends past the end of the file.
+        when the file is logged, the bytes are appended to the write ahead log and held in memory,
+        reads see them immediately and they are written to the file at the next checkpoint.
+    preconditions:
+        offset is not past the end of the file.
+    returns:
+        return 0 on successful write, return 1 on failure.
+    */
+
+    bool flush();
+    /* description:
+        hands all written bytes to the operating system.
+    returns:
+        return 0 on successful flush, return 1 on failure.
+    */
+
+    bool sync();
+    /* description:
+        flushes the file and waits until all written bytes are stored on disk.
+    returns:
+        return 0 on successful sync, return 1 on failure.
+    */
+
+    bool checkpoint();
+    /* description:
+        writes the logged changes held in memory to the file and syncs it.
+    preconditions:
+        the changes are committed in the write ahead log.
+    postconditions:
+        no logged changes are held in memory.
+    returns:
+        return 0 on successful checkpoint, return 1 on failure.
+    */
+
+    void saveHeldWrites();
+    /* description:
+        marks the logged changes held in memory, and the size of the file, as those restoreHeldWrites
+        returns to. they are copied by the next write, so a file not written since costs nothing.
+    */
+
+    void restoreHeldWrites();
+    /* description:
+        discards the logged changes made since saveHeldWrites, returning the held writes and the size
+        of the file to what they were then.
+    preconditions:
+        the discarded changes are not committed in the write ahead log.
+    */
+
+    void discardSavedWrites();
+    /* description:
+        forgets the mark made by saveHeldWrites, keeping every logged change held in memory.
+    */
+
+    static bool syncFile(
+        /* name of a file that is not open
+        used as input */
+        const char* filename
+    );
+    /* description:
+        waits until all bytes written to a file written by other means, such as a file stream, are stored on disk.
+    returns:
+        return 0 on successful sync, return 1 on failure.
+    */
+
+    static bool replaceFile(
+        /* name of the file taking the place of replaced
+        used as input */
+        const char* replacement,
+        /* name of the file replaced, which may not exist
+        used as input */
+        const char* replaced
+    );
+    /* description:
+        syncs replacement, then renames it to replaced, and syncs the directory so the rename is stored on disk.
+        on POSIX systems the rename replaces the file at once. elsewhere replaced is removed first, and a crash
+        between the two leaves replacement complete on disk in its place.
+    preconditions:
+        neither file is open.
+    returns:
+        return 0 on successful replacement, return 1 on failure.
+    */
+
+    void setReadAheadSize(
+        /* number of bytes to read from file at once, 0 to read only what is requested
+        used as input */
+        int64_t readAheadSize
+    );
+    /* description:
+        sets the size of the read ahead buffer of the stream backend.
+        reads falling within the buffer are served without accessing the file.
+    postconditions:
+        the read ahead buffer is emptied.
+    */
+
+    private:
+    bool readFile(int64_t offset, void* readInto, int64_t length); // reads a range stored in the file
+    const char* storedView(int64_t offset, int64_t length); // range stored in the file, in the mapping or read ahead buffer
+    bool writeFile(int64_t offset, const void* readIn, int64_t length); // writes a range into the file
+    void holdWrite(int64_t offset, const void* readIn, int64_t length); // merges a logged write into heldWrites
+
+    StorageBackend backend; // backend of the open file
+    std::string filename;
+    int64_t size; // size of the file in bytes, including logged changes held in memory
+    int64_t fileSize; // size of the file in bytes on disk
+    bool opened;
+    std::vector<char> viewCopy; // copy of the last range viewed that could not be viewed in place
+
+    // utilities for logged files
+    bool logged; // true if writes go through the write ahead log
+    std::map<int64_t, std::vector<char>> heldWrites; // logged changes by offset, never overlapping or adjacent
+    bool savePending; // true if the next write copies heldWrites and size into savedWrites and savedSize
+    bool saved; // true if savedWrites and savedSize hold what restoreHeldWrites returns to
+    std::map<int64_t, std::vector<char>> savedWrites; // heldWrites as they were at saveHeldWrites
+    int64_t savedSize; // size as it was at saveHeldWrites
+
+    // utilities for stream backend
+    std::fstream stream;
+    int64_t streamPosition; // offset the stream is positioned at, -1 if unknown
+    char* readAhead; // bytes read ahead of the last read
+    int64_t readAheadCapacity; // size of readAhead
+    int64_t readAheadOffset; // offset in file of the first byte in readAhead
+    int64_t readAheadLength; // number of valid bytes in readAhead
+
+    // utilities for mapped backend
+    bool remap(int64_t minimumLength); // grows the mapping to cover at least minimumLength bytes
+    int descriptor; // file descriptor of the mapped file
+    char* mapping; // first byte of the mapping
+    int64_t mappingLength; // length of the mapping, may extend past the end of the file
+};
+
+#endif
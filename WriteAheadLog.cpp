@@ -0,0 +1,474 @@
+/* WriteAheadLog.cpp
+description:
+Module implementing the write ahead log.
+
+the log is a sequence of records, each a header followed by the bytes it describes. a write record
+holds the name of the database file, the offset and the bytes written. a commit record ends each
+group and holds the number of writes in the group. every header holds a checksum of the record, so
+a record torn by a crash is found at replay, and replay stops at the first record that is torn or
+that does not belong to a committed group.
+
+writes are encoded into memory until the group is committed, so a group reaches the log through one
+write and one flush however many writes it holds.
+
+a transaction only holds back the commit of the group, so the writes of a transaction are committed
+together with any writes appended before it in the same group. a hold works in the same way, but
+leaves the commit to the group commit and checkpoint rules of append once released.
+an aborted transaction cuts the group back to where the transaction started, and each logged file
+returns to the held writes it saved at beginTransaction.
+
+version history:
+ver4 -26/10/17
+        -transaction abort
+ver3 -26/10/17
+        -commit holds
+ver2 -26/10/17
+        -transactions
+ver1 -26/10/17
+*/
+
+#ifndef WRITE_AHEAD_LOG_CPP
+#define WRITE_AHEAD_LOG_CPP
+
+//==================
+
+#include "WriteAheadLog.h"
+#include "StorageFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+//==================
+
+// define static utilities for the log
+const char* WriteAheadLog::filename = "Journal.log";
+FILE* WriteAheadLog::logFile = nullptr;
+bool WriteAheadLog::initialized = 0;
+bool WriteAheadLog::inTransaction = 0;
+int WriteAheadLog::commitHolds = 0;
+int64_t WriteAheadLog::logSize = 0;
+std::vector<char> WriteAheadLog::group;
+int WriteAheadLog::groupCount = 0;
+size_t WriteAheadLog::transactionStart = 0;
+int WriteAheadLog::transactionCount = 0;
+std::vector<StorageFile*> WriteAheadLog::files;
+
+enum LogRecordType{logWrite = 1, logCommit = 2};
+
+// header of a record in the log, followed by length bytes for write records
+typedef struct
+{
+    uint32_t checksum; // checksum of the rest of the header and the bytes
+    int32_t type; // LogRecordType of the record
+    char filename[MAX_LOGGED_FILENAME_SIZE]; // database file written, empty for commit records
+    int64_t offset; // offset of the write in the database file
+    int64_t length; // number of bytes written, or number of writes in the group for commit records
+}log_record_header;
+
+//==================
+
+// FNV-1a checksum of a record, skipping the checksum field
+uint32_t recordChecksum(const log_record_header& header, const char* bytes, int64_t length)
+{
+    uint32_t checksum = 2166136261u;
+    const char* headerBytes = reinterpret_cast<const char*>(&header) + sizeof(header.checksum);
+    for (size_t i = 0; i < sizeof(log_record_header) - sizeof(header.checksum); i++)
+    {
+        checksum = (checksum ^ static_cast<unsigned char>(headerBytes[i])) * 16777619u;
+    }
+    for (int64_t i = 0; i < length; i++)
+    {
+        checksum = (checksum ^ static_cast<unsigned char>(bytes[i])) * 16777619u;
+    }
+    return checksum;
+}
+
+//========
+
+// appends an encoded record to the end of a buffer
+void encodeRecord(std::vector<char>& buffer, int32_t type, const char* filename, int64_t offset, const void* bytes, int64_t length)
+{
+    log_record_header header;
+    memset(&header, 0, sizeof(header));
+    header.type = type;
+    strncpy(header.filename, filename, MAX_LOGGED_FILENAME_SIZE - 1);
+    header.offset = offset;
+    header.length = length;
+
+    int64_t byteCount = (type == logWrite) ? length : 0;
+    header.checksum = recordChecksum(header, static_cast<const char*>(bytes), byteCount);
+
+    const char* headerBytes = reinterpret_cast<const char*>(&header);
+    buffer.insert(buffer.end(), headerBytes, headerBytes + sizeof(header));
+    if (byteCount > 0)
+    {
+        const char* writeBytes = static_cast<const char*>(bytes);
+        buffer.insert(buffer.end(), writeBytes, writeBytes + byteCount);
+    }
+}
+
+//==================
+
+bool WriteAheadLog::init()
+{
+    // fail if already initialized
+    if (initialized)
+    {
+        return 1;
+    }
+
+    if (replay())
+    {
+        return 1;
+    }
+
+    // the replayed log is no longer needed
+    logFile = fopen(filename, "wb");
+    if (logFile == nullptr)
+    {
+        return 1;
+    }
+
+    logSize = 0;
+    group.clear();
+    groupCount = 0;
+    initialized = 1;
+    return 0;
+}
+
+//========
+
+bool WriteAheadLog::uninit()
+{
+    // fail if not initialized
+    if (!initialized)
+    {
+        return 1;
+    }
+
+    bool failed = checkpoint();
+    fclose(logFile);
+    logFile = nullptr;
+    initialized = 0;
+    return failed;
+}
+
+//========
+
+bool WriteAheadLog::isInitialized()
+{
+    return initialized;
+}
+
+//========
+
+bool WriteAheadLog::append(const char* filename, int64_t offset, const void* bytes, int64_t length)
+{
+    // fail if not initialized or if the file name does not fit in a record
+    if (!initialized || (strlen(filename) >= static_cast<size_t>(MAX_LOGGED_FILENAME_SIZE)))
+    {
+        return 1;
+    }
+
+    encodeRecord(group, logWrite, filename, offset, bytes, length);
+    groupCount++;
+
+    // a transaction commits its group itself, and a hold leaves the group to releaseCommit
+    if (inTransaction || (commitHolds > 0))
+    {
+        return 0;
+    }
+
+    if ((groupCount >= GROUP_COMMIT_SIZE) && commit())
+    {
+        return 1;
+    }
+    if (logSize >= CHECKPOINT_LOG_SIZE)
+    {
+        return checkpoint();
+    }
+    return 0;
+}
+
+//========
+
+bool WriteAheadLog::commit()
+{
+    // fail if not initialized
+    if (!initialized)
+    {
+        return 1;
+    }
+
+    if (groupCount == 0)
+    {
+        return 0;
+    }
+
+    encodeRecord(group, logCommit, "", 0, nullptr, groupCount);
+    if (fwrite(group.data(), 1, group.size(), logFile) != group.size())
+    {
+        return 1;
+    }
+    if (syncLog())
+    {
+        return 1;
+    }
+
+    logSize += group.size();
+    group.clear();
+    groupCount = 0;
+    return 0;
+}
+
+//========
+
+void WriteAheadLog::beginTransaction()
+{
+    inTransaction = 1;
+
+    // remember where the transaction starts, so it can be aborted
+    transactionStart = group.size();
+    transactionCount = groupCount;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        files[i]->saveHeldWrites();
+    }
+}
+
+//========
+
+bool WriteAheadLog::commitTransaction()
+{
+    inTransaction = 0;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        files[i]->discardSavedWrites();
+    }
+
+    // without a log the writes went straight to the files
+    if (!initialized)
+    {
+        return 0;
+    }
+
+    if (commit())
+    {
+        return 1;
+    }
+    if (logSize >= CHECKPOINT_LOG_SIZE)
+    {
+        return checkpoint();
+    }
+    return 0;
+}
+
+//========
+
+bool WriteAheadLog::abortTransaction()
+{
+    inTransaction = 0;
+
+    // without a log the writes went straight to the files
+    if (!initialized)
+    {
+        return 1;
+    }
+
+    // the transaction's records are the last ones in the group, as it was not committed since it started
+    group.resize(transactionStart);
+    groupCount = transactionCount;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        files[i]->restoreHeldWrites();
+    }
+    return 0;
+}
+
+//========
+
+void WriteAheadLog::holdCommit()
+{
+    commitHolds++;
+}
+
+//========
+
+bool WriteAheadLog::releaseCommit()
+{
+    commitHolds--;
+
+    // the group is left to the outer hold or transaction, and without a log the writes went straight to the files
+    if ((commitHolds > 0) || inTransaction || !initialized)
+    {
+        return 0;
+    }
+
+    if ((groupCount >= GROUP_COMMIT_SIZE) && commit())
+    {
+        return 1;
+    }
+    if (logSize >= CHECKPOINT_LOG_SIZE)
+    {
+        return checkpoint();
+    }
+    return 0;
+}
+
+//========
+
+bool WriteAheadLog::checkpoint()
+{
+    // fail if not initialized
+    if (!initialized)
+    {
+        return 1;
+    }
+
+    // changes may only reach the files once they are committed
+    if (commit())
+    {
+        return 1;
+    }
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        if (files[i]->checkpoint())
+        {
+            return 1;
+        }
+    }
+
+    // every logged change is in the files, so the log can be emptied
+    fclose(logFile);
+    logFile = fopen(filename, "wb");
+    if (logFile == nullptr)
+    {
+        initialized = 0;
+        return 1;
+    }
+    logSize = 0;
+    return 0;
+}
+
+//========
+
+void WriteAheadLog::addFile(StorageFile* file)
+{
+    files.push_back(file);
+}
+
+//========
+
+void WriteAheadLog::removeFile(StorageFile* file)
+{
+    files.erase(std::remove(files.begin(), files.end(), file), files.end());
+}
+
+//========
+
+// applies each committed group in order, stopping at the first torn or uncommitted record
+bool WriteAheadLog::replay()
+{
+    // read the whole log, no log means nothing to replay
+    std::ifstream log(filename, std::ios::in | std::ios::binary);
+    if (!log.is_open())
+    {
+        return 0;
+    }
+    std::vector<char> contents((std::istreambuf_iterator<char>(log)), std::istreambuf_iterator<char>());
+    log.close();
+
+    std::map<std::string, StorageFile> targets; // database files written by the replay
+    std::vector<int64_t> groupRecords; // positions of the write records of the current group
+    int64_t position = 0;
+    bool failed = 0;
+
+    while (!failed && (position + static_cast<int64_t>(sizeof(log_record_header)) <= static_cast<int64_t>(contents.size())))
+    {
+        log_record_header header;
+        memcpy(&header, contents.data() + position, sizeof(header));
+        header.filename[MAX_LOGGED_FILENAME_SIZE - 1] = '\0';
+
+        // stop at a torn record
+        int64_t byteCount = (header.type == logWrite) ? header.length : 0;
+        if ((byteCount < 0) || (byteCount > static_cast<int64_t>(contents.size()) - position - static_cast<int64_t>(sizeof(header))))
+        {
+            break;
+        }
+        if (header.checksum != recordChecksum(header, contents.data() + position + sizeof(header), byteCount))
+        {
+            break;
+        }
+
+        if (header.type == logWrite)
+        {
+            groupRecords.push_back(position);
+        }
+        else if ((header.type == logCommit) && (header.length == static_cast<int64_t>(groupRecords.size())))
+        {
+            // group is committed, apply its writes
+            for (size_t i = 0; !failed && (i < groupRecords.size()); i++)
+            {
+                log_record_header write;
+                memcpy(&write, contents.data() + groupRecords[i], sizeof(write));
+                write.filename[MAX_LOGGED_FILENAME_SIZE - 1] = '\0';
+
+                StorageFile& target = targets[write.filename];
+                if (!target.isOpen() && target.open(write.filename, streamBackend))
+                {
+                    failed = 1;
+                }
+                else if (target.write(write.offset, contents.data() + groupRecords[i] + sizeof(write), write.length))
+                {
+                    failed = 1;
+                }
+            }
+            groupRecords.clear();
+        }
+        else
+        {
+            break;
+        }
+
+        position += sizeof(header) + byteCount;
+    }
+
+    // the replayed writes must be on disk before the log is emptied
+    for (std::map<std::string, StorageFile>::iterator target = targets.begin(); target != targets.end(); target++)
+    {
+        if (target->second.sync())
+        {
+            failed = 1;
+        }
+        target->second.close();
+    }
+    return failed;
+}
+
+//========
+
+bool WriteAheadLog::syncLog()
+{
+    if (fflush(logFile))
+    {
+        return 1;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(logFile)) != 0;
+#else
+    return fsync(fileno(logFile)) != 0;
+#endif
+}
+
+//========
+
+#endif
@@ -0,0 +1,186 @@
+/* WriteAheadLog.h
+description:
+This is the module for the write ahead log shared by the database modules.
+writes to database files opened while the log is initialized are appended to the log, and several
+writes are made durable together by one flush of the log. the database files are brought up to date
+at checkpoints, and a log left behind by a crash is replayed into the database files at init.
+
+durability guarantee:
+a write is durable once the group holding it is committed. a group is committed when it holds
+GROUP_COMMIT_SIZE writes, when commit is called, and at checkpoints. a crash loses the writes of the
+uncommitted group only, and groups are replayed whole, so the files never hold part of a group.
+writes made between beginTransaction and commitTransaction are always committed in the same group,
+and so are writes made between holdCommit and releaseCommit. abortTransaction discards the writes of
+a transaction instead, so none of them is ever committed.
+
+version history:
+ver4 -26/10/17
+        -aborting a transaction, discarding its writes
+ver3 -26/10/17
+        -holding the commit of a group, so related writes share a group without a flush of their own
+ver2 -26/10/17
+        -transactions keeping writes in one group
+ver1 -26/10/17
+*/
+
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+//==================
+
+#include <stdint.h>
+#include <cstdio>
+#include <vector>
+
+//==================
+
+const int GROUP_COMMIT_SIZE = 16; // writes committed by one flush of the log
+const int64_t CHECKPOINT_LOG_SIZE = 1 << 22; // size in bytes of the log that triggers a checkpoint
+const int MAX_LOGGED_FILENAME_SIZE = 32; // size of a database file name stored in the log
+
+class StorageFile;
+
+//==================
+
+// class managing the write ahead log
+// provides logging of database file writes, group commit and checkpoints
+class WriteAheadLog
+{
+    public:
+    static bool init();
+    /* description:
+        replays the committed groups of a log left behind by a crash into the database files,
+        then opens an empty log.
+    preconditions:
+        the WriteAheadLog is uninitialized, and no database file is open.
+    postconditions:
+        database files opened from now on are logged.
+    returns:
+        return 0 on successful initialization, return 1 on failure.
+    */
+
+    static bool uninit();
+    /* description:
+        checkpoints all logged files and closes the log.
+    preconditions:
+        the WriteAheadLog is initialized.
+    returns:
+        return 0 on successful uninitialization, return 1 on failure.
+    */
+
+    static bool isInitialized();
+    /* returns:
+        true if the log is initialized.
+    */
+
+    static bool append(
+        /* name of the database file written to
+        used as input */
+        const char* filename,
+        /* offset in the file of the first byte written
+        used as input */
+        int64_t offset,
+        /* bytes written
+        used as input */
+        const void* bytes,
+        /* number of bytes written
+        used as input */
+        int64_t length
+    );
+    /* description:
+        adds a write to the uncommitted group.
+        commits the group once it holds GROUP_COMMIT_SIZE writes, and checkpoints once the log
+        reaches CHECKPOINT_LOG_SIZE bytes.
+    preconditions:
+        the WriteAheadLog is initialized.
+    returns:
+        return 0 on success, return 1 on failure.
+    */
+
+    static bool commit();
+    /* description:
+        appends the uncommitted group to the log, followed by a commit record, and waits until
+        the log is stored on disk.
+    postconditions:
+        every write appended so far is durable.
+    returns:
+        return 0 on successful commit, return 1 on failure.
+    */
+
+    static void beginTransaction();
+    /* description:
+        starts a transaction. until it is committed, groups are not committed on reaching
+        GROUP_COMMIT_SIZE writes and no checkpoint is started by append.
+    preconditions:
+        no transaction is in progress.
+    */
+
+    static bool commitTransaction();
+    /* description:
+        ends the transaction and commits the group holding its writes with one flush of the log.
+        when the log is not initialized, the transaction is only ended.
+    preconditions:
+        a transaction is in progress.
+    returns:
+        return 0 on successful commit, return 1 on failure.
+    */
+
+    static bool abortTransaction();
+    /* description:
+        ends the transaction and discards its writes, removing them from the uncommitted group and from
+        the changes held by the logged files. writes appended before the transaction stay in the group.
+        when the log is not initialized, the writes already reached the files and the transaction is only ended.
+    preconditions:
+        a transaction is in progress, and no hold is in progress.
+    postconditions:
+        the logged files read as they did at beginTransaction. the database modules written during the
+        transaction must be reinitialized, as their state in memory still holds the discarded writes.
+    returns:
+        return 0 if the writes were discarded, return 1 if the log is not initialized.
+    */
+
+    static void holdCommit();
+    /* description:
+        keeps the writes appended from now on in the uncommitted group until releaseCommit, without
+        committing them when released. used by a database module writing to several of its files at once.
+        holds may be nested, and may be made inside a transaction.
+    */
+
+    static bool releaseCommit();
+    /* description:
+        ends the last holdCommit. once no hold or transaction remains, the group is committed if it holds
+        GROUP_COMMIT_SIZE writes, and a checkpoint is made if the log reached CHECKPOINT_LOG_SIZE bytes.
+    preconditions:
+        a hold is in progress.
+    returns:
+        return 0 on success, return 1 on failure.
+    */
+
+    static bool checkpoint();
+    /* description:
+        commits, writes the changes held by all logged files into the files, and empties the log.
+    returns:
+        return 0 on successful checkpoint, return 1 on failure.
+    */
+
+    static void addFile(StorageFile* file); // registers an opened logged file for checkpoints
+    static void removeFile(StorageFile* file); // unregisters a logged file being closed
+
+    private:
+    static bool replay(); // applies the committed groups in the log to the database files
+    static bool syncLog(); // flushes the log and waits until it is stored on disk
+
+    static const char* filename;
+    static FILE* logFile;
+    static bool initialized;
+    static bool inTransaction; // true between beginTransaction and commitTransaction
+    static int commitHolds; // number of holdCommit calls not yet released
+    static int64_t logSize; // size of the log in bytes
+    static std::vector<char> group; // encoded records of the uncommitted group
+    static int groupCount; // number of writes in group
+    static size_t transactionStart; // size of group at beginTransaction
+    static int transactionCount; // groupCount at beginTransaction
+    static std::vector<StorageFile*> files; // open logged files
+};
+
+#endif
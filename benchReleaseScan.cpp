@@ -0,0 +1,125 @@
+/* benchReleaseScan.cpp
+description:
+This is a benchmark driver that times full scans of a release file, comparing the original
+seek per element access with the read ahead access of the Release module.
+The driver writes its own Release.dat, so it must be run in an empty directory.
+usage: benchReleaseScan [number of releases, default 1000000]
+version history:
+ver1 -26/10/17
+*/
+
+#include "Release.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+/*
+-------------------------------------------------------------------------------------------------------------------------------------------------------------------
+Helper functions to assist with timing and reporting
+*/
+
+// seconds elapsed since start
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// print one line of results, with speedup relative to the baseline
+void printResult(const char* scanName, double seconds, double baseline, int64_t count) {
+    printf("%-36s %10.3f s   %8.2fx   (%lld releases)\n", scanName, seconds, baseline / seconds, static_cast<long long>(count));
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char** argv) {
+    int64_t releaseTotal = 1000000;
+    if (argc > 1) {
+        releaseTotal = atoll(argv[1]);
+    }
+
+    /*
+    Setup: write the release file
+    */
+    std::remove("Release.dat");
+    if (Release::initRelease()) {
+        std::cout << "Initialization Failed" << std::endl;
+        return 1;
+    }
+    for (int64_t i = 0; i < releaseTotal; i++) {
+        release newRelease;
+        snprintf(newRelease.name, MAX_PRODUCT_NAME_SIZE, "Prod%lld", static_cast<long long>(i % 500));
+        snprintf(newRelease.date, RELEASE_DATE_SIZE, "2024-07-%02d", static_cast<int>(i % 28) + 1);
+        snprintf(newRelease.releaseId, ID_DIGITS, "r%lld", static_cast<long long>(i % 10000000));
+        if (Release::writeRelease(newRelease)) {
+            std::cout << "Write Failed" << std::endl;
+            return 1;
+        }
+    }
+    Release::uninitRelease();
+
+    release readInto;
+    release filter;
+    strcpy(filter.name, "Prod7"); // one product in 500
+    int64_t count;
+
+    /*
+    Scan 1: seek and read each element through a file stream, as Release::getNext did originally
+    */
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::fstream releaseFile("Release.dat", std::ios::in | std::ios::binary);
+    count = 0;
+    for (int64_t fileIndex = 0; fileIndex < releaseTotal; fileIndex++) {
+        releaseFile.seekg(fileIndex * sizeof(release), std::ios::beg);
+        releaseFile.read(reinterpret_cast<char*>(&readInto), sizeof(release));
+        if (releaseFile.fail()) {
+            break;
+        }
+        if (strcmp(readInto.name, filter.name) == 0) {
+            count++;
+        }
+    }
+    releaseFile.close();
+    double baseline = secondsSince(start);
+    printResult("seek per element (original)", baseline, baseline, count);
+
+    /*
+    Scan 2: filtered getNext through the read ahead buffer
+    */
+    Release::initRelease(streamBackend);
+    start = std::chrono::steady_clock::now();
+    count = 0;
+    while (!Release::getNext(readInto, filter)) {
+        count++;
+    }
+    printResult("getNext, stream with read ahead", secondsSince(start), baseline, count);
+
+    /*
+    Scan 3: getNextBatch through the read ahead buffer
+    */
+    Release::seekToBeginning();
+    release page[MAX_PRINTS];
+    int found;
+    start = std::chrono::steady_clock::now();
+    count = 0;
+    while ((found = Release::getNextBatch(page, MAX_PRINTS, filter)) > 0) {
+        count += found;
+    }
+    printResult("getNextBatch, stream with read ahead", secondsSince(start), baseline, count);
+    Release::uninitRelease();
+
+    /*
+    Scan 4: filtered getNext through a memory mapping
+    */
+    Release::initRelease(mappedBackend);
+    start = std::chrono::steady_clock::now();
+    count = 0;
+    while (!Release::getNext(readInto, filter)) {
+        count++;
+    }
+    printResult("getNext, memory mapped", secondsSince(start), baseline, count);
+    Release::uninitRelease();
+
+    return 0;
+}
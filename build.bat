@@ -1,3 +1,5 @@
-g++ -O2 -Wall -Wpedantic -std=c++17 Main.cpp ChangeItem.cpp ChangeRequest.cpp ScenarioControl.cpp Requester.cpp Product.cpp Release.cpp -o ITS.exe
-g++ -O2 -std=c++17 Prepop.cpp ChangeItem.cpp ChangeRequest.cpp Requester.cpp Product.cpp Release.cpp -o PREPOP.exe
-g++ -O2 -std=c++17 testprepop.cpp ChangeItem.cpp ChangeRequest.cpp Requester.cpp Product.cpp Release.cpp -o TESTPREPOP.exe
+g++ -O2 -Wall -Wpedantic -std=c++17 Main.cpp ChangeItem.cpp ChangeRequest.cpp ScenarioControl.cpp Requester.cpp Product.cpp Release.cpp StorageFile.cpp WriteAheadLog.cpp CompressedBitmap.cpp KeySet.cpp Dictionary.cpp Date.cpp RequestTransaction.cpp RequestJoin.cpp -o ITS.exe
+g++ -O2 -std=c++17 Prepop.cpp ChangeItem.cpp ChangeRequest.cpp Requester.cpp Product.cpp Release.cpp StorageFile.cpp WriteAheadLog.cpp CompressedBitmap.cpp KeySet.cpp Dictionary.cpp Date.cpp -o PREPOP.exe
+g++ -O2 -std=c++17 testprepop.cpp ChangeItem.cpp ChangeRequest.cpp Requester.cpp Product.cpp Release.cpp StorageFile.cpp WriteAheadLog.cpp CompressedBitmap.cpp KeySet.cpp Dictionary.cpp Date.cpp -o TESTPREPOP.exe
+g++ -O2 -std=c++17 Migrate.cpp ChangeItem.cpp ChangeRequest.cpp Requester.cpp Product.cpp Release.cpp StorageFile.cpp WriteAheadLog.cpp CompressedBitmap.cpp KeySet.cpp Dictionary.cpp Date.cpp -o MIGRATE.exe
+g++ -O2 -std=c++17 Archive.cpp ChangeItem.cpp ChangeRequest.cpp Requester.cpp Product.cpp Release.cpp StorageFile.cpp WriteAheadLog.cpp CompressedBitmap.cpp KeySet.cpp Dictionary.cpp Date.cpp -o ARCHIVE.exe
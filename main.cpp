@@ -4,6 +4,12 @@ description:
     calls mid level control module to perform program processes
 
 version history:
+ver7 -26/10/17
+     -added the report of change requests by date
+ver6 -26/10/17
+     -added the change item summary report
+ver5 -26/10/17
+     -writes of each process are committed before returning to the main menu
 ver4 -24/07/24, update by Puja Shah
      -added query control
 ver3 -24/07/24, by Nicolao
@@ -64,6 +70,9 @@ int mainMenu()
 {   
     while (1)
     {
+        // the process just completed is durable before the next one begins
+        commitControl();
+
         cout << endl << endl;
         cout << "Main Menu:" << endl;  
         cout << "[1]  Handle Change Request" << endl;
@@ -166,6 +175,8 @@ int generateReportsMenu()
         cout << "[1]  All Requesters That Have Requested Some Change" << endl;
         cout << "[2]  All Change Items of a Product Not Done or Cancelled" << endl;
         cout << "[3]  View Change Item" << endl;
+        cout << "[4]  Change Item Summary by Product" << endl;
+        cout << "[5]  Change Requests by Date" << endl;
         cout << "[0]  Back" << endl;
 
         int userSelection = makeSelection();
@@ -195,6 +206,22 @@ int generateReportsMenu()
                 return 1;
             }
             break;
+        case ('4'):
+
+            // process to count the change items of each product by status and priority
+            if (generateReportSummary())
+            {
+                return 1;
+            }
+            break;
+        case ('5'):
+
+            // process to list the change requests dated in a range of days
+            if (generateReportRequestsByDate())
+            {
+                return 1;
+            }
+            break;
         case('0'):
             return 0;
             break;
@@ -2,6 +2,17 @@
 description:
 This is the implementation of the Product module
 version history:
+ver6 -26/10/17
+     -added ProductTraits pack and unpack, the database file is in the packed record format
+ver5 -26/10/17
+     -product names kept in a KeySet, its filter saved in ProductName.bloom at uninit
+     -added findProduct
+ver4 -26/10/17
+     -products stored in a RecordStore, which holds the file access index and select cache
+ver3 -26/10/17
+     -file access through StorageFile, so the file may be memory mapped
+     -select wraps negative cache positions
+     -added getNextBatch, reading BATCH_READ_SIZE products per file access
 ver2 -24/07/28 update by Nicolao and Allan Hu
      -fixed select function and filtered getnext behaviour
      -init now creates file when none exists
@@ -18,51 +29,42 @@ ver1 -24/07/14, original by Allan Hu
 
 //==================
 
-//product utility varibales
-int64_t Product::previouslyAccessed[20] = {0};  // records the indexes of the previous elements accessed, curcular array
-int64_t Product::previouslyAccessedPosition = 0;  // position in previously accessed
-
+//product utility variables
 const char* Product::filename = "Product.dat";
-std::fstream Product::productFile; // product elements
-int64_t Product::fileIndex = 0;  // currently viewed element in product file
-int64_t Product::productCount = 0;  // amount of products
+RecordStore<product, ProductTraits> Product::products; // product elements, file access index and select cache
+
+//product name utility variables
+const char* Product::keysFilename = "ProductName.bloom";
+KeySet Product::names; // product names
+
+//==================
+
+// key of a product in the product name KeySet
+std::string productKey(const char* name)
+{
+    return std::string(name, strnlen(name, MAX_PRODUCT_NAME_SIZE));
+}
 
 //==================
 
 //creates product file if needed
 //opens product file to allow reads and writes
-bool Product::initProduct()
+bool Product::initProduct(StorageBackend backend)
 {
-    // open product file 
-    productFile.open(filename, std::ios::in | std::ios::out | std::ios::binary);
-
-    // if file not found create file
-    if (!productFile.is_open()) 
+    // open product file, file is created if not found
+    // if file cannot be opened fail to initialise
+    // the store counts the products and resets the file access index and select cache
+    if (products.open(filename, backend))
     {
-        productFile.clear();
-        std::ofstream createFile(filename, std::ios::out | std::ios::binary);
-        createFile.close();
-        productFile.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        return 1;
     }
 
-    // if file still cannot be opened fail to initialise
-    if (!productFile.is_open()) 
+    // load the product name filter, rebuilding the names if it does not match the file
+    if (names.load(keysFilename, products.getCount()) && rebuildKeys())
     {
+        products.close();
         return 1;
     }
-
-    // initialize productCount
-    productFile.seekg(0, std::ios::end);
-    productCount = productFile.tellg()/sizeof(product);
-    productFile.seekg(0, std::ios::beg);
-
-    // initialize fileIndex to 0
-    fileIndex = 0; 
-    //initialize previouslyAccessedPosition to 0
-    previouslyAccessedPosition = 0; 
-    // initialize previouslyAccessed to 0
-    memset(previouslyAccessed, 0, sizeof(previouslyAccessed));  
-
     return 0;
 }
 
@@ -71,10 +73,12 @@ bool Product::initProduct()
 bool Product::uninitProduct()
 {
     // check the product file is open and if so close it 
-    if (productFile.is_open())
+    if (products.isOpen())
     {
-        productFile.close();
-        return 0;
+        // save the product name filter, so the next init does not scan the file
+        names.save(keysFilename);
+        names.clear();
+        return products.close();
     }
     else
     {
@@ -86,19 +90,16 @@ bool Product::uninitProduct()
 
 bool Product::writeProduct( product& readIn)
 {
-    // go to end of file
-    productFile.seekp(0, std::ios::end); 
     // add new product to end of file
-    productFile.write(reinterpret_cast<char*>(&readIn), sizeof(product)); 
-
     //return 1 if unable to write to product file
-    if(productFile.fail())
+    int64_t position = products.getCount();
+    if (products.write(position, readIn))
     {
         return 1;
     }
 
-    // increment productCount if added successfully
-    productCount++; 
+    // add the new product name
+    names.add(productKey(readIn.name), position);
     return 0;
 }
 
@@ -106,93 +107,101 @@ bool Product::writeProduct( product& readIn)
 
 bool Product::getNext(product& readInto)
 {
-    // read next product from file
-    productFile.seekg(fileIndex * sizeof(product), std::ios::beg);
-    productFile.read(reinterpret_cast<char*>(&readInto), sizeof(product));
-
-    // return 1 if data cannot be read
-    if (productFile.fail()) 
-    {
-        return 1;
-    }
-    // update file access indexes
-    previouslyAccessed[previouslyAccessedPosition] = fileIndex;
-    previouslyAccessedPosition = (previouslyAccessedPosition + 1) % 20;
-    fileIndex++;
-    return 0;   
+    // return 1 if there are no more products to read
+    return products.getNext(readInto);
 }
 
 //==================
 
 bool Product::getNext(product& readInto, product& filter )
 {
-    while (fileIndex < productCount) 
-    {
-        // read next product from file
-        productFile.seekg(fileIndex * sizeof(product), std::ios::beg);
-        productFile.read(reinterpret_cast<char*>(&readInto), sizeof(product));
+    // return 1 if there are no more products matching the filter
+    return products.getNext(readInto, filter);
+}
 
-        // return 1 if data cannot be read
-        if (productFile.fail()) 
-        {
-            return 1;
-        }
+//==================
 
-        // check if the current product record matches the filter
-        if (strlen(filter.name) == 0 || strcmp(readInto.name, filter.name) == 0)
-        {
-            // update file access indexes
-            previouslyAccessed[previouslyAccessedPosition] = fileIndex;
-            previouslyAccessedPosition = (previouslyAccessedPosition + 1) % 20;
-            fileIndex++;
-            return 0;
-        }
-        // if no match, increment index and continue while loop
-        fileIndex++;
-    }
-    return 1;
+int Product::getNextBatch(product* readInto, int maxCount, const product& filter)
+{
+    // read blocks of products until enough matches are found or the file ends
+    return products.getNextBatch(readInto, maxCount, filter);
+}
+
+// pack a product, its name without the terminating character
+void ProductTraits::pack(const product& element, char* bytes)
+{
+    packString(bytes, element.name, MAX_PRODUCT_NAME_SIZE);
+}
+
+void ProductTraits::unpack(const char* bytes, product& element)
+{
+    unpackString(bytes, element.name, MAX_PRODUCT_NAME_SIZE);
+}
+
+// check if a product matches the filter
+bool ProductTraits::matches(const product& element, const product& filter)
+{
+    return strlen(filter.name) == 0 || strcmp(element.name, filter.name) == 0;
 }
 
 //==================
 
 bool Product::select(product& readInto, int index, int menuCount)
 {
-    // error check the index, return 1 if not legal
-    if ((index <= 0) || (index > menuCount) || (index > 20)) 
+    // return 1 if the index is not legal or the product cannot be read
+    return products.select(readInto, index, menuCount);
+}
+
+//==================
+
+bool Product::findProduct(product& readInto, const char* name)
+{
+    // return 1 if product file is not open
+    if (!products.isOpen())
     {
         return 1;
     }
 
-    // return 1 if product file not open
-    if (productFile.fail()) 
+    // a name the filter does not hold is certainly new
+    std::string key = productKey(name);
+    if (!names.mayContain(key))
     {
         return 1;
     }
 
-    // find the index of the selected in the circular array
-    int64_t position = (previouslyAccessedPosition -1 + index - menuCount) % SIZE_OF_ACCESSED_INDEX_CACHE;
-    // seek and read the product
-    productFile.seekg(previouslyAccessed[position] * sizeof(product));
-    productFile.read(reinterpret_cast<char*>(&readInto), sizeof(product));
-
-    previouslyAccessedPosition = 0;
-    return 0;
+    // otherwise look the name up, building the hash map on the first lookup
+    int64_t position;
+    if ((!names.isExact() && rebuildKeys()) || names.find(key, position))
+    {
+        return 1;
+    }
+    return products.read(position, readInto);
 }
 
 //==================
 
-bool Product::seekToBeginning()
+bool Product::rebuildKeys()
 {
-    //return 1 if product file is not open
-    if (!productFile.is_open())
+    product element;
+    names.reset(products.getCount());
+    for (int64_t i = 0; i < products.getCount(); i++)
     {
-        return 1;
+        // return 1 if a product cannot be read
+        if (products.read(i, element))
+        {
+            names.clear();
+            return 1;
+        }
+        names.add(productKey(element.name), i);
     }
+    return 0;
+}
+
+//==================
 
+bool Product::seekToBeginning()
+{
     // go to the beginning of the product file
-    productFile.clear();
-    productFile.seekg(0, std::ios::beg);
-    // update fileIndex to 0
-    fileIndex = 0; // 
-    return 0;
+    //return 1 if product file is not open
+    return products.seekToBeginning();
 }
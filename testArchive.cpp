@@ -0,0 +1,290 @@
+/* testArchive.cpp
+description:
+This is a bottom-up test driver that tests the archive of the done and cancelled change items.
+The change items are checked against a model of every change item after each step: scans must read the change
+items left in the database file only, while readElement and countItems must still find the archived ones.
+Archives interrupted before and after their commit are simulated by leaving behind the files an archive writes.
+The test prints a PASS or FAIL verdict, and must be run in an empty directory.
+usage: testArchive
+version history:
+ver1 -26/10/17
+*/
+
+#include "ChangeItem.h"
+#include "Dictionary.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+const int ITEM_COUNT = 1000;
+const int8_t STATUSES[5] = {unreviewed, reviewed, inProgress, done, cancelled};
+
+std::vector<change_item> model; // every change item, at its ID less one
+std::vector<bool> archivedModel; // true for the change items archived
+
+/*
+-------------------------------------------------------------------------------------------------------------------------------------------------------------------
+Helper functions to assist with populating change items and checking them against the model
+*/
+
+change_item createItem(int number) {
+    change_item newItem;
+    newItem.status = STATUSES[number % 5];
+    newItem.priority = number % 3;
+    snprintf(newItem.product, MAX_PRODUCT_NAME_SIZE, "Prod%d", number % 7);
+    snprintf(newItem.release, MAX_RELEASE_ID_SIZE, "R%d", number % 4);
+    snprintf(newItem.description, MAX_DESCRIPTION_SIZE, "archived item number %d", number);
+    return newItem;
+}
+
+//========
+
+bool sameItem(const change_item& first, const change_item& second) {
+    return (first.id == second.id) && (first.status == second.status) && (first.priority == second.priority)
+        && !strcmp(first.product, second.product) && !strcmp(first.release, second.release)
+        && !strcmp(first.description, second.description);
+}
+
+//========
+
+void copyFile(const char* from, const char* to) {
+    std::ifstream source(from, std::ios::in | std::ios::binary);
+    std::ofstream target(to, std::ios::out | std::ios::binary | std::ios::trunc);
+    target << source.rdbuf();
+}
+
+//========
+
+// runs archive as the Archive program does, and marks the done and cancelled change items as archived
+bool archiveItems() {
+    if (Dictionary::initShared()) {
+        return 0;
+    }
+    bool failed = ChangeItemDatabase::archive();
+    failed = Dictionary::uninitShared() || failed;
+    for (size_t i = 0; i < model.size(); i++) {
+        if ((model[i].status == done) || (model[i].status == cancelled)) {
+            archivedModel[i] = 1;
+        }
+    }
+    return !failed;
+}
+
+//========
+
+// checks every change item against the model, through reads by ID, a scan, a filtered read and counts
+bool checkItems() {
+    if (ChangeItemDatabase::getChangeItemCount() != static_cast<int64_t>(model.size())) {
+        std::cout << "Change item count Failed" << std::endl;
+        return 0;
+    }
+
+    // every change item is read by its ID, archived or not
+    change_item readInto;
+    for (size_t i = 0; i < model.size(); i++) {
+        if (ChangeItemDatabase::readElement(readInto, model[i].id) || !sameItem(readInto, model[i])) {
+            std::cout << "Read by ID Failed for change item " << model[i].id << std::endl;
+            return 0;
+        }
+    }
+    if (!ChangeItemDatabase::readElement(readInto, 0) || !ChangeItemDatabase::readElement(readInto, model.size() + 1)) {
+        std::cout << "Read by ID of a missing change item Failed" << std::endl;
+        return 0;
+    }
+
+    // a scan reads the change items left in the database file, in order of ID
+    change_item page[16];
+    change_item everything;
+    size_t expected = 0;
+    int entries;
+    ChangeItemDatabase::seekToBeginning();
+    while ((entries = ChangeItemDatabase::getNextBatch(page, 16, everything)) > 0) {
+        for (int i = 0; i < entries; i++) {
+            while ((expected < model.size()) && archivedModel[expected]) {
+                expected++;
+            }
+            if ((expected == model.size()) || !sameItem(page[i], model[expected])) {
+                std::cout << "Scan Failed at change item " << page[i].id << std::endl;
+                return 0;
+            }
+            expected++;
+        }
+    }
+    while ((expected < model.size()) && archivedModel[expected]) {
+        expected++;
+    }
+    if (expected != model.size()) {
+        std::cout << "Scan Failed, change items missing" << std::endl;
+        return 0;
+    }
+
+    // a filtered read through the indexes, and counts from the tallies, archived change items counted
+    for (int s = 0; s < 5; s++) {
+        change_item filter;
+        filter.status = STATUSES[s];
+        int64_t live = 0;
+        int64_t all = 0;
+        for (size_t i = 0; i < model.size(); i++) {
+            if (model[i].status == STATUSES[s]) {
+                all++;
+                live += archivedModel[i] ? 0 : 1;
+            }
+        }
+        int64_t found = 0;
+        ChangeItemDatabase::seekToBeginning();
+        while (!ChangeItemDatabase::getNext(readInto, filter)) {
+            found++;
+        }
+        if ((found != live) || (ChangeItemDatabase::countItems(filter) != all)) {
+            std::cout << "Filtered read or count Failed for status " << int(STATUSES[s]) << std::endl;
+            return 0;
+        }
+    }
+    ChangeItemDatabase::seekToBeginning();
+    return 1;
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+bool unitTest() {
+    /*
+    Test 1: Change items written before any archive
+    */
+    if (ChangeItemDatabase::init()) {
+        std::cout << "Init Failed" << std::endl;
+        return 0;
+    }
+    for (int i = 0; i < ITEM_COUNT; i++) {
+        change_item newItem = createItem(i);
+        if (ChangeItemDatabase::writeElement(newItem)) {
+            std::cout << "Write Failed" << std::endl;
+            return 0;
+        }
+        model.push_back(newItem);
+        archivedModel.push_back(0);
+    }
+    if (!checkItems() || ChangeItemDatabase::uninit()) {
+        return 0;
+    }
+
+    /*
+    Test 2: Archive moves the done and cancelled change items, which keep their ID
+    Precondition: the database is uninitialised
+    */
+    if (!archiveItems() || ChangeItemDatabase::init() || !checkItems()) {
+        std::cout << "First archive Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 3: Archived change items cannot be updated, new change items take the next ID
+    */
+    change_item update = model[3];
+    update.status = inProgress;
+    change_item newItem = createItem(ITEM_COUNT);
+    if (!ChangeItemDatabase::writeElement(update) || ChangeItemDatabase::writeElement(newItem) || (newItem.id != ITEM_COUNT + 1)) {
+        std::cout << "Write after archive Failed" << std::endl;
+        return 0;
+    }
+    model.push_back(newItem);
+    archivedModel.push_back(0);
+
+    // close some change items left in the database file, for the next archive
+    for (int i = 0; i < ITEM_COUNT; i += 10) {
+        if (!archivedModel[i]) {
+            model[i].status = done;
+            if (ChangeItemDatabase::writeElement(model[i])) {
+                std::cout << "Update after archive Failed" << std::endl;
+                return 0;
+            }
+        }
+    }
+    if (!checkItems() || ChangeItemDatabase::uninit()) {
+        return 0;
+    }
+
+    /*
+    Test 4: A second archive adds to the first, redirects of both archives interleaving in order of ID
+    */
+    if (!archiveItems() || ChangeItemDatabase::init() || !checkItems() || ChangeItemDatabase::uninit()) {
+        std::cout << "Second archive Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 5: An archive interrupted before its commit is abandoned
+    Postcondition: the files it wrote are removed
+    */
+    copyFile("Change.dat", "Change.dat.arc");
+    copyFile("ChangeArchive.dat", "ChangeArchive.dat.arc");
+    if (ChangeItemDatabase::init() || !checkItems() || ChangeItemDatabase::uninit()
+        || std::ifstream("Change.dat.arc").is_open() || std::ifstream("ChangeArchive.dat.arc").is_open()) {
+        std::cout << "Recovery before commit Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 6: An archive interrupted after its commit is completed
+    Precondition: the old database and description files are put back beside the files replacing them
+    */
+    if (ChangeItemDatabase::init()) {
+        return 0;
+    }
+    for (int i = 1; i < ITEM_COUNT; i += 10) {
+        if (!archivedModel[i]) {
+            model[i].status = cancelled;
+            ChangeItemDatabase::writeElement(model[i]);
+        }
+    }
+    if (ChangeItemDatabase::uninit()) {
+        return 0;
+    }
+    copyFile("Change.dat", "Change.old");
+    copyFile("ChangeDescription.dat", "ChangeDescription.old");
+    copyFile("Change.idx", "Change.idx.old");
+    copyFile("ChangeZone.idx", "ChangeZone.idx.old");
+    if (!archiveItems()) {
+        return 0;
+    }
+    std::rename("Change.dat", "Change.dat.arc");
+    std::rename("ChangeDescription.dat", "ChangeDescription.dat.arc");
+    std::rename("Change.old", "Change.dat");
+    std::rename("ChangeDescription.old", "ChangeDescription.dat");
+    std::rename("Change.idx.old", "Change.idx");
+    std::rename("ChangeZone.idx.old", "ChangeZone.idx");
+    if (ChangeItemDatabase::init() || !checkItems() || ChangeItemDatabase::uninit()) {
+        std::cout << "Recovery after commit Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 7: Tallies rebuilt from the database file and the archive
+    */
+    std::remove("ChangeTally.idx");
+    if (ChangeItemDatabase::init() || !checkItems() || ChangeItemDatabase::uninit()) {
+        std::cout << "Tally rebuild Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 8: An archive with nothing to move leaves the files as they are
+    */
+    if (!archiveItems() || ChangeItemDatabase::init() || !checkItems() || ChangeItemDatabase::uninit()) {
+        std::cout << "Empty archive Failed" << std::endl;
+        return 0;
+    }
+    return 1;
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+int main() {
+    if (unitTest()) {
+        std::cout << "Pass" << std::endl;
+        return 0;
+    }
+    std::cout << "Fail" << std::endl;
+    return 1;
+}
@@ -0,0 +1,215 @@
+/* testCompressedBitmap.cpp
+description:
+This is a bottom-up test driver that tests the compressed bitmaps of the database indexes.
+Positions are set and cleared in a bitmap and in a std::set holding the same positions, and the positions
+visited by forEach and stepped through by next are compared with the set. The positions are placed on both
+sides of the chunk boundaries, and a chunk is grown past BITMAP_LIST_LIMIT positions so it is stored as bits,
+then shrunk to half of that so it is stored as a list again.
+The test prints a PASS or FAIL verdict.
+usage: testCompressedBitmap
+version history:
+ver1 -26/10/17
+*/
+
+#include "CompressedBitmap.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+std::mt19937 generator(2017);
+
+/*
+-------------------------------------------------------------------------------------------------------------------------------------------------------------------
+Helper functions to assist with comparing a bitmap with the set of positions it should hold
+*/
+
+// checks forEach visits the positions of the set in order, and next steps through them and finds them from any position
+bool holds(const CompressedBitmap& bitmap, const std::set<int64_t>& expected) {
+    std::vector<int64_t> visited;
+    bitmap.forEach([&visited](int64_t position) { visited.push_back(position); });
+    if (visited != std::vector<int64_t>(expected.begin(), expected.end())) {
+        return 0;
+    }
+
+    std::vector<int64_t> stepped;
+    for (int64_t position = bitmap.next(-1); position != -1; position = bitmap.next(position + 1)) {
+        stepped.push_back(position);
+    }
+    if (stepped != visited) {
+        return 0;
+    }
+
+    // next from the positions around each set position and chunk boundary
+    std::vector<int64_t> probes;
+    for (std::set<int64_t>::const_iterator position = expected.begin(); position != expected.end(); position++) {
+        probes.push_back(*position - 1);
+        probes.push_back(*position);
+        probes.push_back(*position + 1);
+    }
+    for (int64_t chunk = 0; chunk < 6; chunk++) {
+        probes.push_back(chunk * BITMAP_CHUNK_SIZE - 1);
+        probes.push_back(chunk * BITMAP_CHUNK_SIZE);
+    }
+    for (size_t i = 0; i < probes.size(); i++) {
+        std::set<int64_t>::const_iterator found = expected.lower_bound(probes[i] < 0 ? 0 : probes[i]);
+        if (bitmap.next(probes[i]) != (found == expected.end() ? -1 : *found)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//========
+
+// sets a position in the bitmap and the set
+void setBoth(CompressedBitmap& bitmap, std::set<int64_t>& expected, int64_t position) {
+    bitmap.set(position);
+    expected.insert(position);
+}
+
+//========
+
+// clears a position from the bitmap and the set
+void clearBoth(CompressedBitmap& bitmap, std::set<int64_t>& expected, int64_t position) {
+    bitmap.clear(position);
+    expected.erase(position);
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+bool unitTest() {
+    CompressedBitmap bitmap;
+    std::set<int64_t> expected;
+
+    /*
+    Test 1: An empty bitmap holds no positions, and clearing a position it does not hold leaves it empty
+    */
+    bitmap.clear(5);
+    if (!holds(bitmap, expected) || (bitmap.next(0) != -1)) {
+        std::cout << "Empty bitmap Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 2: Positions on both sides of the chunk boundaries, with a chunk holding none between them
+    Postcondition: next passes from the end of a chunk to the first position of the next chunk stored
+    */
+    const int64_t edges[] = {0, BITMAP_CHUNK_SIZE - 1, BITMAP_CHUNK_SIZE, 2 * BITMAP_CHUNK_SIZE - 1, 4 * BITMAP_CHUNK_SIZE, 5 * BITMAP_CHUNK_SIZE - 1};
+    for (int64_t position : edges) {
+        setBoth(bitmap, expected, position);
+    }
+    bitmap.set(BITMAP_CHUNK_SIZE); // set twice
+    if (!holds(bitmap, expected) || (bitmap.next(2 * BITMAP_CHUNK_SIZE) != 4 * BITMAP_CHUNK_SIZE)) {
+        std::cout << "Chunk boundaries Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 3: A chunk listing BITMAP_LIST_LIMIT positions, then one more so it is stored as bits
+    Precondition: chunk 1 holds its first and last position
+    */
+    int64_t start = BITMAP_CHUNK_SIZE;
+    for (int64_t i = 1; (int)expected.size() - 4 < BITMAP_LIST_LIMIT; i++) {
+        setBoth(bitmap, expected, start + 3 * i);
+    }
+    if (!holds(bitmap, expected)) {
+        std::cout << "Full list Failed" << std::endl;
+        return 0;
+    }
+    setBoth(bitmap, expected, start + 3 * (BITMAP_LIST_LIMIT + 1));
+    if (!holds(bitmap, expected)) {
+        std::cout << "Promotion to bits Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 4: Positions set and cleared in a chunk stored as bits, in the first and last word of the chunk
+    */
+    setBoth(bitmap, expected, start + 1);
+    setBoth(bitmap, expected, start + 62);
+    setBoth(bitmap, expected, start + 64);
+    setBoth(bitmap, expected, 2 * BITMAP_CHUNK_SIZE - 2);
+    clearBoth(bitmap, expected, start + 3);
+    clearBoth(bitmap, expected, 2 * BITMAP_CHUNK_SIZE - 1);
+    bitmap.clear(start + 2); // not held
+    if (!holds(bitmap, expected)) {
+        std::cout << "Bits update Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 5: A chunk of bits shrunk to half of BITMAP_LIST_LIMIT positions, so it is listed again, then grown back to bits
+    */
+    std::vector<int64_t> chunkPositions;
+    for (int64_t position = bitmap.next(start); (position != -1) && (position < 2 * BITMAP_CHUNK_SIZE); position = bitmap.next(position + 1)) {
+        chunkPositions.push_back(position);
+    }
+    std::shuffle(chunkPositions.begin(), chunkPositions.end(), generator);
+    size_t cleared = 0;
+    while (chunkPositions.size() - cleared > static_cast<size_t>(BITMAP_LIST_LIMIT / 2 + 1)) {
+        clearBoth(bitmap, expected, chunkPositions[cleared++]);
+    }
+    if (!holds(bitmap, expected)) {
+        std::cout << "Shrunk bits Failed" << std::endl;
+        return 0;
+    }
+    clearBoth(bitmap, expected, chunkPositions[cleared++]);
+    if (!holds(bitmap, expected)) {
+        std::cout << "Demotion to list Failed" << std::endl;
+        return 0;
+    }
+    for (int64_t i = 0; (int)expected.size() - 4 <= BITMAP_LIST_LIMIT; i++) {
+        setBoth(bitmap, expected, start + 2 + 3 * i);
+    }
+    if (!holds(bitmap, expected)) {
+        std::cout << "Second promotion to bits Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 6: Clearing every position of a chunk removes it, next passing over it
+    */
+    for (int64_t position = bitmap.next(start); (position != -1) && (position < 2 * BITMAP_CHUNK_SIZE); position = bitmap.next(position + 1)) {
+        clearBoth(bitmap, expected, position);
+    }
+    if (!holds(bitmap, expected) || (bitmap.next(start) != 4 * BITMAP_CHUNK_SIZE)) {
+        std::cout << "Emptied chunk Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 7: Random sets and clears over three chunks, some dense enough to be stored as bits
+    */
+    for (int round = 0; round < 40; round++) {
+        for (int i = 0; i < 1000; i++) {
+            int64_t chunk = generator() % 3;
+            int64_t span = (chunk == 0) ? 6000 : ((chunk == 1) ? 20000 : BITMAP_CHUNK_SIZE);
+            int64_t position = chunk * BITMAP_CHUNK_SIZE + static_cast<int64_t>(generator() % span);
+            if ((round < 20) ? (generator() % 4 != 0) : (generator() % 4 == 0)) {
+                setBoth(bitmap, expected, position);
+            }
+            else {
+                clearBoth(bitmap, expected, position);
+            }
+        }
+        if (!holds(bitmap, expected)) {
+            std::cout << "Random updates Failed in round " << round << std::endl;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+int main() {
+    if (unitTest()) {
+        std::cout << "Pass" << std::endl;
+        return 0;
+    }
+    std::cout << "Fail" << std::endl;
+    return 1;
+}
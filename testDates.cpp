@@ -0,0 +1,213 @@
+/* testDates.cpp
+description:
+This is a bottom-up test driver that tests the integer dates and the queries ranging over them.
+Dates of the calendar are converted to days and back, across leap days, century years, the epoch and the
+years before it, and strings that are not dates of the calendar are refused. Change requests are then read
+through the request date index by ranges of dates, a batch at a time, and releases are read by the day
+they are dated before.
+The test prints a PASS or FAIL verdict, and must be run in an empty directory.
+usage: testDates
+version history:
+ver1 -26/10/17
+*/
+
+#include "ChangeRequest.h"
+#include "Date.h"
+#include "Release.h"
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const int REQUEST_COUNT = 7;
+// dates of the change requests written, the change item ID of each being its place in the list from 1
+const char* REQUEST_DATES[REQUEST_COUNT] = {"2026-10-17", "1969-12-31", "2026-10-16", "", "2026-10-16", "2026-10-18", "2000-02-29"};
+
+const int RELEASE_COUNT = 5;
+const char* RELEASE_DATES[RELEASE_COUNT] = {"2026-10-16", "2026-10-17", "2026-10-18", "", "1969-12-31"};
+
+/*
+-------------------------------------------------------------------------------------------------------------------------------------------------------------------
+Helper functions to assist with checking dates and reading the ranges
+*/
+
+// checks a date converts to its days and the days back to the date
+bool roundTrip(const char* date, int32_t days) {
+    char converted[DATE_SIZE];
+    daysToDate(days, converted);
+    return (dateToDays(date) == days) && !strcmp(converted, date);
+}
+
+//========
+
+// reads every change request of a range in batches of up to maxCount, checking their change item IDs in order
+bool readRange(const char* from, const char* to, int maxCount, const std::vector<int32_t>& expected) {
+    change_request batch[REQUEST_COUNT];
+    std::vector<int32_t> ids;
+    ChangeRequestDatabase::seekToBeginning();
+    int found;
+    while ((found = ChangeRequestDatabase::getNextByDate(batch, maxCount, from, to)) > 0) {
+        if (found > maxCount) {
+            return 0;
+        }
+        for (int i = 0; i < found; i++) {
+            ids.push_back(batch[i].changeItemId);
+        }
+    }
+    return ids == expected;
+}
+
+//========
+
+// reads every release dated before a date, checking their release ids in order
+bool readReleasedBefore(const char* date, const std::vector<std::string>& expected) {
+    release batch[RELEASE_COUNT];
+    release filter;
+    std::vector<std::string> ids;
+    Release::seekToBeginning();
+    int found;
+    while ((found = Release::getNextReleasedBefore(batch, RELEASE_COUNT, date, filter)) > 0) {
+        for (int i = 0; i < found; i++) {
+            ids.push_back(batch[i].releaseId);
+        }
+    }
+    return ids == expected;
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+bool unitTest() {
+    /*
+    Test 1: Dates convert to the days since 1970-01-01 and back
+    Postcondition: leap days, 1900 and 2000, the epoch and dates before it, and the first and last dates round trip
+    */
+    if (!roundTrip("1970-01-01", 0) || !roundTrip("1969-12-31", -1) || !roundTrip("1900-01-01", -25567)
+        || !roundTrip("1900-02-28", -25509) || !roundTrip("1900-03-01", -25508) || !roundTrip("2000-02-29", 11016)
+        || !roundTrip("2000-03-01", 11017) || !roundTrip("2024-02-29", 19782) || !roundTrip("0000-01-01", -719528)
+        || !roundTrip("9999-12-31", 2932896)) {
+        std::cout << "Round trip Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 2: Every day from 0000-01-01 to 9999-12-31 round trips, each date following the date of the day before
+    */
+    char previous[DATE_SIZE] = "";
+    for (int32_t days = -719528; days <= 2932896; days++) {
+        char date[DATE_SIZE];
+        daysToDate(days, date);
+        if ((dateToDays(date) != days) || (strcmp(previous, date) >= 0)) {
+            std::cout << "Round trip of day " << days << " Failed" << std::endl;
+            return 0;
+        }
+        strcpy(previous, date);
+    }
+
+    /*
+    Test 3: Strings that are not dates of the calendar are refused, and days outside the calendar give the empty date
+    */
+    const char* refused[] = {"2026-02-30", "2026-13-01", "2026-00-10", "2026-04-31", "1900-02-29", "2026-1-01", "2026/01/01", "abcd-ef-gh", ""};
+    for (const char* date : refused) {
+        if (dateToDays(date) != NO_DATE) {
+            std::cout << "Refusing " << date << " Failed" << std::endl;
+            return 0;
+        }
+    }
+    char date[DATE_SIZE];
+    daysToDate(NO_DATE, date);
+    char before[DATE_SIZE];
+    daysToDate(-719529, before);
+    char after[DATE_SIZE];
+    daysToDate(2932897, after);
+    if (strcmp(date, "") || strcmp(before, "") || strcmp(after, "")) {
+        std::cout << "Empty date Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 4: A range of dates reads its change requests in order of date, the first and last days included
+    Precondition: the change requests are written out of date order, one of them without a date
+    */
+    if (ChangeRequestDatabase::init()) {
+        std::cout << "Init Failed" << std::endl;
+        return 0;
+    }
+    for (int i = 0; i < REQUEST_COUNT; i++) {
+        change_request request;
+        request.changeItemId = i + 1;
+        request.requesterId = 1;
+        strcpy(request.requestDate, REQUEST_DATES[i]);
+        if (ChangeRequestDatabase::writeElement(request)) {
+            std::cout << "Writing request " << i + 1 << " Failed" << std::endl;
+            return 0;
+        }
+    }
+    if (!readRange("2026-10-16", "2026-10-17", REQUEST_COUNT, {3, 5, 1})) {
+        std::cout << "Inclusive range Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 5: Ranges holding no change requests, ending before they start, or with a day not on the calendar read nothing
+    */
+    if (!readRange("2026-10-19", "2026-12-31", REQUEST_COUNT, {}) || !readRange("2026-10-17", "2026-10-16", REQUEST_COUNT, {})
+        || !readRange("2026-02-30", "2026-12-31", REQUEST_COUNT, {}) || !readRange("2026-01-01", "2026-13-01", REQUEST_COUNT, {})) {
+        std::cout << "Empty range Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 6: A limit splitting the requests of a day reads them across calls, and open ranges read every dated request
+    Postcondition: the change request without a date is not read
+    */
+    if (!readRange("2026-10-16", "2026-10-17", 1, {3, 5, 1}) || !readRange("2026-10-16", "2026-10-17", 2, {3, 5, 1})
+        || !readRange("", "", 2, {2, 7, 3, 5, 1, 6}) || !readRange("", "1999-12-31", 3, {2}) || !readRange("2026-10-17", "", 3, {1, 6})) {
+        std::cout << "Batched range Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 7: The date index read back at init gives the same ranges
+    */
+    if (ChangeRequestDatabase::uninit() || ChangeRequestDatabase::init() || !readRange("", "", 4, {2, 7, 3, 5, 1, 6})
+        || ChangeRequestDatabase::uninit()) {
+        std::cout << "Reopened date index Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 8: Releases dated before a day are read, those dated on the day, after it or without a date are not
+    */
+    if (Release::initRelease()) {
+        std::cout << "Release init Failed" << std::endl;
+        return 0;
+    }
+    for (int i = 0; i < RELEASE_COUNT; i++) {
+        release newRelease;
+        strcpy(newRelease.name, "Product");
+        strcpy(newRelease.date, RELEASE_DATES[i]);
+        newRelease.releaseId[0] = static_cast<char>('1' + i);
+        newRelease.releaseId[1] = '\0';
+        if (Release::writeRelease(newRelease)) {
+            std::cout << "Writing release " << i + 1 << " Failed" << std::endl;
+            return 0;
+        }
+    }
+    if (!readReleasedBefore("2026-10-17", {"1", "5"}) || !readReleasedBefore("2026-10-18", {"1", "2", "5"})
+        || !readReleasedBefore("1969-12-31", {}) || !readReleasedBefore("1970-01-01", {"5"}) || !readReleasedBefore("2026-13-01", {})) {
+        std::cout << "Released before Failed" << std::endl;
+        return 0;
+    }
+    return !Release::uninitRelease();
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+int main() {
+    if (unitTest()) {
+        std::cout << "Pass" << std::endl;
+        return 0;
+    }
+    std::cout << "Fail" << std::endl;
+    return 1;
+}
@@ -3,6 +3,8 @@ description:
 This is a bottom-up test driver that aims to test the functionality of reading from and writing to our Requester Database, accessed using our Requester module functions
 The test tests multiple functions and returns a Pass/ Fail verdict based on whether or not they function as they are intended to. 
 version history:
+ver2 -26/10/17
+    -added test for findById
 ver1 -24/07/16, original by Puja Shah
 */
 
@@ -136,9 +138,27 @@ void unitTest() {
     }
 
 
+    /*
+    Test 5: Finding requesters by id
+    Preconditions: Requesters are written to the file successfully
+    Postcondition: findById returns the requester with the given id, and fails for an id that was never written
+    */
+    if (RequesterDatabase::findById(readReq, req2.requesterId) ||
+        readReq.requesterId != req2.requesterId ||
+        strcmp(readReq.name, req2.name) != 0 ||
+        RequesterDatabase::findById(readReq, req1.requesterId) ||
+        readReq.requesterId != req1.requesterId ||
+        strcmp(readReq.name, req1.name) != 0 ||
+        !RequesterDatabase::findById(readReq, 3)) {
+        std::cout << "Find By Id Failed" << std::endl;
+        std::cout << "Fail" << std::endl;
+        return;
+    }
+
+
     // Uninitialize database
     /*
-    Test 5: Testing uninitialization
+    Test 6: Testing uninitialization
     Preconditions: Database is initialized
     Postcondition: Database is successfully uninitialized
     */
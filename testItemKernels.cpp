@@ -0,0 +1,124 @@
+/* testItemKernels.cpp
+description:
+This is a bottom-up test driver that tests the kernels checking blocks of packed change items for a filter.
+Every kernel the processor can run, AVX2, SSE2 and scalar, is given random blocks of every length from 0 to 64
+with random filter codes, and the mask it gives is compared with mayMatch checking each change item of the block.
+The fields of the packed change items are drawn from a few values, so the filters match some of them.
+The test prints a PASS or FAIL verdict.
+usage: testItemKernels
+version history:
+ver1 -26/10/17
+*/
+
+#include "ChangeItem.h"
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+const int BLOCKS_PER_LENGTH = 2000; // random blocks checked for each block length
+const int MAX_BLOCK_LENGTH = 64;
+const ChangeItemKernel KERNELS[3] = {avx2Kernel, sse2Kernel, scalarKernel};
+const char* KERNEL_NAMES[3] = {"AVX2", "SSE2", "scalar"};
+const int8_t STATUSES[5] = {unreviewed, reviewed, inProgress, done, cancelled};
+
+std::mt19937 generator(2017);
+
+/*
+-------------------------------------------------------------------------------------------------------------------------------------------------------------------
+Helper functions to assist with building random blocks and filter codes
+*/
+
+// a field value, mostly one of a few small values, sometimes any value including negative ones
+int32_t randomValue() {
+    if (generator() % 4 == 0) {
+        return static_cast<int32_t>(generator());
+    }
+    return static_cast<int32_t>(generator() % 4);
+}
+
+//========
+
+// packs a change item of random field values, the status and priority taking the byte of a random value
+void packRandomItem(char* bytes) {
+    packInt(bytes, randomValue(), 4);
+    packInt(bytes, (generator() % 2) ? STATUSES[generator() % 5] : randomValue(), 1);
+    packInt(bytes, randomValue(), 1);
+    packInt(bytes, randomValue(), 4);
+    packInt(bytes, randomValue(), 4);
+}
+
+//========
+
+// codes of a random filter: each field not filtered on (-1), filtered on a value no element holds (-2), or on a value
+void randomCodes(int32_t* codes) {
+    for (int i = 0; i < ChangeItemTraits::FILTER_CODES; i++) {
+        int kind = generator() % 4;
+        codes[i] = (kind == 0) ? -1 : ((kind == 1) ? -2 : randomValue());
+    }
+
+    // the status code is a set of status bits
+    if (codes[1] >= 0) {
+        codes[1] = static_cast<int32_t>(generator() % 32);
+    }
+}
+
+//========
+
+// mask of the change items of a block mayMatch does not rule out
+uint64_t expectedMask(const char* bytes, int count, const int32_t* codes) {
+    uint64_t mask = 0;
+    for (int i = 0; i < count; i++) {
+        mask |= uint64_t(ChangeItemTraits::mayMatch(bytes + ChangeItemTraits::RECORD_SIZE * i, codes)) << i;
+    }
+    return mask;
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+bool unitTest() {
+    std::vector<char> block(ChangeItemTraits::RECORD_SIZE * MAX_BLOCK_LENGTH);
+    int32_t codes[ChangeItemTraits::FILTER_CODES];
+
+    for (int k = 0; k < 3; k++) {
+        /*
+        Test 1 to 3: Each kernel, and the kernel chosen for the processor, give the mask of mayMatch for every block length
+        Precondition: the processor can run the kernel, otherwise the kernel is skipped
+        */
+        if (!ChangeItemTraits::hasKernel(KERNELS[k])) {
+            std::cout << KERNEL_NAMES[k] << " kernel not available, skipped" << std::endl;
+            continue;
+        }
+        for (int count = 0; count <= MAX_BLOCK_LENGTH; count++) {
+            for (int b = 0; b < BLOCKS_PER_LENGTH; b++) {
+                char* bytes = block.data();
+                for (int i = 0; i < count; i++) {
+                    packRandomItem(bytes);
+                }
+                randomCodes(codes);
+                uint64_t expected = expectedMask(block.data(), count, codes);
+                if (ChangeItemTraits::mayMatchBlock(block.data(), count, codes, KERNELS[k]) != expected) {
+                    std::cout << KERNEL_NAMES[k] << " kernel Failed for a block of " << count << " change items" << std::endl;
+                    return 0;
+                }
+                if (ChangeItemTraits::mayMatchBlock(block.data(), count, codes) != expected) {
+                    std::cout << "Kernel chosen for the processor Failed for a block of " << count << " change items" << std::endl;
+                    return 0;
+                }
+            }
+        }
+        std::cout << KERNEL_NAMES[k] << " kernel passed" << std::endl;
+    }
+    return 1;
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+int main() {
+    if (unitTest()) {
+        std::cout << "Pass" << std::endl;
+        return 0;
+    }
+    std::cout << "Fail" << std::endl;
+    return 1;
+}
@@ -0,0 +1,169 @@
+/* testLargeFile.cpp
+description:
+This is a bottom-up test driver that tests a change request file larger than 4 GB through RecordStore.
+The file is extended past 4 GB without writing the records in between, so it is sparse and takes little
+space on file systems supporting sparse files. Those records read back as zero bytes.
+Marked requests are written where the file offset passes 2 GB, 4 GB and at the end of the file, and
+every test reads them back, with both backends, through reads by position, a filtered scan and select.
+The test prints a PASS or FAIL verdict, and must be run in an empty directory.
+usage: testLargeFile
+version history:
+ver1 -26/10/17
+*/
+
+#include "ChangeRequest.h"
+#include "Dictionary.h"
+#include "RecordStore.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+const char* LARGE_FILENAME = "Large.dat";
+const int64_t LARGE_FILE_SIZE = int64_t(5) << 30; // size the file is extended to
+const int64_t LARGE_COUNT = (LARGE_FILE_SIZE - RECORD_HEADER_SIZE) / ChangeRequestTraits::RECORD_SIZE; // records in the file
+const int MARKED_COUNT = 3;
+const int64_t MARKED_POSITIONS[MARKED_COUNT] = {
+    (int64_t(1) << 31) / ChangeRequestTraits::RECORD_SIZE + 1, // first record past 2 GB
+    (int64_t(1) << 32) / ChangeRequestTraits::RECORD_SIZE + 1, // first record past 4 GB
+    LARGE_COUNT - 1 // last record
+};
+
+/*
+-------------------------------------------------------------------------------------------------------------------------------------------------------------------
+Helper functions to assist with building and checking the large file
+*/
+
+// marked request, with a requesterId past the range of 16 bits
+change_request createMarked(int number) {
+    change_request marked;
+    marked.changeItemId = 7000000 + number;
+    marked.requesterId = 100000 + number;
+    strcpy(marked.requestDate, "2026-10-17");
+    strcpy(marked.release, "Large");
+    return marked;
+}
+
+//========
+
+bool sameRequest(const change_request& first, const change_request& second) {
+    return (first.changeItemId == second.changeItemId) && (first.requesterId == second.requesterId)
+        && !strcmp(first.requestDate, second.requestDate) && !strcmp(first.release, second.release);
+}
+
+//========
+
+// creates the file through RecordStore, then extends it to LARGE_FILE_SIZE and sets the record count in its header
+bool buildLargeFile() {
+    std::remove(LARGE_FILENAME);
+    RecordStore<change_request, ChangeRequestTraits> store;
+    if (store.open(LARGE_FILENAME)) {
+        return 0;
+    }
+    change_request first = createMarked(-1);
+    bool failed = store.write(0, first);
+    failed = store.close() || failed;
+    if (failed) {
+        return 0;
+    }
+
+    std::fstream file(LARGE_FILENAME, std::ios::in | std::ios::out | std::ios::binary);
+    char count[8];
+    char* field = count;
+    packInt(field, LARGE_COUNT, 8);
+    file.seekp(RECORD_MAGIC_SIZE + 4 + 4);
+    file.write(count, 8);
+    char last = 0;
+    file.seekp(LARGE_FILE_SIZE - 1);
+    file.write(&last, 1);
+    file.close();
+    return !file.fail();
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+bool unitTest(StorageBackend backend) {
+    RecordStore<change_request, ChangeRequestTraits> store;
+
+    /*
+    Test 1: The record count of a file past 4 GB is read from its header
+    */
+    if (store.open(LARGE_FILENAME, backend) || (store.getCount() != LARGE_COUNT)) {
+        std::cout << "Open of large file Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 2: Writes and reads by position past 2 GB and 4 GB reach their own records
+    Postcondition: the records before each marked record are still zero bytes
+    */
+    for (int i = 0; i < MARKED_COUNT; i++) {
+        change_request marked = createMarked(i);
+        change_request readInto;
+        change_request before;
+        if (store.write(MARKED_POSITIONS[i], marked) || store.read(MARKED_POSITIONS[i], readInto) || !sameRequest(readInto, marked)) {
+            std::cout << "Read by position Failed at record " << MARKED_POSITIONS[i] << std::endl;
+            return 0;
+        }
+        if (store.read(MARKED_POSITIONS[i] - 1, before) || (before.changeItemId != 0) || (before.requesterId != 0)) {
+            std::cout << "Write reached the wrong record at " << MARKED_POSITIONS[i] << std::endl;
+            return 0;
+        }
+    }
+
+    /*
+    Test 3: A filtered scan of the whole file finds each marked record at its position
+    */
+    store.seekToBeginning();
+    for (int i = 0; i < MARKED_COUNT; i++) {
+        change_request filter;
+        filter.requesterId = 100000 + i;
+        change_request readInto;
+        if (store.getNext(readInto, filter) || !sameRequest(readInto, createMarked(i)) || (store.getPosition() != MARKED_POSITIONS[i] + 1)) {
+            std::cout << "Filtered scan Failed at record " << MARKED_POSITIONS[i] << std::endl;
+            return 0;
+        }
+        store.seekToBeginning();
+        store.setPosition(MARKED_POSITIONS[i]);
+    }
+
+    /*
+    Test 4: select returns the records read past 4 GB
+    Precondition: the last marked records were read by getNext
+    */
+    store.seekToBeginning();
+    store.setPosition(MARKED_POSITIONS[1]);
+    change_request readInto;
+    store.getNext(readInto);
+    store.setPosition(MARKED_POSITIONS[2]);
+    store.getNext(readInto);
+    change_request selected;
+    if (store.select(selected, 1, 2) || !sameRequest(selected, createMarked(1))
+        || store.select(selected, 2, 2) || !sameRequest(selected, createMarked(2))) {
+        std::cout << "Select Failed" << std::endl;
+        return 0;
+    }
+
+    return !store.close();
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+int main() {
+    // releases are packed as ids of the shared dictionary
+    if (Dictionary::initShared()) {
+        std::cout << "Fail" << std::endl;
+        return 1;
+    }
+
+    bool passed = buildLargeFile() && unitTest(streamBackend) && unitTest(mappedBackend);
+    Dictionary::uninitShared();
+    std::remove(LARGE_FILENAME);
+
+    if (passed) {
+        std::cout << "Pass" << std::endl;
+        return 0;
+    }
+    std::cout << "Fail" << std::endl;
+    return 1;
+}
@@ -0,0 +1,150 @@
+/* testRequestTransaction.cpp
+description:
+This is a bottom-up test driver that tests the commit of a change request with the requester and change item it creates.
+A write is made to fail part way through a commit by staging a request dated on a day not on the calendar, so the
+commit is aborted after the requester and change item were written, encoding a new product and release. The records
+must then be missing, and once committed by a retry with the date corrected, every string must read back after the
+databases and the log are reopened.
+The test prints a PASS or FAIL verdict, and must be run in an empty directory.
+usage: testRequestTransaction
+version history:
+ver1 -26/10/17
+*/
+
+#include "RequestTransaction.h"
+#include "WriteAheadLog.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+/*
+-------------------------------------------------------------------------------------------------------------------------------------------------------------------
+Helper functions to assist with staging records and opening the databases
+*/
+
+bool openAll() {
+    return !WriteAheadLog::init() && !RequesterDatabase::init() && !ChangeItemDatabase::init() && !ChangeRequestDatabase::init();
+}
+
+//========
+
+bool closeAll() {
+    bool failed = RequesterDatabase::uninit();
+    failed = ChangeItemDatabase::uninit() || failed;
+    failed = ChangeRequestDatabase::uninit() || failed;
+    return !(WriteAheadLog::uninit() || failed);
+}
+
+//========
+
+// request of a product and release given by number
+change_request createRequest(int number, const char* date) {
+    change_request newRequest;
+    strcpy(newRequest.requestDate, date);
+    snprintf(newRequest.release, MAX_RELEASE_ID_SIZE, "NewRel%d", number);
+    return newRequest;
+}
+
+//========
+
+// stages a request creating its requester and change item, of a product and release given by number
+void stageRecords(int number, const char* date) {
+    requester newRequester;
+    snprintf(newRequester.name, MAX_REQUESTER_NAME_SIZE, "Requester %d", number);
+    snprintf(newRequester.email, MAX_EMAIL_SIZE, "req%d@mail.com", number);
+    strcpy(newRequester.phone, "6041234567");
+
+    change_item newItem;
+    newItem.status = unreviewed;
+    newItem.priority = middle;
+    snprintf(newItem.product, MAX_PRODUCT_NAME_SIZE, "NewProd%d", number);
+    snprintf(newItem.release, MAX_RELEASE_ID_SIZE, "NewRel%d", number);
+    snprintf(newItem.description, MAX_DESCRIPTION_SIZE, "item of request %d", number);
+
+    RequestTransaction::begin();
+    RequestTransaction::stageRequester(newRequester);
+    RequestTransaction::stageItem(newItem);
+    RequestTransaction::stageRequest(createRequest(number, date));
+}
+
+//========
+
+// checks the change item and request of an ID hold the product and release of a number
+bool checkRecords(int32_t id, int number) {
+    char product[MAX_PRODUCT_NAME_SIZE];
+    char release[MAX_RELEASE_ID_SIZE];
+    snprintf(product, MAX_PRODUCT_NAME_SIZE, "NewProd%d", number);
+    snprintf(release, MAX_RELEASE_ID_SIZE, "NewRel%d", number);
+
+    change_item readItem;
+    if (ChangeItemDatabase::readElement(readItem, id) || strcmp(readItem.product, product) || strcmp(readItem.release, release)) {
+        return 0;
+    }
+    change_request filter;
+    filter.changeItemId = id;
+    change_request readRequest;
+    ChangeRequestDatabase::seekToBeginning();
+    return !ChangeRequestDatabase::getNext(readRequest, filter) && !strcmp(readRequest.release, release);
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+bool unitTest() {
+    /*
+    Test 1: A commit whose change request cannot be written is aborted, the change request database staying open
+    Postcondition: the requester and change item written before it are missing
+    */
+    if (!openAll()) {
+        std::cout << "Init Failed" << std::endl;
+        return 0;
+    }
+    stageRecords(1, "2026-02-30");
+    if (!RequestTransaction::commit() || (RequesterDatabase::getRequesterCount() != 0) || (ChangeItemDatabase::getChangeItemCount() != 0)) {
+        std::cout << "Aborted commit Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 2: The retried commit writes every record, with the product and release encoded by the aborted commit
+    Precondition: the requester and change item are still staged, the request is staged again with a calendar date
+    */
+    RequestTransaction::stageRequest(createRequest(1, "2026-02-28"));
+    if (RequestTransaction::commit() || (RequesterDatabase::getRequesterCount() != 1) || (ChangeItemDatabase::getChangeItemCount() != 1)
+        || !checkRecords(1, 1)) {
+        std::cout << "Retried commit Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 3: A commit after the abort, of new strings, is unaffected
+    */
+    stageRecords(2, "2026-10-17");
+    if (RequestTransaction::commit() || !checkRecords(2, 2)) {
+        std::cout << "Commit after abort Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 4: Every record and string reads back once the databases and the log are reopened
+    */
+    if (!closeAll() || !openAll()) {
+        std::cout << "Reopen Failed" << std::endl;
+        return 0;
+    }
+    if ((RequesterDatabase::getRequesterCount() != 2) || !checkRecords(1, 1) || !checkRecords(2, 2)) {
+        std::cout << "Read after reopen Failed" << std::endl;
+        return 0;
+    }
+    return closeAll();
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+int main() {
+    if (unitTest()) {
+        std::cout << "Pass" << std::endl;
+        return 0;
+    }
+    std::cout << "Fail" << std::endl;
+    return 1;
+}
@@ -0,0 +1,150 @@
+/* testWriteAheadLog.cpp
+description:
+This is a bottom-up test driver that tests the write ahead log through the Product module.
+A crash is simulated by running the driver again as a child process that exits without uninitializing.
+The test prints a PASS or FAIL verdict, and must be run in an empty directory.
+usage: testWriteAheadLog
+version history:
+ver2 -26/10/17
+    -products on disk counted after the file header
+ver1 -26/10/17
+*/
+
+#include "Product.h"
+#include "WriteAheadLog.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+/*
+-------------------------------------------------------------------------------------------------------------------------------------------------------------------
+Helper functions to assist with populating products and checking the product file
+*/
+
+product createProduct(int number) {
+    product newProduct;
+    snprintf(newProduct.name, MAX_PRODUCT_NAME_SIZE, "Prod%d", number);
+    return newProduct;
+}
+
+// number of products stored in Product.dat on disk, after its header
+long storedProducts() {
+    FILE* productFile = fopen("Product.dat", "rb");
+    if (productFile == nullptr) {
+        return 0;
+    }
+    fseek(productFile, 0, SEEK_END);
+    long size = ftell(productFile);
+    fclose(productFile);
+    if (size < RECORD_HEADER_SIZE) {
+        return 0;
+    }
+    return (size - RECORD_HEADER_SIZE) / ProductTraits::RECORD_SIZE;
+}
+
+// number of products read back through the Product module
+int readProducts() {
+    product readInto;
+    int count = 0;
+    Product::seekToBeginning();
+    while (!Product::getNext(readInto)) {
+        count++;
+    }
+    return count;
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+/*
+Child process: commit three products, write a fourth without committing it, then exit as if crashed
+*/
+int crash() {
+    if (WriteAheadLog::init() || Product::initProduct()) {
+        return 1;
+    }
+    for (int i = 1; i <= 3; i++) {
+        product newProduct = createProduct(i);
+        Product::writeProduct(newProduct);
+    }
+    WriteAheadLog::commit();
+    product uncommitted = createProduct(4);
+    Product::writeProduct(uncommitted);
+    std::_Exit(0);
+}
+
+//========
+
+bool unitTest(const char* program) {
+    std::remove("Product.dat");
+    std::remove("Journal.log");
+
+    /*
+    Test 1: Logged writes do not reach the database file before a checkpoint
+    Postcondition: Product.dat is still empty after the crash
+    */
+    if (std::system((std::string(program) + " crash").c_str()) != 0) {
+        std::cout << "Crash process failed" << std::endl;
+        return 0;
+    }
+    if (storedProducts() != 0) {
+        std::cout << "Logged writes reached Product.dat before a checkpoint" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 2: Recovery replays committed groups only
+    Precondition: Journal.log holds a committed group of three products, the fourth product was never committed
+    Postcondition: Product.dat holds the three committed products
+    */
+    if (WriteAheadLog::init() || Product::initProduct()) {
+        std::cout << "Initialization Failed" << std::endl;
+        return 0;
+    }
+    if ((storedProducts() != 3) || (readProducts() != 3)) {
+        std::cout << "Replay Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 3: Reads see logged writes held in memory
+    Postcondition: the new product is read back while Product.dat still holds three products
+    */
+    product newProduct = createProduct(5);
+    Product::writeProduct(newProduct);
+    product readInto;
+    product filter;
+    strcpy(filter.name, "Prod5");
+    Product::seekToBeginning();
+    if (Product::getNext(readInto, filter) || (storedProducts() != 3)) {
+        std::cout << "Read of held write Failed" << std::endl;
+        return 0;
+    }
+
+    /*
+    Test 4: Uninitializing checkpoints the held writes into Product.dat
+    */
+    Product::uninitProduct();
+    WriteAheadLog::uninit();
+    if (storedProducts() != 4) {
+        std::cout << "Checkpoint Failed" << std::endl;
+        return 0;
+    }
+    return 1;
+}
+
+/* -----------------------------------------------------------------------------------------------------------------------------------------------------------------*/
+
+int main(int argc, char** argv) {
+    if ((argc > 1) && (strcmp(argv[1], "crash") == 0)) {
+        return crash();
+    }
+
+    if (unitTest(argv[0])) {
+        std::cout << "Pass" << std::endl;
+        return 0;
+    }
+    std::cout << "Fail" << std::endl;
+    return 1;
+}